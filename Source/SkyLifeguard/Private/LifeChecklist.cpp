@@ -0,0 +1,17 @@
+﻿#include "LifeChecklist.h"
+
+#include "HAL/IConsoleManager.h"
+
+static bool GLifeChecklistsVerbose = true;
+static FAutoConsoleVariableRef CVarLifeChecklistsVerbose(
+	TEXT("Lifeguard.Checklists.Verbose"),
+	GLifeChecklistsVerbose,
+	TEXT("If true, checklists log every completed step and every checklist done to LogLife."));
+
+namespace LifeCheck
+{
+	bool IsVerboseEnabled()
+	{
+		return GLifeChecklistsVerbose;
+	}
+}
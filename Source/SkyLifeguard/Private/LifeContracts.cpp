@@ -1,440 +1,840 @@
 ﻿#include "LifeContracts.h"
 
+#include "Async/ParallelFor.h"
+#include "HAL/IConsoleManager.h"
+#include "LifeInvariantDeferred.h"
+#include "LifeInvariantFingerprint.h"
+#include "LifeInvariantKernels.h"
+#include "LifeInvariantPlan.h"
+#include "LifeInvariantSampling.h"
+#include "LifeLogChannels.h"
+#include "LifeStats.h"
+#include "UObject/GarbageCollection.h"
+#include "UObject/UObjectIterator.h"
+
+static bool GLifeInvariantsUseBatches = true;
+static FAutoConsoleVariableRef CVarLifeInvariantsUseBatches(
+	TEXT("Lifeguard.Invariants.Simd"),
+	GLifeInvariantsUseBatches,
+	TEXT("If true, runs of same-type numeric invariants (int32/float Gte0, Gt0, Lte0, Lt0, Range) are checked 4 at a time with vector compares. If false, every property goes through its scalar kernel."));
+
 namespace Debug
 {
-    /**
-     * Helper to check if a single pointer-like property value is valid.
-
-     * @return true if valid (or not a pointer type), false if null/invalid pointer
-     */
-    static bool IsPointerPropertyValueValid(FProperty* ElementProperty, void const* ElementAddress)
-    {
-        if (const FObjectProperty* ObjProp = CastField<FObjectProperty>(ElementProperty)) {
-            return ObjProp->GetPropertyValue(ElementAddress) != nullptr;
-        }
-        if (const FWeakObjectProperty* WeakProp = CastField<FWeakObjectProperty>(ElementProperty)) {
-            return WeakProp->GetPropertyValue(ElementAddress).IsValid();
-        }
-        if (const FSoftObjectProperty* SoftProp = CastField<FSoftObjectProperty>(ElementProperty)) {
-            return !SoftProp->GetPropertyValue(ElementAddress).IsNull();
-        }
-        if (const FSoftClassProperty* SoftClassProp = CastField<FSoftClassProperty>(ElementProperty)) {
-            return !SoftClassProp->GetPropertyValue(ElementAddress).IsNull();
-        }
-        if (const FClassProperty* ClassProp = CastField<FClassProperty>(ElementProperty)) {
-            return ClassProp->GetPropertyValue(ElementAddress) != nullptr;
-        }
-        if (const FInterfaceProperty* InterfaceProp = CastField<FInterfaceProperty>(ElementProperty)) {
-            const FScriptInterface& Interface = InterfaceProp->GetPropertyValue(ElementAddress);
-            return Interface.GetObject() != nullptr;
-        }
-        // Not a pointer type - considered valid
-        return true;
-    }
+#if WITH_DEV_AUTOMATION_TESTS
+	static TFunction<void(const FString&)> GCheckFailureHook;
+
+	void SetCheckFailureHook(TFunction<void(const FString&)> Hook)
+	{
+		check(IsInGameThread());
+		GCheckFailureHook = MoveTemp(Hook);
+	}
+
+	bool InterceptCheckFailure(const FString& Message)
+	{
+		if (!GCheckFailureHook || !IsInGameThread()) {
+			return false;
+		}
+		GCheckFailureHook(Message);
+		return true;
+	}
+#endif
 
 	/**
-     * Check if the element property is a pointer-like type that we should validate.
-     */
-    static bool IsPointerLikeProperty(FProperty* Property)
-    {
-        return CastField<FObjectProperty>(Property) != nullptr ||
-               CastField<FWeakObjectProperty>(Property) != nullptr ||
-               CastField<FSoftObjectProperty>(Property) != nullptr ||
-               CastField<FSoftClassProperty>(Property) != nullptr ||
-               CastField<FClassProperty>(Property) != nullptr ||
-               CastField<FInterfaceProperty>(Property) != nullptr;
-    }
+	 * Calls a parameterless const bool UFunction. The parameter block lives on the stack instead of in an
+	 * FStructOnScope, so the call doesn't touch the heap. Not inlined so the alloca is released after every call.
+	 */
+	static FORCENOINLINE bool CallInvariantFunction(const UObject* Object, UFunction* Function)
+	{
+		uint8* Params = static_cast<uint8*>(FMemory_Alloca_Aligned(Function->ParmsSize, Function->GetMinAlignment()));
+		Function->InitializeStruct(Params);
+		const_cast<UObject*>(Object)->ProcessEvent(Function, Params);
+
+		const FBoolProperty* ReturnProp = CastFieldChecked<FBoolProperty>(Function->GetReturnProperty());
+		const bool bIsValid = ReturnProp->GetPropertyValue_InContainer(Params);
+		Function->DestroyStruct(Params);
+		return bIsValid;
+	}
 
+	/**
+	 * Finds the first element (TArray/TSet) or value (TMap) failing an element-wise numeric rule and describes it,
+	 * e.g. "[12] = -0.5" or "[Fire] = -0.5" for a map.
+	 */
+	static FString DescribeFailingElement(const UObject* Object, const FLifeInvariantEntry& Entry)
+	{
+		const void* Value = reinterpret_cast<const uint8*>(Object) + Entry.Offset;
+		FString KeyText;
+		FString ValueText;
+
+		if (const FArrayProperty* ArrayProp = CastField<FArrayProperty>(Entry.Property)) {
+			FScriptArrayHelper ArrayHelper(ArrayProp, Value);
+			for (int32 i = 0; i < ArrayHelper.Num(); ++i) {
+				if (!Entry.ElementKernel(Entry, ArrayHelper.GetRawPtr(i))) {
+					ArrayProp->Inner->ExportTextItem_Direct(ValueText, ArrayHelper.GetRawPtr(i), nullptr, nullptr, PPF_None);
+					return FString::Printf(TEXT("[%d] = %s"), i, *ValueText);
+				}
+			}
+		} else if (const FSetProperty* SetProp = CastField<FSetProperty>(Entry.Property)) {
+			FScriptSetHelper SetHelper(SetProp, Value);
+			for (int32 i = 0; i < SetHelper.GetMaxIndex(); ++i) {
+				if (SetHelper.IsValidIndex(i) && !Entry.ElementKernel(Entry, SetHelper.GetElementPtr(i))) {
+					SetProp->ElementProp->ExportTextItem_Direct(ValueText, SetHelper.GetElementPtr(i), nullptr, nullptr, PPF_None);
+					return FString::Printf(TEXT("element %s"), *ValueText);
+				}
+			}
+		} else if (const FMapProperty* MapProp = CastField<FMapProperty>(Entry.Property)) {
+			FScriptMapHelper MapHelper(MapProp, Value);
+			for (int32 i = 0; i < MapHelper.GetMaxIndex(); ++i) {
+				if (MapHelper.IsValidIndex(i) && !Entry.ElementKernel(Entry, MapHelper.GetValuePtr(i))) {
+					MapProp->KeyProp->ExportTextItem_Direct(KeyText, MapHelper.GetKeyPtr(i), nullptr, nullptr, PPF_None);
+					MapProp->ValueProp->ExportTextItem_Direct(ValueText, MapHelper.GetValuePtr(i), nullptr, nullptr, PPF_None);
+					return FString::Printf(TEXT("[%s] = %s"), *KeyText, *ValueText);
+				}
+			}
+		}
+		return TEXT("unknown element");
+	}
 
 	/**
-     * Validates a container for MemSafeContainer invariant.
-     * @return true if valid, false if any element is an invalid pointer
-     */
-    static bool ValidateMemSafeContainer(FProperty* Property, void const* PropertyAddress, const FString& ClassName, const FString& PropertyName)
-    {
-        // TArray
-        if (const FArrayProperty* ArrayProp = CastField<FArrayProperty>(Property)) {
-            FProperty* InnerProp = ArrayProp->Inner;
-            
-            // If inner type is not pointer-like, container is valid
-            if (!IsPointerLikeProperty(InnerProp)) {
-                return true;
-            }
-
-            FScriptArrayHelper ArrayHelper(ArrayProp, PropertyAddress);
-            for (int32 i = 0; i < ArrayHelper.Num(); ++i)
-            {
-                void const* ElementPtr = ArrayHelper.GetRawPtr(i);
-                if (!IsPointerPropertyValueValid(InnerProp, ElementPtr)) {
-                    return false;
-                }
-            }
-            return true;
-        }
-
-        // TSet
-        if (const FSetProperty* SetProp = CastField<FSetProperty>(Property)) {
-            FProperty* ElementProp = SetProp->ElementProp;
-            
-            if (!IsPointerLikeProperty(ElementProp)) {
-                return true;
-            }
-
-            FScriptSetHelper SetHelper(SetProp, PropertyAddress);
-            for (int32 i = 0; i < SetHelper.Num(); ++i)
-            {
-                if (SetHelper.IsValidIndex(i))
-                {
-                    void const* ElementPtr = SetHelper.GetElementPtr(i);
-                    if (!IsPointerPropertyValueValid(ElementProp, ElementPtr)) {
-                        return false;
-                    }
-                }
-            }
-            return true;
-        }
-
-        // TMap
-        if (const FMapProperty* MapProp = CastField<FMapProperty>(Property)) {
-            FProperty* KeyProp = MapProp->KeyProp;
-            FProperty* ValueProp = MapProp->ValueProp;
-            
-            const bool bKeyIsPointer = IsPointerLikeProperty(KeyProp);
-            const bool bValueIsPointer = IsPointerLikeProperty(ValueProp);
-            
-            if (!bKeyIsPointer && !bValueIsPointer) {
-                return true;
-            }
-
-            FScriptMapHelper MapHelper(MapProp, PropertyAddress);
-            for (int32 i = 0; i < MapHelper.Num(); ++i)
-            {
-                if (MapHelper.IsValidIndex(i))
-                {
-                    if (bKeyIsPointer)
-                    {
-                        void const* KeyPtr = MapHelper.GetKeyPtr(i);
-                        if (!IsPointerPropertyValueValid(KeyProp, KeyPtr)) {
-                            return false;
-                        }
-                    }
-                    if (bValueIsPointer)
-                    {
-                        void const* ValuePtr = MapHelper.GetValuePtr(i);
-                        if (!IsPointerPropertyValueValid(ValueProp, ValuePtr)) {
-                            return false;
-                        }
-                    }
-                }
-            }
-            return true;
-        }
-
-        // TOptional
-        if (const auto* const OptProp = CastField<FOptionalProperty>(Property)) {
-            FProperty* ValueProperty = OptProp->GetValueProperty();
-        	const auto bIsSet = OptProp->IsSet(PropertyAddress);
-        	
-        	if (!bIsSet) {
-        		// Unset optional is memory safe since it's not set to anything
-        		return true;
-        	}
-        	
-        	// Optional is set --
-
-			// If the value type is not pointer-like, container is valid
-            if (!IsPointerLikeProperty(ValueProperty)) {
-                return true;
-            }
-        	
-        	// Check if the optional has a value
-        	const void* ValueAddress = OptProp->GetValuePointerForRead(PropertyAddress);
-        	if (ValueAddress == nullptr) {
-        		return false;
-        	}
-
-            return true;
-        }
-
-        // Not a recognized container type
-        return false;
-    }
+	 * Builds the message for a failed kernel.
+	 */
+	static FString DescribeInvariantViolation(const UObject* Object, const FLifeInvariantEntry& Entry)
+	{
+		const FString ClassName = Object->GetClass()->GetName();
+		const FString PropertyName = Entry.Property->GetName();
+
+		if (Entry.ElementKernel) {
+			return FString::Printf(TEXT("Invariant=%s violation on %s::%s, %s"), *Entry.Rule, *ClassName, *PropertyName, *DescribeFailingElement(Object, Entry));
+		}
+
+		switch (Entry.Op)
+		{
+		case ELifeInvariantOp::MemSafe:
+			// Only strict kernels fail on a non-null pointer
+			if ((Entry.Kind == ELifeInvariantKind::Object || Entry.Kind == ELifeInvariantKind::Class)
+				&& !reinterpret_cast<const FObjectPtr*>(reinterpret_cast<const uint8*>(Object) + Entry.Offset)->IsNull()) {
+				return FString::Printf(TEXT("Invariant=MemSafe violation on %s::%s (pointer to a collected, Garbage or Unreachable object)"), *ClassName, *PropertyName);
+			}
+			return FString::Printf(TEXT("Invariant=MemSafe violation on %s::%s"), *ClassName, *PropertyName);
+		case ELifeInvariantOp::MemSafeContainer:
+			return FString::Printf(TEXT("Invariant=MemSafeContainer violation on %s::%s (container has null/invalid pointer element)"), *ClassName, *PropertyName);
+		case ELifeInvariantOp::Range:
+			return FString::Printf(TEXT("Range invariant violation on %s::%s (%s)"), *ClassName, *PropertyName, *Entry.Rule);
+		default:
+			return FString::Printf(TEXT("Invariant=%s violation on %s::%s"), *Entry.Rule, *ClassName, *PropertyName);
+		}
+	}
+
+	/** " (deferred from Function @ File:Line)" while a deferred check runs, so failures point at the code that queued it. */
+	static FString DescribeDeferredCallSite()
+	{
+		const FLifeInvariantCallSite* Site = FLifeDeferredInvariants::GetCurrentCallSite();
+		return Site ? FString::Printf(TEXT(" (deferred from %hs @ %hs:%d)"), Site->Function, Site->File, Site->Line) : FString();
+	}
+
+	/** Asserts with Message, unless an automation test intercepts invariant failures (see SetCheckFailureHook). */
+	static FORCENOINLINE void ReportInvariantFailure(const FString& Message)
+	{
+#if WITH_DEV_AUTOMATION_TESTS
+		if (InterceptCheckFailure(Message)) {
+			return;
+		}
+#endif
+		checkf(false, TEXT("%s"), *Message);
+	}
+
+	/**
+	 * Reports a failed kernel. Kept out of line so the passing path stays a tight loop of kernel calls, and so names
+	 * are only materialized once something is actually wrong.
+	 */
+	static FORCENOINLINE void ReportInvariantViolation(const UObject* Object, const FLifeInvariantEntry& Entry)
+	{
+		ReportInvariantFailure(DescribeInvariantViolation(Object, Entry) + DescribeDeferredCallSite());
+	}
+
+	/**
+	 * Invariant=Contract* traversal of one check sweep. Contract* members aren't checked recursively, they're queued on
+	 * an explicit stack and checked depth-first, and every object is checked at most once per sweep, so sub-objects
+	 * shared by many parents are only validated the first time they're reached. Every queued object remembers which
+	 * object referenced it through which property, so a reference back to an object on its own path is reported as a
+	 * cycle with the full path instead of looping.
+	 *
+	 * Batch checks register their objects as deferred roots: their references are held back until every object of the
+	 * batch has been checked, then each root is walked in turn. A deferred root reached from another root's walk isn't
+	 * checked again, its held back references are followed from there, so a loop between two objects of the same batch
+	 * is reported like any other.
+	 *
+	 * Game thread only, like everything that follows Contract* references.
+	 */
+	class FLifeContractWalk
+	{
+	public:
+		/** Registers an object the caller checks itself, so later references to it are skipped (or are cycles). */
+		int32 AddRoot(const UObject* Root)
+		{
+			Visited.Add(Root);
+			return Nodes.Add({ Root, nullptr, INDEX_NONE });
+		}
+
+		/** Registers an object the caller checks itself, whose references are only walked by RunDeferredRoots. */
+		int32 AddDeferredRoot(const UObject* Root)
+		{
+			const int32 NodeIndex = Nodes.Add({ Root, nullptr, INDEX_NONE });
+			Nodes[NodeIndex].DeferredRoot = DeferredRoots.Add({ NodeIndex });
+			DeferredRootOfObject.Add(Root, Nodes[NodeIndex].DeferredRoot);
+			return NodeIndex;
+		}
+
+		bool IsVisited(const UObject* Object) const
+		{
+			return Visited.Contains(Object);
+		}
+
+		/** Queues Child, referenced by the Contract* member Entry of the object at ParentNode. */
+		void Push(int32 ParentNode, const UObject* Child, const FLifeInvariantEntry& Entry)
+		{
+			const int32 NodeIndex = Nodes.Add({ Child, &Entry, ParentNode });
+			const int32 DeferredRoot = Nodes[ParentNode].DeferredRoot;
+			if (DeferredRoot == INDEX_NONE) {
+				Pending.Add(NodeIndex);
+				return;
+			}
+
+			// Held back, in order, until the root is walked
+			FDeferredRoot& Root = DeferredRoots[DeferredRoot];
+			if (Root.LastChild == INDEX_NONE) {
+				Root.FirstChild = NodeIndex;
+			}
+			else {
+				Nodes[Root.LastChild].NextSibling = NodeIndex;
+			}
+			Root.LastChild = NodeIndex;
+		}
+
+		/** Checks the queued objects, and whatever they reference in turn, until the stack is empty. */
+		void Run();
+
+		/** Walks the references of every deferred root not reached from an earlier one, in registration order. */
+		void RunDeferredRoots();
+
+	private:
+		struct FNode
+		{
+			const UObject* Object = nullptr;
+			/** Contract* entry of the parent that references the object. Null for roots. */
+			const FLifeInvariantEntry* Entry = nullptr;
+			int32 Parent = INDEX_NONE;
+			/** Index into DeferredRoots if the node is one. */
+			int32 DeferredRoot = INDEX_NONE;
+			/** Next held back reference of the same deferred root. */
+			int32 NextSibling = INDEX_NONE;
+		};
+
+		struct FDeferredRoot
+		{
+			int32 Node = INDEX_NONE;
+			int32 FirstChild = INDEX_NONE;
+			int32 LastChild = INDEX_NONE;
+		};
+
+		/** Queues the held back references of a deferred root as children of NodeIndex. */
+		void PushDeferredChildren(int32 DeferredRoot, int32 NodeIndex);
+
+		bool IsOnPath(int32 NodeIndex, const UObject* Object) const;
+		FString DescribePath(int32 NodeIndex) const;
+
+		TArray<FNode, TInlineAllocator<32>> Nodes;
+		TArray<int32, TInlineAllocator<32>> Pending;
+		TSet<const UObject*, DefaultKeyFuncs<const UObject*>, TInlineSetAllocator<32>> Visited;
+		TArray<FDeferredRoot> DeferredRoots;
+		TMap<const UObject*, int32> DeferredRootOfObject;
+	};
+
+	/**
+	 * @param Walk Contract* traversal of the sweep, only needed if the plan has Contract* entries.
+	 * @param Node Node of the object in the walk.
+	 */
+	static void CheckObjectInvariants(const UObject* Object, const FLifeInvariantPlan& Plan, bool bSkipFingerprinted,
+		FLifeContractWalk* Walk, int32 Node);
+
+	/**
+	 * Runs one vector batch. A failing batch hands its entries to the scalar kernels, which find the failing lane.
+	 */
+	static FORCEINLINE void CheckInvariantBatch(const UObject* Object, const FLifeInvariantPlan& Plan, const FLifeInvariantBatch& Batch)
+	{
+		const uint8* ObjectBase = reinterpret_cast<const uint8*>(Object);
+		if (LIKELY(TestInvariantBatch(Batch, ObjectBase))) {
+			return;
+		}
+		for (const int32 EntryIndex : Batch.EntryIndices) {
+			const FLifeInvariantEntry& Entry = Plan.Entries[EntryIndex];
+			if (!Entry.Kernel(Entry, ObjectBase + Entry.Offset)) {
+				ReportInvariantViolation(Object, Entry);
+			}
+		}
+	}
+
+	/**
+	 * Runs one plan entry on one object. Contract* entries queue the referenced object on the walk.
+	 */
+	static FORCEINLINE void CheckInvariantEntry(const UObject* Object, const FLifeInvariantEntry& Entry, FLifeContractWalk* Walk, int32 Node)
+	{
+		void const* PropertyAddress = reinterpret_cast<const uint8*>(Object) + Entry.Offset;
+
+		// Plain value checks: the kernel already knows the rule and the type
+		if (Entry.Kernel) {
+			if (UNLIKELY(!Entry.Kernel(Entry, PropertyAddress))) {
+				ReportInvariantViolation(Object, Entry);
+			}
+			return;
+		}
+
+		switch (Entry.Op)
+		{
+		// Invariant=Contract*
+		case ELifeInvariantOp::Contract:
+		{
+			const UObject* Value = static_cast<const FObjectPtr*>(PropertyAddress)->Get();
+			if (UNLIKELY(!IsValid(Value))) {
+				ReportInvariantFailure(FString::Printf(TEXT("Invariant=Contract* violation on %s::%s%s"), *Object->GetClass()->GetName(), *Entry.Property->GetName(), *DescribeDeferredCallSite()));
+				break;
+			}
+			check(Walk);
+			Walk->Push(Node, Value, Entry);
+			break;
+		}
+		// Invariant=PublicFunctionName
+		case ELifeInvariantOp::Function:
+		{
+			const bool bIsValid = Entry.NativeFunction ? Entry.NativeFunction(Object) : CallInvariantFunction(Object, Entry.Function);
+			if (UNLIKELY(!bIsValid)) {
+				ReportInvariantFailure(FString::Printf(TEXT("Invariant violation on %s::%s. Custom check '%s' failed.%s"), *Object->GetClass()->GetName(), *Entry.Property->GetName(), *Entry.Rule, *DescribeDeferredCallSite()));
+			}
+			break;
+		}
+		default:
+			checkNoEntry();
+			break;
+		}
+	}
+
+	/**
+	 * Runs a class level custom invariant on one object, natively if it has a binding.
+	 */
+	static FORCEINLINE void CheckInvariantFunction(const UObject* Object, const FLifeInvariantFunction& Function)
+	{
+		const bool bIsValid = Function.Native ? Function.Native(Object) : CallInvariantFunction(Object, Function.Function);
+		if (UNLIKELY(!bIsValid)) {
+			ReportInvariantFailure(FString::Printf(TEXT("Invariant violation: Custom check function '%s' on class '%s' failed.%s"), *Function.Name.ToString(), *Object->GetClass()->GetName(), *DescribeDeferredCallSite()));
+		}
+	}
+
+	/**
+	 * Full check of one object: vector batches, then scalar entries, then class level functions. Objects referenced
+	 * through Contract* are only queued on the walk.
+	 *
+	 * @param bSkipFingerprinted Skip the entries covered by the fingerprint, because it's unchanged since the last pass.
+	 */
+	static void CheckObjectInvariants(const UObject* Object, const FLifeInvariantPlan& Plan, bool bSkipFingerprinted,
+		FLifeContractWalk* Walk, int32 Node)
+	{
+		if (bSkipFingerprinted && Plan.bFullyFingerprinted) {
+			return;
+		}
+
+		// Nothing on the passing path allocates. Class and property names are only materialized on failure.
+		// Vector batches go first, the entries they cover are skipped in the scalar walk. Batched entries are always
+		// fingerprinted.
+		const bool bUseBatches = GLifeInvariantsUseBatches;
+		if (bUseBatches && !bSkipFingerprinted) {
+			for (const FLifeInvariantBatch& Batch : Plan.Batches) {
+				CheckInvariantBatch(Object, Plan, Batch);
+			}
+		}
+
+		if (!Plan.StrictPointerOffsets.IsEmpty()) {
+			PrefetchObjectItems(Plan, reinterpret_cast<const uint8*>(Object));
+		}
+
+		for (const FLifeInvariantEntry& Entry : Plan.Entries) {
+			if ((bUseBatches && Entry.bBatched) || (bSkipFingerprinted && Entry.bFingerprinted)) {
+				continue;
+			}
+			CheckInvariantEntry(Object, Entry, Walk, Node);
+		}
+
+		for (const FLifeInvariantFunction& Function : Plan.Functions) {
+			CheckInvariantFunction(Object, Function);
+		}
+	}
+
+	/** Reports a Contract* reference back to an object on its own path. Out of line like ReportInvariantViolation. */
+	static FORCENOINLINE void ReportContractCycle(const FString& Path)
+	{
+		ReportInvariantFailure(FString::Printf(TEXT("Invariant=Contract* cycle: %s. Any loop of Contract* references needs at least one non-invariant reference.%s"), *Path, *DescribeDeferredCallSite()));
+	}
+
+	void FLifeContractWalk::Run()
+	{
+		while (!Pending.IsEmpty()) {
+			const int32 NodeIndex = Pending.Pop();
+			// Copied, checking the object may add nodes
+			const FNode Node = Nodes[NodeIndex];
+
+			if (UNLIKELY(IsOnPath(Node.Parent, Node.Object))) {
+				ReportContractCycle(DescribePath(NodeIndex));
+				continue;
+			}
+
+			bool bAlreadyVisited = false;
+			Visited.Add(Node.Object, &bAlreadyVisited);
+			if (bAlreadyVisited) {
+				continue;
+			}
+
+			// Already checked by its batch, only its references are left
+			if (UNLIKELY(!DeferredRootOfObject.IsEmpty())) {
+				if (const int32* DeferredRoot = DeferredRootOfObject.Find(Node.Object)) {
+					PushDeferredChildren(*DeferredRoot, NodeIndex);
+					continue;
+				}
+			}
+
+			// Never sampled, the root check already paid for it
+			CheckObjectInvariants(Node.Object, FLifeInvariantPlanCache::GetPlan(Node.Object->GetClass()), false, this, NodeIndex);
+		}
+	}
+
+	void FLifeContractWalk::RunDeferredRoots()
+	{
+		for (int32 DeferredRoot = 0; DeferredRoot < DeferredRoots.Num(); ++DeferredRoot) {
+			const int32 NodeIndex = DeferredRoots[DeferredRoot].Node;
+			bool bAlreadyVisited = false;
+			Visited.Add(Nodes[NodeIndex].Object, &bAlreadyVisited);
+			if (bAlreadyVisited) {
+				continue;
+			}
+			PushDeferredChildren(DeferredRoot, NodeIndex);
+			Run();
+		}
+	}
+
+	void FLifeContractWalk::PushDeferredChildren(int32 DeferredRoot, int32 NodeIndex)
+	{
+		// Queued in entry order, like the references of a checked object
+		for (int32 Child = DeferredRoots[DeferredRoot].FirstChild; Child != INDEX_NONE; Child = Nodes[Child].NextSibling) {
+			const FNode ChildNode = Nodes[Child];
+			if (NodeIndex == DeferredRoots[DeferredRoot].Node) {
+				Pending.Add(Child);
+			}
+			else {
+				Pending.Add(Nodes.Add({ ChildNode.Object, ChildNode.Entry, NodeIndex }));
+			}
+		}
+	}
+
+	bool FLifeContractWalk::IsOnPath(int32 NodeIndex, const UObject* Object) const
+	{
+		for (int32 Index = NodeIndex; Index != INDEX_NONE; Index = Nodes[Index].Parent) {
+			if (Nodes[Index].Object == Object) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	/** E.g. "InventoryA.Owner -> CharacterB.Inventory -> InventoryA", from the root to the node. */
+	FString FLifeContractWalk::DescribePath(int32 NodeIndex) const
+	{
+		TArray<int32, TInlineAllocator<16>> Chain;
+		for (int32 Index = NodeIndex; Index != INDEX_NONE; Index = Nodes[Index].Parent) {
+			Chain.Add(Index);
+		}
+
+		FString Path;
+		for (int32 ChainIndex = Chain.Num() - 1; ChainIndex >= 0; --ChainIndex) {
+			const FNode& Node = Nodes[Chain[ChainIndex]];
+			if (Node.Entry) {
+				Path += FString::Printf(TEXT(".%s -> "), *Node.Entry->Property->GetName());
+			}
+			Path += GetNameSafe(Node.Object);
+		}
+		return Path;
+	}
+
+	/** Per-class cycle stat and trace scope around the checks of one class, see Lifeguard.Stats.PerClass. */
+	struct FLifeClassStatScope
+	{
+		explicit FLifeClassStatScope(const FLifeInvariantPlan& Plan)
+			: TraceScope(Plan.TraceName.IsEmpty() ? nullptr : *Plan.TraceName)
+#if STATS
+			, CycleCounter(Plan.StatId)
+#endif
+		{
+		}
+
+		FLifeTraceScope TraceScope;
+#if STATS
+		FScopeCycleCounter CycleCounter;
+#endif
+	};
+
+	/** Checks one object as the root of its own sweep. */
+	static void CheckRootObjectInvariants(const UObject* Object, const FLifeInvariantPlan& Plan, bool bSkipFingerprinted)
+	{
+		if (!Plan.bHasContracts) {
+			CheckObjectInvariants(Object, Plan, bSkipFingerprinted, nullptr, INDEX_NONE);
+			return;
+		}
+
+		FLifeContractWalk Walk;
+		CheckObjectInvariants(Object, Plan, bSkipFingerprinted, &Walk, Walk.AddRoot(Object));
+		Walk.Run();
+	}
 
 	void Debug::CheckClassInvariants(const UObject* Object)
 	{
+		LG_SCOPE_CYCLE_COUNTER(STAT_LifeClassInvariants);
+		INC_DWORD_STAT(STAT_LifeObjectsChecked);
 		LG_PRECOND(Object);
 
-		UClass* Class = Object->GetClass();
-		const FString ClassName = Class->GetName();
+		const UClass* Class = Object->GetClass();
+		const FLifeInvariantPlan& Plan = FLifeInvariantPlanCache::GetPlan(Class);
+		const FLifeClassStatScope ClassStatScope(Plan);
+
+		// Incremental mode: skip what is provably unchanged since the object last passed. Unchanged objects don't
+		// count against the sampling budget.
+		const bool bIncremental = UNLIKELY(FLifeInvariantFingerprints::IsEnabled()) && Plan.HasFingerprint();
+		uint64 Fingerprint = 0;
+		bool bUnchanged = false;
+		if (bIncremental) {
+			Fingerprint = FLifeInvariantFingerprints::Compute(Object, Plan);
+			bUnchanged = FLifeInvariantFingerprints::IsUnchanged(Object, Fingerprint);
+			if (bUnchanged && Plan.bFullyFingerprinted) {
+				return;
+			}
+		}
 
-		for (TFieldIterator<FProperty> PropIt(Class); PropIt; ++PropIt) {
-			FProperty* Property = *PropIt;
-			if (!Property->HasMetaData(TEXT("Invariant"))) {
-				continue;
+		if (UNLIKELY(FLifeInvariantSampler::IsEnabled())) {
+			FLifeInvariantSamplingState* SamplingState = FLifeInvariantSampler::Admit(Class);
+			if (!SamplingState) {
+				return;
 			}
+			const uint64 StartCycles = FPlatformTime::Cycles64();
+			CheckRootObjectInvariants(Object, Plan, bUnchanged);
+			FLifeInvariantSampler::Record(*SamplingState, FPlatformTime::Cycles64() - StartCycles, 1);
+		} else {
+			CheckRootObjectInvariants(Object, Plan, bUnchanged);
+		}
+
+		if (bIncremental && !bUnchanged) {
+			FLifeInvariantFingerprints::Store(Object, Fingerprint);
+		}
+	}
+
+	void Debug::CheckClassInvariantsBatch(TArrayView<const UObject*> Objects)
+	{
+		LG_SCOPE_CYCLE_COUNTER(STAT_LifeClassInvariantsBatch);
+		INC_DWORD_STAT_BY(STAT_LifeObjectsChecked, Objects.Num());
 
-			const FString InvariantRule = Property->GetMetaData(TEXT("Invariant"));
-			const FString PropertyName = Property->GetName();
-			void const* PropertyAddress = Property->ContainerPtrToValuePtr<void>(Object);
-
-			// Invariant=MemSafe
-			if (InvariantRule == TEXT("MemSafe")) {
-				if (const FObjectProperty* ObjectProperty = CastField<FObjectProperty>(Property)) {
-					const auto Value = ObjectProperty->GetPropertyValue_InContainer(Object);
-					checkf(Value != nullptr, TEXT("Invariant=MemSafe violation on %s::%s"), *ClassName, *PropertyName)
-				} else if (const FClassProperty* ClassProperty = CastField<FClassProperty>(Property)) {
-					const auto Value = ClassProperty->GetPropertyValue_InContainer(Object);
-					checkf(Value != nullptr, TEXT("Invariant=MemSafe violation on %s::%s"), *ClassName, *PropertyName)
-				} else if (const FSoftObjectProperty* SoftObjectProperty = CastField<FSoftObjectProperty>(Property)) {
-					const auto Value = SoftObjectProperty->GetPropertyValue_InContainer(Object);
-					checkf(Value != nullptr, TEXT("Invariant=MemSafe violation on %s::%s"), *ClassName, *PropertyName)
-				} else if (const FWeakObjectProperty* WeakObjectProperty = CastField<FWeakObjectProperty>(Property)) {
-					const FWeakObjectPtr Value = WeakObjectProperty->GetPropertyValue_InContainer(Object);
-					checkf(Value != nullptr, TEXT("Invariant=MemSafe violation on %s::%s"), *ClassName, *PropertyName)
-				} else if (const FSoftClassProperty* SoftClassProperty = CastField<FSoftClassProperty>(Property)) {
-					const auto Value = SoftClassProperty->GetPropertyValue_InContainer(Object);
-					checkf(Value != nullptr, TEXT("Invariant=MemSafe violation on %s::%s"), *ClassName, *PropertyName)
-				} else if (const FInterfaceProperty* InterfaceProperty = CastField<FInterfaceProperty>(Property)) {
-                    const FScriptInterface& Value = InterfaceProperty->GetPropertyValue(PropertyAddress);
-                    checkf(Value.GetObject() != nullptr, TEXT("Invariant=MemSafe violation on %s::%s"), *ClassName, *PropertyName)
-                } else {
-					checkf(false, TEXT("Invariant=MemSafe used on non-pointer property %s::%s"), *ClassName, *PropertyName);
+		/** A run of objects of the same class inside the sorted copy. */
+		struct FClassGroup
+		{
+			const UClass* Class = nullptr;
+			const FLifeInvariantPlan* Plan = nullptr;
+			FLifeInvariantSamplingState* SamplingState = nullptr;
+			int32 First = 0;
+			int32 Num = 0;
+		};
+
+		// Group by class in order of first appearance, and keep the caller's order inside a group. Populations rarely
+		// have more than a handful of classes, so a linear search that remembers the last hit beats a map.
+		TArray<FClassGroup, TInlineAllocator<16>> Groups;
+		TArray<int32, TInlineAllocator<256>> GroupOfObject;
+		GroupOfObject.SetNumUninitialized(Objects.Num());
+
+		// With sampling on, skipped objects are dropped here and the time of each class run is recorded afterwards.
+		// With the incremental mode on, so are unchanged objects whose every check is fingerprinted; the others get a
+		// full check and a fresh fingerprint.
+		const bool bSampling = FLifeInvariantSampler::IsEnabled();
+		const bool bIncremental = FLifeInvariantFingerprints::IsEnabled();
+		TArray<uint64, TInlineAllocator<256>> FingerprintOfObject;
+		if (bIncremental) {
+			FingerprintOfObject.SetNumZeroed(Objects.Num());
+		}
+		int32 NumAdmitted = 0;
+
+		int32 LastGroup = INDEX_NONE;
+		for (int32 ObjectIndex = 0; ObjectIndex < Objects.Num(); ++ObjectIndex) {
+			const UObject* Object = Objects[ObjectIndex];
+			LG_PRECOND(Object);
+
+			const UClass* Class = Object->GetClass();
+			if (LastGroup == INDEX_NONE || Groups[LastGroup].Class != Class) {
+				LastGroup = Groups.IndexOfByPredicate([Class](const FClassGroup& Group) { return Group.Class == Class; });
+				if (LastGroup == INDEX_NONE) {
+					LastGroup = Groups.Add({ Class, &FLifeInvariantPlanCache::GetPlan(Class) });
 				}
 			}
-			// Invariant=MemSafeContainer
-            else if (InvariantRule == TEXT("MemSafeContainer")) {
-                const bool bIsContainer = CastField<FArrayProperty>(Property) != nullptr ||
-                                          CastField<FSetProperty>(Property) != nullptr ||
-                                          CastField<FMapProperty>(Property) != nullptr ||
-                                          CastField<FOptionalProperty>(Property) != nullptr;
-                
-                checkf(bIsContainer, TEXT("Invariant=MemSafeContainer used on non-container property %s::%s"), *ClassName, *PropertyName);
-                
-                const bool bIsValid = ValidateMemSafeContainer(Property, PropertyAddress, ClassName, PropertyName);
-                checkf(bIsValid, TEXT("Invariant=MemSafeContainer violation on %s::%s (container has null/invalid pointer element)"), *ClassName, *PropertyName);
-            }
-			// Invariant=ID
-			else if (InvariantRule == TEXT("ID")) {
-				const bool bIsValid = TestIntegerProperty(Property, PropertyAddress, [](auto Value){ return Value != INDEX_NONE; });
-				checkf(bIsValid, TEXT("Invariant=ID violation on %s::%s"), *ClassName, *PropertyName);
-			}
-			// Invariant=Gte0 (Greater than or equal to 0)
-			else if (InvariantRule == TEXT("Gte0")) {
-				const bool bIsValid = TestArithmeticProperty(Property, PropertyAddress, [](auto Value){ return Value >= 0; });
-				checkf(bIsValid, TEXT("Invariant=Gte0 violation on %s::%s"), *ClassName, *PropertyName);
-			}
-			// Invariant=Gt0 (Greater than 0)
-			else if (InvariantRule == TEXT("Gt0")) {
-				const bool bIsValid = TestArithmeticProperty(Property, PropertyAddress, [](auto Value){ return Value > 0; });
-				checkf(bIsValid, TEXT("Invariant=Gt0 violation on %s::%s"), *ClassName, *PropertyName);
-			}
-			// Invariant=Lte0 (Less than or equal to 0)
-			else if (InvariantRule == TEXT("Lte0")) {
-				const bool bIsValid = TestArithmeticProperty(Property, PropertyAddress, [](auto Value){ return Value <= 0; });
-				checkf(bIsValid, TEXT("Invariant=Lte0 violation on %s::%s"), *ClassName, *PropertyName);
-			}
-			// Invariant=Lt0 (Less than 0)
-			else if (InvariantRule == TEXT("Lt0")) {
-				const bool bIsValid = TestArithmeticProperty(Property, PropertyAddress, [](auto Value){ return Value < 0; });
-				checkf(bIsValid, TEXT("Invariant=Lt0 violation on %s::%s"), *ClassName, *PropertyName);
-			}
-			// Invariant=Range[lower,upper] or Range(lower,upper] etc.
-			else if (InvariantRule.StartsWith(TEXT("Range")))
-			{
-				// Expect syntax Range[lo,hi], Range(lo,hi], etc. but also allow for Range (1, 2)
-				FString RangeSpec = InvariantRule.Mid(5).TrimStart(); // skip "Range", trim space
-				if (RangeSpec.IsEmpty() || (RangeSpec[0] != '(' && RangeSpec[0] != '[')) {
-					checkNoEntry()
+			FClassGroup& Group = Groups[LastGroup];
+			GroupOfObject[ObjectIndex] = INDEX_NONE;
+
+			// Unchanged objects don't count against the sampling budget
+			if (bIncremental && Group.Plan->HasFingerprint()) {
+				const uint64 Fingerprint = FLifeInvariantFingerprints::Compute(Object, *Group.Plan);
+				if (FLifeInvariantFingerprints::IsUnchanged(Object, Fingerprint) && Group.Plan->bFullyFingerprinted) {
+					continue;
 				}
-                
-				checkf(RangeSpec.Len() >= 2, TEXT("Invalid Range invariant format on %s::%s"), *ClassName, *PropertyName);
-
-				const TCHAR LowerBracket = RangeSpec[0];
-				const TCHAR UpperBracket = RangeSpec[RangeSpec.Len() - 1];
-				const bool bLowerInclusive = (LowerBracket == TEXT('['));
-				const bool bUpperInclusive = (UpperBracket == TEXT(']'));
-
-				// inner content between brackets
-				const FString Inner = RangeSpec.Mid(1, RangeSpec.Len() - 2);
-				TArray<FString> Parts;
-				Inner.ParseIntoArray(Parts, TEXT(","), true);
-				checkf(Parts.Num() == 2, TEXT("Range invariant must contain two comma-separated bounds on %s::%s"), *ClassName, *PropertyName);
-
-				FString LowerTrimmed = *Parts[0].TrimStartAndEnd();
-				FString UpperTrimmed = *Parts[1].TrimStartAndEnd();
-                
-				// Sanitize bounds: remove whitespace/newlines/tabs and common thousands separators,
-				// keep only digits, sign, decimal point and exponent markers.
-				auto SanitizeNumberString = [](const FString& In) -> FString {
-					FString Out;
-					Out.Reserve(In.Len());
-					for (const TCHAR C : In) {
-						if (FChar::IsWhitespace(C)) continue; // spaces, tabs, newlines, etc
-						if (C == ',' || C == '_') continue;  // common thousands separators
-						if (FChar::IsDigit(C) || C == '.' || C == '+' || C == '-' || C == 'e' || C == 'E') {
-							Out.AppendChar(C);
-						}
-						// drop anything else
-					}
-					return Out;
-				};
-
-				// Overwrite the parsed trimmed strings with sanitized versions so subsequent Atod() calls
-				// receive clean numeric text.
-				LowerTrimmed = SanitizeNumberString(LowerTrimmed);
-				UpperTrimmed = SanitizeNumberString(UpperTrimmed);
-
-                // If property is integral, do integer comparisons (avoid casting integers to double).
-                bool bIsValid = false;
-
-                const bool bBoundsHaveFloatMarker =
-                    LowerTrimmed.Contains(TEXT(".")) || LowerTrimmed.Contains(TEXT("e")) || LowerTrimmed.Contains(TEXT("E")) ||
-                    UpperTrimmed.Contains(TEXT(".")) || UpperTrimmed.Contains(TEXT("e")) || UpperTrimmed.Contains(TEXT("E"));
-
-                // Integer property path
-                if (CastField<FInt8Property>(Property)   || CastField<FInt16Property>(Property) ||
-                    CastField<FIntProperty>(Property)    || CastField<FInt64Property>(Property) ||
-                    CastField<FByteProperty>(Property)  || CastField<FUInt16Property>(Property) ||
-                    CastField<FUInt32Property>(Property)|| CastField<FUInt64Property>(Property))
-                {
-                    // Do not allow floating-point bounds for integer properties — require integer bounds.
-                    if (bBoundsHaveFloatMarker) {
-                        checkf(false, TEXT("Range invariant for integer property must use integer bounds on %s::%s"), *ClassName, *PropertyName);
-                    }
-
-                    bIsValid = TestIntegerProperty(Property, PropertyAddress, [LowerTrimmed, UpperTrimmed, bLowerInclusive, bUpperInclusive]<typename T>(T V) -> bool {
-                        if constexpr (std::is_signed_v<T>) {
-                        	const int64 LowerI = FCString::Atoi64(*LowerTrimmed);
-							const int64 UpperI = FCString::Atoi64(*UpperTrimmed);
-                        	
-							checkf(LowerI <= UpperI, TEXT("Range invariant lower bound must be <= upper bound"));
-                        	
-                            const T LowerBound = static_cast<T>(LowerI);
-                            const T UpperBound = static_cast<T>(UpperI);
-                            const bool LowerOk = bLowerInclusive ? (V >= LowerBound) : (V > LowerBound);
-                            const bool UpperOk = bUpperInclusive ? (V <= UpperBound) : (V < UpperBound);
-                            return LowerOk && UpperOk;
-                        } else {
-                        	const uint64 LowerI = FCString::Strtoui64(*LowerTrimmed, nullptr, 10);
-                        	const uint64 UpperI = FCString::Strtoui64(*UpperTrimmed, nullptr, 10);
-                        	
-                            const T LowerBound = static_cast<T>(LowerI);
-                            const T UpperBound = static_cast<T>(UpperI);
-                            const bool LowerOk = bLowerInclusive ? (V >= LowerBound) : (V > LowerBound);
-                            const bool UpperOk = bUpperInclusive ? (V <= UpperBound) : (V < UpperBound);
-                            return LowerOk && UpperOk;
-                        }
-                    });
-                }
-                // Floating point property path
-                else if (CastField<FFloatProperty>(Property) || CastField<FDoubleProperty>(Property)) {
-                    const double LowerD = FCString::Atod(*LowerTrimmed);
-                    const double UpperD = FCString::Atod(*UpperTrimmed);
-                    checkf(LowerD <= UpperD, TEXT("Range invariant lower bound must be <= upper bound on %s::%s"), *ClassName, *PropertyName);
-
-                    bIsValid = TestArithmeticProperty(Property, PropertyAddress, [LowerD, UpperD, bLowerInclusive, bUpperInclusive](auto V) -> bool {
-                        const double Value = static_cast<double>(V);
-                   		// Use a small relative epsilon scaled by value/bounds to tolerate tiny FP error,
-                        // and apply it outward (lower - eps, upper + eps) so we don't accidentally exclude valid values.
-                        const double Scale = FMath::Max(1.0, FMath::Max(FMath::Abs(LowerD), FMath::Max(FMath::Abs(UpperD), FMath::Abs(Value))));
-                        const double Eps = FMath::Clamp(Scale * 1e-6, 1e-10, 1e-3);
-                   		const bool LowerOk = bLowerInclusive ? (Value >= (LowerD - Eps)) : (Value > (LowerD - Eps));
-                        const bool UpperOk = bUpperInclusive ? (Value <= (UpperD + Eps)) : (Value < (UpperD + Eps));
-                        return LowerOk && UpperOk;
-                    });
-                }
-				else {
-                    checkf(false, TEXT("Range invariant used on non-arithmetic property %s::%s"), *ClassName, *PropertyName);
-                }
-
-				checkf(bIsValid, TEXT("Range invariant violation on %s::%s"), *ClassName, *PropertyName);
-			}
-			// Invariant=name
-			else if (InvariantRule == TEXT("name")) {
-				if (const FNameProperty* NameProperty = CastField<FNameProperty>(Property)) {
-					const FName Value = NameProperty->GetPropertyValue(PropertyAddress);
-					checkf(!Value.IsNone(), TEXT("Invariant=name violation on %s::%s"), *ClassName, *PropertyName);
-				} else {
-					checkf(false, TEXT("Invariant=name used on non-FName property %s::%s"), *ClassName, *PropertyName);
+				FingerprintOfObject[ObjectIndex] = Fingerprint;
+			}
+
+			if (bSampling) {
+				FLifeInvariantSamplingState* SamplingState = FLifeInvariantSampler::Admit(Class);
+				if (!SamplingState) {
+					continue;
 				}
+				Group.SamplingState = SamplingState;
+			}
+
+			++Group.Num;
+			GroupOfObject[ObjectIndex] = LastGroup;
+			++NumAdmitted;
+		}
+
+		// Counting sort into contiguous per-class runs
+		int32 Cursor = 0;
+		for (FClassGroup& Group : Groups) {
+			Group.First = Cursor;
+			Cursor += Group.Num;
+		}
+
+		TArray<const UObject*, TInlineAllocator<256>> Sorted;
+		Sorted.SetNumUninitialized(NumAdmitted);
+		TArray<uint64, TInlineAllocator<256>> SortedFingerprints;
+		if (bIncremental) {
+			SortedFingerprints.SetNumUninitialized(NumAdmitted);
+		}
+		{
+			TArray<int32, TInlineAllocator<16>> Next;
+			Next.SetNumUninitialized(Groups.Num());
+			for (int32 GroupIndex = 0; GroupIndex < Groups.Num(); ++GroupIndex) {
+				Next[GroupIndex] = Groups[GroupIndex].First;
 			}
-			// Invariant=True
-			else if (InvariantRule == TEXT("True")) {
-				if (const FBoolProperty* NameProperty = CastField<FBoolProperty>(Property)) {
-					const bool Value = NameProperty->GetPropertyValue(PropertyAddress);
-					checkf(Value, TEXT("Invariant=True violation on %s::%s"), *ClassName, *PropertyName);
-				} else {
-					checkf(false, TEXT("Invariant=True used on non-bool property %s::%s"), *ClassName, *PropertyName);
+			for (int32 ObjectIndex = 0; ObjectIndex < Objects.Num(); ++ObjectIndex) {
+				if (GroupOfObject[ObjectIndex] != INDEX_NONE) {
+					const int32 SortedIndex = Next[GroupOfObject[ObjectIndex]]++;
+					Sorted[SortedIndex] = Objects[ObjectIndex];
+					if (bIncremental) {
+						SortedFingerprints[SortedIndex] = FingerprintOfObject[ObjectIndex];
+					}
 				}
 			}
-			else if (InvariantRule == TEXT("False")) {
-				if (const FBoolProperty* NameProperty = CastField<FBoolProperty>(Property)) {
-					const bool Value = NameProperty->GetPropertyValue(PropertyAddress);
-					checkf(!Value, TEXT("Invariant=False violation on %s::%s"), *ClassName, *PropertyName);
-				} else {
-					checkf(false, TEXT("Invariant=False used on non-bool property %s::%s"), *ClassName, *PropertyName);
+		}
+
+		// Column-wise: each batch/entry/function runs across the whole class run before moving to the next one, so the
+		// plan data stays hot and every object is read at the same offset in turn. Contract* references of all groups
+		// share one walk, which runs per object after the last group.
+		const bool bUseBatches = GLifeInvariantsUseBatches;
+		FLifeContractWalk Walk;
+		TArray<int32, TInlineAllocator<256>> RunNodes;
+		for (const FClassGroup& Group : Groups) {
+			const FLifeInvariantPlan& Plan = *Group.Plan;
+			const TArrayView<const UObject*> Run(Sorted.GetData() + Group.First, Group.Num);
+			const FLifeClassStatScope ClassStatScope(Plan);
+			const uint64 StartCycles = bSampling ? FPlatformTime::Cycles64() : 0;
+
+			RunNodes.Reset();
+			if (Plan.bHasContracts) {
+				for (const UObject* Object : Run) {
+					RunNodes.Add(Walk.AddDeferredRoot(Object));
 				}
 			}
-			// Invariant=Contract*
-			else if (InvariantRule == TEXT("Contract*")) {
-				if (const FObjectProperty* ObjectProperty = CastField<FObjectProperty>(Property)) {
-					const auto Value = ObjectProperty->GetObjectPropertyValue(PropertyAddress);
-					LG_CONTRACT_CHECK_MSG(Value->GetClass() != Object->GetClass(), "An object cannot contain an invariant member of the same class, as that would imply an infinite loop of invariants");
-					checkf(IsValid(Value), TEXT("Invariant=Contract* violation on %s::%s"), *ClassName, *PropertyName);
-					if (Value) {
-						// Recursive check
-						CheckClassInvariants(Value);
+
+			if (bUseBatches) {
+				for (const FLifeInvariantBatch& Batch : Plan.Batches) {
+					for (const UObject* Object : Run) {
+						CheckInvariantBatch(Object, Plan, Batch);
 					}
-				} else {
-					checkf(false, TEXT("Invariant=Contract* used on non-pointer property %s::%s"), *ClassName, *PropertyName);
 				}
 			}
-			// Invariant=PublicFunctionName
-			else {
-				UFunction* Function = Class->FindFunctionByName(*InvariantRule);
-				checkf(Function != nullptr, TEXT("Invariant function '%s' not found."), *InvariantRule);
 
-				if (Function) {
-					// Check for const and no parameters
-					checkf(Function->HasAnyFunctionFlags(FUNC_Const), TEXT("Invariant function '%s' must be const."), *InvariantRule);
-					checkf(Function->NumParms == 1, TEXT("Invariant function '%s' must have exactly one return value (bool) and no parameters."), *InvariantRule);
+			if (!Plan.StrictPointerOffsets.IsEmpty()) {
+				for (const UObject* Object : Run) {
+					PrefetchObjectItems(Plan, reinterpret_cast<const uint8*>(Object));
+				}
+			}
 
-					FStructOnScope FuncParams(Function);
-					const_cast<UObject*>(Object)->ProcessEvent(Function, FuncParams.GetStructMemory());
+			for (const FLifeInvariantEntry& Entry : Plan.Entries) {
+				if (bUseBatches && Entry.bBatched) {
+					continue;
+				}
+				for (int32 RunIndex = 0; RunIndex < Run.Num(); ++RunIndex) {
+					CheckInvariantEntry(Run[RunIndex], Entry, &Walk, Plan.bHasContracts ? RunNodes[RunIndex] : INDEX_NONE);
+				}
+			}
 
-					FBoolProperty* ReturnProp = CastField<FBoolProperty>(Function->GetReturnProperty());
-					checkf(ReturnProp != nullptr, TEXT("Invariant function '%s' must return a bool."), *InvariantRule);
+			for (const FLifeInvariantFunction& Function : Plan.Functions) {
+				for (const UObject* Object : Run) {
+					CheckInvariantFunction(Object, Function);
+				}
+			}
 
-					if(ReturnProp) {
-						const bool bIsValid = ReturnProp->GetPropertyValue(FuncParams.GetStructMemory());
-						checkf(bIsValid, TEXT("Invariant violation on %s::%s. Custom check '%s' failed."), *ClassName, *PropertyName, *InvariantRule);
-					}
+			if (bIncremental && Plan.HasFingerprint()) {
+				for (int32 RunIndex = 0; RunIndex < Run.Num(); ++RunIndex) {
+					FLifeInvariantFingerprints::Store(Run[RunIndex], SortedFingerprints[Group.First + RunIndex]);
 				}
 			}
+
+			if (Group.SamplingState) {
+				FLifeInvariantSampler::Record(*Group.SamplingState, FPlatformTime::Cycles64() - StartCycles, Group.Num);
+			}
 		}
-		for (TFieldIterator<UFunction> FuncIt(Class); FuncIt; ++FuncIt)
-		{
-			UFunction* Function = *FuncIt;
-			if (Function->HasMetaData(TEXT("Invariant")))
-			{
-				const FString FunctionName = Function->GetName();
 
-				// Check for const, no parameters, and bool return type
-				checkf(Function->HasAnyFunctionFlags(FUNC_Const), TEXT("Invariant function '%s' on class '%s' must be const."), *FunctionName, *ClassName);
-				checkf(Function->NumParms == 1, TEXT("Invariant function '%s' on class '%s' must have no parameters and return a bool."), *FunctionName, *ClassName);
+		Walk.RunDeferredRoots();
+	}
 
-				FBoolProperty* ReturnProp = CastField<FBoolProperty>(Function->GetReturnProperty());
-				checkf(ReturnProp != nullptr, TEXT("Invariant function '%s' on class '%s' must return a bool."), *FunctionName, *ClassName);
+	/** A failed entry found by a worker, reported on the game thread after the join. */
+	struct FLifeInvariantSweepFailure
+	{
+		int32 ObjectIndex = INDEX_NONE;
+		int32 EntryIndex = INDEX_NONE;
+	};
 
-				if (ReturnProp)
-				{
-					FStructOnScope FuncParams(Function);
-					const_cast<UObject*>(Object)->ProcessEvent(Function, FuncParams.GetStructMemory());
+	/**
+	 * Worker side of the sweep: runs every kernel of a pure plan and records failures instead of asserting, so no
+	 * thread but the game thread ever reports.
+	 */
+	static void CollectInvariantFailures(const UObject* Object, const FLifeInvariantPlan& Plan, int32 ObjectIndex,
+		bool bUseBatches, TArray<FLifeInvariantSweepFailure>& OutFailures)
+	{
+		const uint8* ObjectBase = reinterpret_cast<const uint8*>(Object);
 
-					const bool bIsValid = ReturnProp->GetPropertyValue(FuncParams.GetStructMemory());
-					checkf(bIsValid, TEXT("Invariant violation: Custom check function '%s' on class '%s' failed."), *FunctionName, *ClassName);
+		if (bUseBatches) {
+			for (const FLifeInvariantBatch& Batch : Plan.Batches) {
+				if (LIKELY(TestInvariantBatch(Batch, ObjectBase))) {
+					continue;
+				}
+				for (const int32 EntryIndex : Batch.EntryIndices) {
+					const FLifeInvariantEntry& Entry = Plan.Entries[EntryIndex];
+					if (!Entry.Kernel(Entry, ObjectBase + Entry.Offset)) {
+						OutFailures.Add({ ObjectIndex, EntryIndex });
+					}
 				}
 			}
 		}
+
+		if (!Plan.StrictPointerOffsets.IsEmpty()) {
+			PrefetchObjectItems(Plan, ObjectBase);
+		}
+
+		for (int32 EntryIndex = 0; EntryIndex < Plan.Entries.Num(); ++EntryIndex) {
+			const FLifeInvariantEntry& Entry = Plan.Entries[EntryIndex];
+			if (bUseBatches && Entry.bBatched) {
+				continue;
+			}
+			if (UNLIKELY(!Entry.Kernel(Entry, ObjectBase + Entry.Offset))) {
+				OutFailures.Add({ ObjectIndex, EntryIndex });
+			}
+		}
+	}
+
+	int32 Debug::CheckAllClassInvariants(bool bParallel)
+	{
+		LG_SCOPE_CYCLE_COUNTER(STAT_LifeCheckAllInvariants);
+		check(IsInGameThread());
+
+		const double StartTime = FPlatformTime::Seconds();
+
+		// Nothing may be collected while the workers hold raw pointers
+		FGCScopeGuard GCGuard;
+
+		// Plans are fetched (and built) here, the workers only ever read them
+		TArray<const UObject*> WorkerObjects;
+		TArray<const FLifeInvariantPlan*> WorkerPlans;
+		TArray<const UObject*> GameThreadObjects;
+
+		const UClass* LastClass = nullptr;
+		const FLifeInvariantPlan* LastPlan = nullptr;
+		for (TObjectIterator<UObject> It(RF_ClassDefaultObject | RF_ArchetypeObject, true, EInternalObjectFlags::Garbage); It; ++It) {
+			const UObject* Object = *It;
+			const UClass* Class = Object->GetClass();
+			if (Class != LastClass) {
+				LastClass = Class;
+				LastPlan = &FLifeInvariantPlanCache::GetPlan(Class);
+			}
+			if (LastPlan->IsEmpty()) {
+				continue;
+			}
+
+			if (LastPlan->bPureFieldReads) {
+				WorkerObjects.Add(Object);
+				WorkerPlans.Add(LastPlan);
+			}
+			else {
+				GameThreadObjects.Add(Object);
+			}
+		}
+
+		// Fixed-size slices, each with its own failure list. Concatenating them in slice order keeps the report
+		// independent of which worker finished first.
+		constexpr int32 SliceSize = 256;
+		const int32 NumSlices = FMath::DivideAndRoundUp(WorkerObjects.Num(), SliceSize);
+		TArray<TArray<FLifeInvariantSweepFailure>> SliceFailures;
+		SliceFailures.SetNum(NumSlices);
+
+		const bool bUseBatches = GLifeInvariantsUseBatches;
+		ParallelFor(NumSlices, [&](int32 SliceIndex)
+		{
+			const int32 First = SliceIndex * SliceSize;
+			const int32 Last = FMath::Min(First + SliceSize, WorkerObjects.Num());
+			for (int32 ObjectIndex = First; ObjectIndex < Last; ++ObjectIndex) {
+				CollectInvariantFailures(WorkerObjects[ObjectIndex], *WorkerPlans[ObjectIndex], ObjectIndex, bUseBatches, SliceFailures[SliceIndex]);
+			}
+		}, bParallel ? EParallelForFlags::None : EParallelForFlags::ForceSingleThread);
+
+		// Every failure is logged before the first one asserts, so a single sweep shows the whole picture
+		const FLifeInvariantSweepFailure* FirstFailure = nullptr;
+		int32 NumFailures = 0;
+		for (const TArray<FLifeInvariantSweepFailure>& Failures : SliceFailures) {
+			for (const FLifeInvariantSweepFailure& Failure : Failures) {
+				const UObject* Object = WorkerObjects[Failure.ObjectIndex];
+				const FLifeInvariantEntry& Entry = WorkerPlans[Failure.ObjectIndex]->Entries[Failure.EntryIndex];
+				UE_LOG(LogLife, Error, TEXT("%s (%s)"), *DescribeInvariantViolation(Object, Entry), *Object->GetPathName());
+				FirstFailure = FirstFailure ? FirstFailure : &Failure;
+				++NumFailures;
+			}
+		}
+		if (FirstFailure) {
+			UE_LOG(LogLife, Error, TEXT("Invariant sweep found %d violations"), NumFailures);
+			ReportInvariantViolation(WorkerObjects[FirstFailure->ObjectIndex], WorkerPlans[FirstFailure->ObjectIndex]->Entries[FirstFailure->EntryIndex]);
+		}
+
+		// Contract* references and custom functions need the game thread. The whole sweep shares one walk, so objects
+		// already reached through a Contract* reference aren't checked again.
+		FLifeContractWalk Walk;
+		for (const UObject* Object : GameThreadObjects) {
+			if (Walk.IsVisited(Object)) {
+				continue;
+			}
+			const FLifeInvariantPlan& Plan = FLifeInvariantPlanCache::GetPlan(Object->GetClass());
+			CheckObjectInvariants(Object, Plan, false, &Walk, Walk.AddRoot(Object));
+			Walk.Run();
+		}
+
+		INC_DWORD_STAT_BY(STAT_LifeObjectsChecked, WorkerObjects.Num() + GameThreadObjects.Num());
+		UE_LOG(LogLife, Log, TEXT("Checked the invariants of %d objects (%d on workers, %d on the game thread) in %.2f ms"),
+			WorkerObjects.Num() + GameThreadObjects.Num(), WorkerObjects.Num(), GameThreadObjects.Num(),
+			(FPlatformTime::Seconds() - StartTime) * 1000.0);
+
+		return WorkerObjects.Num() + GameThreadObjects.Num();
 	}
-}
\ No newline at end of file
+}
+
+static FAutoConsoleCommand GLifeCmd_CheckAllInvariants(
+	TEXT("Lifeguard.CheckAllInvariants"),
+	TEXT("Checks the class invariants of every live object that has any. Pure field checks run on worker threads. Usage: Lifeguard.CheckAllInvariants [serial]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		const bool bParallel = !(Args.Num() > 0 && Args[0].Equals(TEXT("serial"), ESearchCase::IgnoreCase));
+		Debug::CheckAllClassInvariants(bParallel);
+	})
+);
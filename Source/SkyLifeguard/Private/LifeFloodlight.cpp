@@ -3,25 +3,68 @@
 #include "Engine/Engine.h"
 #include "Kismet/GameplayStatics.h"
 #include "DrawDebugHelpers.h"
+#include "Hash/CityHash.h"
+#include "LifeFloodlightExport.h"
+#include "LifeStats.h"
+#include "Misc/CommandLine.h"
 
 // Static member initialization
 FLifeDomainErrorFloodlight::FConfig FLifeDomainErrorFloodlight::Config;
-TArray<FLifeDomainError> FLifeDomainErrorFloodlight::ActiveErrors;
+TArray<FLifeDomainError> FLifeDomainErrorFloodlight::ErrorRing;
+TArray<TCHAR> FLifeDomainErrorFloodlight::ErrorText;
+int32 FLifeDomainErrorFloodlight::FirstError = 0;
+int32 FLifeDomainErrorFloodlight::NumErrors = 0;
+TMap<uint64, int32> FLifeDomainErrorFloodlight::ErrorIndex;
+TMap<uint64, int32> FLifeDomainErrorFloodlight::EvictedCounts;
+FLifeDomainErrorOverflow FLifeDomainErrorFloodlight::Overflow;
 int32 FLifeDomainErrorFloodlight::CurrentBudget = 0;
 float FLifeDomainErrorFloodlight::FlashTimer = 0.0f;
 bool FLifeDomainErrorFloodlight::bInitialized = false;
 TUniquePtr<FLifeDomainErrorOutputDevice> FLifeDomainErrorFloodlight::OutputDevice = nullptr;
 FString FLifeScopedDomainErrorContext::CurrentContext;
 TOptional<ELifeDomainErrorSeverity> FLifeDomainErrorFloodlight::TestFlashSeverity;
+TQueue<FLifeDomainErrorFloodlight::FPendingReport, EQueueMode::Mpsc> FLifeDomainErrorFloodlight::PendingReports;
+FLifeDomainErrorFloodlight::FReportBatch FLifeDomainErrorFloodlight::Batch;
+FLifeDomainErrorFloodlight::FOverlayCache FLifeDomainErrorFloodlight::OverlayCache;
+bool FLifeDomainErrorFloodlight::bOverlayDirty = true;
+
+// Height of one row of the overlay error list
+static constexpr float OverlayItemHeight = 80.0f;
 
 // Console command instances (persist for lifetime)
 static TUniquePtr<FAutoConsoleCommand> GLifeFloodlightCmd_ClearAll;
 static TUniquePtr<FAutoConsoleCommand> GLifeFloodlightCmd_TestFlash;
 static TUniquePtr<FAutoConsoleCommand> GLifeFloodlightCmd_Acknowledge;
 static TUniquePtr<FAutoConsoleCommand> GLifeFloodlightCmd_EmitError;
+static TUniquePtr<FAutoConsoleCommand> GLifeFloodlightCmd_Stats;
+
+/** Hash of the call-site part of an error signature. */
+static uint64 HashDomainErrorContext(FStringView Context)
+{
+	return CityHash64(reinterpret_cast<const char*>(Context.GetData()), Context.Len() * sizeof(TCHAR));
+}
+
+FLifeDomainCallSite::FLifeDomainCallSite(const ANSICHAR* InFunction, const TCHAR* InFile, int32 InLine)
+	: Function(InFunction)
+	, File(InFile)
+	, Line(InLine)
+	, Context(FString::Printf(TEXT("%hs @ %s:%d"), InFunction, InFile, InLine))
+	, ContextHash(HashDomainErrorContext(Context))
+{
+}
+
+/** Filter bit of a category comparison index, Fibonacci hashed to 6 bits. */
+static uint64 GetInterceptedFilterBit(uint32 CategoryId)
+{
+	return 1ull << ((CategoryId * 0x9E3779B9u) >> 26);
+}
 
 FLifeDomainErrorOutputDevice::FLifeDomainErrorOutputDevice()
 {
+	for (std::atomic<uint32>& Slot : InterceptedCategories) {
+		Slot.store(0, std::memory_order_relaxed);
+	}
+	
 	// Add to GLog's output device chain
 	GLog->AddOutputDevice(this);
 }
@@ -34,12 +77,81 @@ FLifeDomainErrorOutputDevice::~FLifeDomainErrorOutputDevice()
 
 void FLifeDomainErrorOutputDevice::Serialize(const TCHAR* V, ELogVerbosity::Type Verbosity, const FName& Category)
 {
+	// Verbosity first, it's a compare and most lines are Log or Verbose which never become domain errors
+	const ELogVerbosity::Type Level = static_cast<ELogVerbosity::Type>(Verbosity & ELogVerbosity::VerbosityMask);
+	if (Level == ELogVerbosity::NoLogging || Level > ELogVerbosity::Warning) {
+		return;
+	}
+	
 	// Only intercept if this category is registered
-	if (!InterceptedCategories.Contains(Category)) {
+	if (!IsIntercepted(Category)) {
 		return;
 	}
     
-	ProcessInterceptedLog(V, Verbosity, Category);
+	ProcessInterceptedLog(V, Level, Category);
+}
+
+bool FLifeDomainErrorOutputDevice::AddInterceptedCategory(const FName& Category)
+{
+	check(IsInGameThread());
+	
+	const uint32 CategoryId = Category.GetComparisonIndex().ToUnstableInt();
+	int32 FreeSlot = INDEX_NONE;
+	for (int32 Slot = 0; Slot < MaxInterceptedCategories; ++Slot) {
+		const uint32 SlotId = InterceptedCategories[Slot].load(std::memory_order_relaxed);
+		if (SlotId == CategoryId) {
+			return true;
+		}
+		if (SlotId == 0 && FreeSlot == INDEX_NONE) {
+			FreeSlot = Slot;
+		}
+	}
+	if (FreeSlot == INDEX_NONE) {
+		return false;
+	}
+	
+	// Slot before filter bit, so a reader that passes the filter finds the slot
+	InterceptedCategories[FreeSlot].store(CategoryId, std::memory_order_release);
+	InterceptedFilter.fetch_or(GetInterceptedFilterBit(CategoryId), std::memory_order_release);
+	return true;
+}
+
+void FLifeDomainErrorOutputDevice::RemoveInterceptedCategory(const FName& Category)
+{
+	check(IsInGameThread());
+	
+	const uint32 CategoryId = Category.GetComparisonIndex().ToUnstableInt();
+	for (std::atomic<uint32>& Slot : InterceptedCategories) {
+		if (Slot.load(std::memory_order_relaxed) == CategoryId) {
+			Slot.store(0, std::memory_order_release);
+		}
+	}
+	RebuildInterceptedFilter();
+}
+
+bool FLifeDomainErrorOutputDevice::IsIntercepted(const FName& Category) const
+{
+	const uint32 CategoryId = Category.GetComparisonIndex().ToUnstableInt();
+	if ((InterceptedFilter.load(std::memory_order_acquire) & GetInterceptedFilterBit(CategoryId)) == 0) {
+		return false;
+	}
+	for (const std::atomic<uint32>& Slot : InterceptedCategories) {
+		if (Slot.load(std::memory_order_acquire) == CategoryId) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void FLifeDomainErrorOutputDevice::RebuildInterceptedFilter()
+{
+	uint64 Filter = 0;
+	for (const std::atomic<uint32>& Slot : InterceptedCategories) {
+		if (const uint32 SlotId = Slot.load(std::memory_order_relaxed)) {
+			Filter |= GetInterceptedFilterBit(SlotId);
+		}
+	}
+	InterceptedFilter.store(Filter, std::memory_order_release);
 }
 
 void FLifeDomainErrorOutputDevice::ProcessInterceptedLog(const FString& Message, ELogVerbosity::Type Verbosity,
@@ -77,7 +189,8 @@ void FLifeDomainErrorFloodlight::Initialize(const FConfig& InConfig)
 	Config = InConfig;
 	CurrentBudget = 0;
 	FlashTimer = 0.0f;
-	ActiveErrors.Empty();
+	Batch = FReportBatch();
+	AllocateErrorStorage();
 	TestFlashSeverity.Reset();
     
 	// Create output device
@@ -107,6 +220,17 @@ void FLifeDomainErrorFloodlight::Initialize(const FConfig& InConfig)
 		TEXT("Emits one or more real domain warnings/errors (affects budget). Usage: Floodlight.EmitError warning|error [count] [message...]"),
 		FConsoleCommandWithArgsDelegate::CreateStatic(&FLifeDomainErrorFloodlight::Console_EmitError)
 	);
+	
+	GLifeFloodlightCmd_Stats = MakeUnique<FAutoConsoleCommand>(
+		TEXT("Floodlight.Stats"),
+		TEXT("Logs the active domain errors with the highest report rate. Usage: Floodlight.Stats [count]"),
+		FConsoleCommandWithArgsDelegate::CreateStatic(&FLifeDomainErrorFloodlight::Console_Stats)
+	);
+    
+	// Farm runs pass the export file on the command line
+	FString ExportPath = Config.ExportPath;
+	FParse::Value(FCommandLine::Get(), TEXT("FloodlightExport="), ExportPath);
+	FLifeDomainErrorExporter::Initialize(ExportPath);
     
 	bInitialized = true;
     
@@ -120,8 +244,19 @@ void FLifeDomainErrorFloodlight::Shutdown()
 		return;
 	}
     
+	// Logs this frame's errors and leaves the budget as it would be after the next Tick
+	ApplyReportBatch();
+	
 	OutputDevice.Reset();
-	ActiveErrors.Empty();
+	PendingReports.Empty();
+	FLifeDomainErrorExporter::Shutdown();
+	ErrorRing.Empty();
+	ErrorText.Empty();
+	FirstError = 0;
+	NumErrors = 0;
+	ErrorIndex.Empty();
+	EvictedCounts.Empty();
+	Overflow = FLifeDomainErrorOverflow();
 	TestFlashSeverity.Reset();
 	
 	// Tear down console commands
@@ -129,6 +264,7 @@ void FLifeDomainErrorFloodlight::Shutdown()
 	GLifeFloodlightCmd_TestFlash.Reset();
 	GLifeFloodlightCmd_Acknowledge.Reset();
 	GLifeFloodlightCmd_EmitError.Reset();
+	GLifeFloodlightCmd_Stats.Reset();
 	
 	bInitialized = false;
     
@@ -152,9 +288,19 @@ void FLifeDomainErrorFloodlight::ReportCritical(const FString& Message, const FS
 
 void FLifeDomainErrorFloodlight::ClearAllErrors()
 {
-	ActiveErrors.Empty();
+	// Clearing errors keeps their budget, and the batch is about to lose the errors it would log
+	if (bInitialized) {
+		ApplyReportBatch();
+	}
+	
+	FirstError = 0;
+	NumErrors = 0;
+	ErrorIndex.Reset();
+	EvictedCounts.Reset();
+	Overflow = FLifeDomainErrorOverflow();
 	FlashTimer = 0.0f;
 	TestFlashSeverity.Reset();
+	bOverlayDirty = true;
     
 	if (GEngine && GEngine->GameViewport) {
 		// TODO if any overlay on the viewport, clear it
@@ -165,9 +311,115 @@ void FLifeDomainErrorFloodlight::ClearAllErrors()
 
 void FLifeDomainErrorFloodlight::AcknowledgeError(int32 Index)
 {
-	if (ActiveErrors.IsValidIndex(Index))
+	if (Index >= 0 && Index < NumErrors)
+	{
+		// Close the gap, later errors move one slot towards the oldest
+		for (int32 i = Index; i < NumErrors - 1; ++i)
+		{
+			const FLifeDomainError& Next = ErrorRing[GetErrorSlot(i + 1)];
+			StoreError(GetErrorSlot(i), Next, Next.Message, Next.Context);
+		}
+		--NumErrors;
+		RebuildErrorIndex();
+		bOverlayDirty = true;
+	}
+}
+
+const FLifeDomainError& FLifeDomainErrorFloodlight::GetActiveError(int32 Index)
+{
+	check(Index >= 0 && Index < NumErrors);
+	return ErrorRing[GetErrorSlot(Index)];
+}
+
+int32 FLifeDomainErrorFloodlight::GetOccurrenceCount(uint64 Signature)
+{
+	if (const int32* Slot = ErrorIndex.Find(Signature))
 	{
-		ActiveErrors.RemoveAt(Index);
+		return ErrorRing[*Slot].OccurrenceCount;
+	}
+	const int32* Evicted = EvictedCounts.Find(Signature);
+	return Evicted ? *Evicted : 0;
+}
+
+void FLifeDomainErrorFloodlight::AllocateErrorStorage()
+{
+	// Sized once from the memory ceiling, storing an error never allocates
+	Config.MaxErrorTextLength = FMath::Max(16, Config.MaxErrorTextLength);
+	const int64 BytesPerError = sizeof(FLifeDomainError) + Config.MaxErrorTextLength * sizeof(TCHAR);
+	const int32 Capacity = static_cast<int32>(FMath::Clamp<int64>(Config.MaxErrorMemoryKB * 1024ll / BytesPerError,
+		1, MAX_int32 / Config.MaxErrorTextLength));
+	
+	ErrorRing.Empty(Capacity);
+	ErrorRing.SetNum(Capacity);
+	ErrorText.Empty();
+	ErrorText.SetNumZeroed(Capacity * Config.MaxErrorTextLength);
+	FirstError = 0;
+	NumErrors = 0;
+	ErrorIndex.Empty(Capacity);
+	EvictedCounts.Empty();
+	Overflow = FLifeDomainErrorOverflow();
+	bOverlayDirty = true;
+}
+
+void FLifeDomainErrorFloodlight::StoreError(int32 Slot, const FLifeDomainError& Error, FStringView Message,
+	FStringView Context)
+{
+	// The context gets up to half the slot, the message the rest
+	const int32 TextLength = Config.MaxErrorTextLength;
+	TCHAR* Text = ErrorText.GetData() + Slot * TextLength;
+	const int32 ContextLen = FMath::Min(Context.Len(), TextLength / 2);
+	const int32 MessageLen = FMath::Min(Message.Len(), TextLength - ContextLen);
+	FMemory::Memmove(Text, Message.GetData(), MessageLen * sizeof(TCHAR));
+	FMemory::Memmove(Text + MessageLen, Context.GetData(), ContextLen * sizeof(TCHAR));
+	
+	FLifeDomainError& Stored = ErrorRing[Slot];
+	Stored = Error;
+	Stored.Message = FStringView(Text, MessageLen);
+	Stored.Context = FStringView(Text + MessageLen, ContextLen);
+}
+
+void FLifeDomainErrorFloodlight::EvictOldestError()
+{
+	const int32 Slot = GetErrorSlot(0);
+	const FLifeDomainError& Oldest = ErrorRing[Slot];
+	
+	if (const int32* Indexed = ErrorIndex.Find(Oldest.Signature); Indexed && *Indexed == Slot)
+	{
+		ErrorIndex.Remove(Oldest.Signature);
+	}
+	
+	int32& EvictedCount = EvictedCounts.FindOrAdd(Oldest.Signature, 0);
+	if (EvictedCount == 0)
+	{
+		++Overflow.NumErrors;
+		Overflow.NumWarnings += Oldest.Severity == ELifeDomainErrorSeverity::Warning ? 1 : 0;
+	}
+	EvictedCount += Oldest.OccurrenceCount;
+	Overflow.OccurrenceCount += Oldest.OccurrenceCount;
+	
+	FirstError = (FirstError + 1) % ErrorRing.Num();
+	--NumErrors;
+}
+
+uint64 FLifeDomainErrorFloodlight::ComputeSignature(FStringView Message, uint64 ContextHash,
+	ELifeDomainErrorSeverity Severity)
+{
+	// The context hash comes first so call sites can compute it once
+	const uint64 Seed = ContextHash ^ ((static_cast<uint64>(Severity) + 1) * 0x9E3779B97F4A7C15ull);
+	return CityHash64WithSeed(reinterpret_cast<const char*>(Message.GetData()), Message.Len() * sizeof(TCHAR), Seed);
+}
+
+void FLifeDomainErrorFloodlight::RebuildErrorIndex()
+{
+	ErrorIndex.Reset();
+	for (int32 Index = 0; Index < NumErrors; ++Index)
+	{
+		// First one wins on the (astronomically unlikely) hash collision, like the insertion in ApplyReport
+		const int32 Slot = GetErrorSlot(Index);
+		if (!ErrorIndex.Contains(ErrorRing[Slot].Signature))
+		{
+			ErrorIndex.Add(ErrorRing[Slot].Signature, Slot);
+		}
 	}
 }
 
@@ -211,6 +463,7 @@ void FLifeDomainErrorFloodlight::Console_TestFlash(const TArray<FString>& Args)
 	}
 	
 	TestFlashSeverity = Severity;
+	bOverlayDirty = true;
 	TriggerFlash(Severity);
 
 	// Optionally play alert sound (TriggerFlash + PlayAlertSound are private but accessible here)
@@ -235,7 +488,7 @@ void FLifeDomainErrorFloodlight::Console_Acknowledge(const TArray<FString>& Args
 	}
 
 	int32 Index = FCString::Atoi(*Args[0]);
-	if (!ActiveErrors.IsValidIndex(Index)) {
+	if (Index < 0 || Index >= NumErrors) {
 		UE_LOG(LogTemp, Warning, TEXT("Invalid error index: %d"), Index);
 		return;
 	}
@@ -288,9 +541,66 @@ void FLifeDomainErrorFloodlight::Console_EmitError(const TArray<FString>& Args)
 
 }
 
+void FLifeDomainErrorFloodlight::DrainPendingReports()
+{
+	check(IsInGameThread());
+	
+	FPendingReport Report;
+	while (PendingReports.Dequeue(Report))
+	{
+		ApplyReport(FStringView(Report.Message), Report.Context, Report.ContextHash, Report.Severity);
+	}
+}
+
+void FLifeDomainErrorFloodlight::Console_Stats(const TArray<FString>& Args)
+{
+	if (!bInitialized) {
+		UE_LOG(LogTemp, Warning, TEXT("LifeFloodlight not initialized"));
+		return;
+	}
+
+	const int32 Count = Args.Num() > 0 ? FMath::Max(1, FCString::Atoi(*Args[0])) : 10;
+	const double Now = FPlatformTime::Seconds();
+
+	// Hottest first, by current rate then by peak
+	TArray<int32> Order;
+	Order.Reserve(NumErrors);
+	for (int32 i = 0; i < NumErrors; ++i) {
+		Order.Add(i);
+	}
+	Order.Sort([Now](int32 A, int32 B)
+	{
+		const FLifeDomainError& ErrorA = GetActiveError(A);
+		const FLifeDomainError& ErrorB = GetActiveError(B);
+		const float RateA = ErrorA.GetRate(Now);
+		const float RateB = ErrorB.GetRate(Now);
+		return RateA != RateB ? RateA > RateB : ErrorA.GetPeakRate(Now) > ErrorB.GetPeakRate(Now);
+	});
+
+	UE_LOG(LogTemp, Log, TEXT("Floodlight: %d active errors, %d evicted (%d reports), budget %d/%d"),
+		NumErrors, Overflow.NumErrors, Overflow.OccurrenceCount, CurrentBudget, Config.MaxBudget);
+	for (int32 i = 0; i < FMath::Min(Count, Order.Num()); ++i)
+	{
+		const FLifeDomainError& Error = GetActiveError(Order[i]);
+		UE_LOG(LogTemp, Log, TEXT("  %7.1f/s (peak %7.1f/s) x%-6d first %s last %s [%s] %.*s @ %.*s"),
+			Error.GetRate(Now), Error.GetPeakRate(Now), Error.OccurrenceCount,
+			*Error.FirstSeen.ToString(TEXT("%H:%M:%S")), *Error.Timestamp.ToString(TEXT("%H:%M:%S")),
+			*Error.GetSeverityString(), Error.Message.Len(), Error.Message.GetData(),
+			Error.Context.Len(), Error.Context.GetData());
+	}
+}
+
 void FLifeDomainErrorFloodlight::Tick(float DeltaTime)
 {
-	if (!bInitialized || (ActiveErrors.Num() == 0 && !TestFlashSeverity.IsSet())) {
+	LG_SCOPE_CYCLE_COUNTER(STAT_LifeFloodlightTick);
+
+	if (bInitialized) {
+		DrainPendingReports();
+		ApplyReportBatch();
+		FLifeDomainErrorExporter::Tick();
+	}
+	
+	if (!bInitialized || (NumErrors == 0 && !TestFlashSeverity.IsSet())) {
 		return;
 	}
     
@@ -300,28 +610,25 @@ void FLifeDomainErrorFloodlight::Tick(float DeltaTime)
 		if (FlashTimer < 0.0f || FMath::IsNearlyZero(FlashTimer, 0.01)) FlashTimer = 0.0f;
 		if (FMath::IsNearlyZero(FlashTimer, 0.01) && TestFlashSeverity.IsSet()) {
 			TestFlashSeverity.Reset();
+			bOverlayDirty = true;
 		}
 	}
 }
 
-void FLifeDomainErrorFloodlight::DrawOverlay(UCanvas* Canvas)
+void FLifeDomainErrorFloodlight::RebuildOverlayCache(UCanvas* Canvas)
 {
-	#if !UE_BUILD_SHIPPING
-    
-    if (!bInitialized || !Canvas || (ActiveErrors.Num() == 0 && !TestFlashSeverity.IsSet())) {
-        return;
-    }
-
     const float ScreenWidth = Canvas->SizeX;
     const float ScreenHeight = Canvas->SizeY;
+    OverlayCache.ScreenSize = FVector2D(ScreenWidth, ScreenHeight);
 	
 	// Determine effective severity (test override wins)
-	TOptional<ELifeDomainErrorSeverity> EffectiveSeverity = TestFlashSeverity;
-	if (!EffectiveSeverity.IsSet() && ActiveErrors.Num() > 0)
+	OverlayCache.EffectiveSeverity = TestFlashSeverity;
+	if (!OverlayCache.EffectiveSeverity.IsSet() && NumErrors > 0)
 	{
 		// derive from active errors (most severe)
 		ELifeDomainErrorSeverity Found = ELifeDomainErrorSeverity::Warning;
-		for (const FLifeDomainError& Error : ActiveErrors) {
+		for (int32 i = 0; i < NumErrors; ++i) {
+			const FLifeDomainError& Error = GetActiveError(i);
 			if (Error.Severity == ELifeDomainErrorSeverity::Error) {
 				Found = ELifeDomainErrorSeverity::Error;
 				break;
@@ -331,15 +638,78 @@ void FLifeDomainErrorFloodlight::DrawOverlay(UCanvas* Canvas)
 				break;
 			}
 		}
-		EffectiveSeverity = Found;
+		OverlayCache.EffectiveSeverity = Found;
+	}
+	
+    // Budget bar
+    OverlayCache.BudgetPercent = FMath::Clamp((float)CurrentBudget / (float)Config.MaxBudget, 0.0f, 1.0f);
+    OverlayCache.BudgetColor = FLinearColor::LerpUsingHSV(
+        FLinearColor::Green, 
+        FLinearColor::Red, 
+        OverlayCache.BudgetPercent);
+    OverlayCache.BudgetText = FString::Printf(TEXT("⚠ ERROR BUDGET: %d/%d ⚠"), CurrentBudget, Config.MaxBudget);
+    float TextWidth, TextHeight;
+    Canvas->TextSize(GEngine->GetLargeFont(), OverlayCache.BudgetText, TextWidth, TextHeight);
+    OverlayCache.BudgetTextX = (ScreenWidth - TextWidth) * 0.5f;
+    
+    // Error rows
+    OverlayCache.ListHeight = FMath::Min(400.0f, ScreenHeight - 200.0f);
+    const int32 MaxVisible = FMath::Max(0, FMath::FloorToInt((OverlayCache.ListHeight - 20.0f) / OverlayItemHeight));
+    const int32 DisplayCount = FMath::Min(NumErrors, MaxVisible);
+    OverlayCache.Rows.Reset(DisplayCount);
+    for (int32 i = 0; i < DisplayCount; ++i)
+    {
+        const FLifeDomainError& Error = GetActiveError(i);
+        FOverlayRow& Row = OverlayCache.Rows.AddDefaulted_GetRef();
+        Row.Color = Error.GetSeverityColor();
+        Row.Text = FString::Printf(TEXT("[%s] %.*s"), 
+            *Error.GetSeverityString(), 
+            Error.Message.Len(), Error.Message.GetData());
+        if (Error.OccurrenceCount > 1)
+        {
+            Row.Text += FString::Printf(TEXT(" (x%d)"), Error.OccurrenceCount);
+        }
+        Row.Context = FString(Error.Context);
+        Row.Time = Error.Timestamp.ToString(TEXT("%H:%M:%S"));
+    }
+    
+    // Show "... and N more" if truncated. Evicted errors count as more too.
+    const int32 NumHidden = FMath::Max(0, NumErrors - MaxVisible) + Overflow.NumErrors;
+    OverlayCache.MoreText = NumHidden > 0 ? FString::Printf(TEXT("... and %d more errors"), NumHidden) : FString();
+    
+    bOverlayDirty = false;
+}
+
+void FLifeDomainErrorFloodlight::DrawOverlay(UCanvas* Canvas)
+{
+	#if !UE_BUILD_SHIPPING
+	LG_SCOPE_CYCLE_COUNTER(STAT_LifeFloodlightOverlay);
+	
+	if (bInitialized) {
+		DrainPendingReports();
+		ApplyReportBatch();
+	}
+    
+    if (!bInitialized || !Canvas || (NumErrors == 0 && !TestFlashSeverity.IsSet())) {
+        return;
+    }
+
+    const float ScreenWidth = Canvas->SizeX;
+    const float ScreenHeight = Canvas->SizeY;
+	
+	// Text, colors and layout only change with the errors, the budget or the screen size. Per frame it's just the
+	// flash alpha and the draw calls.
+	if (bOverlayDirty || OverlayCache.ScreenSize != FVector2D(ScreenWidth, ScreenHeight))
+	{
+		RebuildOverlayCache(Canvas);
 	}
 
 	// Full-screen flash (draw first so UI is on top)
-	if (FlashTimer > 0.0f && EffectiveSeverity.IsSet())
+	if (FlashTimer > 0.0f && OverlayCache.EffectiveSeverity.IsSet())
 	{
 		// Determine color based on effective severity
 		FLinearColor FlashColor = FLinearColor::Black;
-		switch (EffectiveSeverity.GetValue())
+		switch (OverlayCache.EffectiveSeverity.GetValue())
 		{
 		case ELifeDomainErrorSeverity::Warning: FlashColor = FLinearColor::Yellow; break;
 		case ELifeDomainErrorSeverity::Error: FlashColor = FLinearColor::Red; break;
@@ -360,7 +730,7 @@ void FLifeDomainErrorFloodlight::DrawOverlay(UCanvas* Canvas)
 	}
     
 	// Now we need to check if there's any real errors, previous part included flash testing functionality
-	if (ActiveErrors.Num() == 0) 
+	if (NumErrors == 0) 
 		return;
 	
     // Draw budget bar at top
@@ -377,97 +747,67 @@ void FLifeDomainErrorFloodlight::DrawOverlay(UCanvas* Canvas)
         Canvas->DrawItem(BackgroundTile);
         
         // Budget fill
-        float BudgetPercent = FMath::Clamp((float)CurrentBudget / (float)Config.MaxBudget, 0.0f, 1.0f);
-        FLinearColor BudgetColor = FLinearColor::LerpUsingHSV(
-            FLinearColor::Green, 
-            FLinearColor::Red, 
-            BudgetPercent);
-        
         FCanvasTileItem BudgetFill(
             FVector2D(15.0f, BudgetBarY + 5.0f),
-            FVector2D((ScreenWidth - 30.0f) * BudgetPercent, BudgetBarHeight - 10.0f),
-            BudgetColor);
+            FVector2D((ScreenWidth - 30.0f) * OverlayCache.BudgetPercent, BudgetBarHeight - 10.0f),
+            OverlayCache.BudgetColor);
         BudgetFill.BlendMode = SE_BLEND_Translucent;
         Canvas->DrawItem(BudgetFill);
         
         // Text
-        FString BudgetText = FString::Printf(TEXT("⚠ ERROR BUDGET: %d/%d ⚠"), CurrentBudget, Config.MaxBudget);
         Canvas->SetDrawColor(FColor::White);
-        float TextWidth, TextHeight;
-        Canvas->TextSize(GEngine->GetLargeFont(), BudgetText, TextWidth, TextHeight);
-        Canvas->DrawText(GEngine->GetLargeFont(), BudgetText, 
-            (ScreenWidth - TextWidth) * 0.5f, BudgetBarY + 15.0f);
+        Canvas->DrawText(GEngine->GetLargeFont(), OverlayCache.BudgetText, 
+            OverlayCache.BudgetTextX, BudgetBarY + 15.0f);
     }
     
     // Draw error list
     {
         const float ListY = 80.0f;
-        const float ListHeight = FMath::Min(400.0f, ScreenHeight - 200.0f);
-        const float ItemHeight = 80.0f;
         
         // Background
         FCanvasTileItem ListBackground(
             FVector2D(10.0f, ListY),
-            FVector2D(ScreenWidth - 20.0f, ListHeight),
+            FVector2D(ScreenWidth - 20.0f, OverlayCache.ListHeight),
             FLinearColor(0.0f, 0.0f, 0.0f, 0.7f));
         ListBackground.BlendMode = SE_BLEND_Translucent;
         Canvas->DrawItem(ListBackground);
         
         // Errors
         float CurrentY = ListY + 10.0f;
-        int32 MaxVisible = FMath::FloorToInt((ListHeight - 20.0f) / ItemHeight);
-        int32 DisplayCount = FMath::Min(ActiveErrors.Num(), MaxVisible);
-        
-        for (int32 i = 0; i < DisplayCount; ++i)
+        for (const FOverlayRow& Row : OverlayCache.Rows)
         {
-            const FLifeDomainError& Error = ActiveErrors[i];
-            
             // Severity badge
-            FLinearColor SeverityColor = Error.GetSeverityColor();
             FCanvasTileItem SeverityBadge(
                 FVector2D(20.0f, CurrentY),
-                FVector2D(10.0f, ItemHeight - 10.0f),
-                SeverityColor);
+                FVector2D(10.0f, OverlayItemHeight - 10.0f),
+                Row.Color);
             Canvas->DrawItem(SeverityBadge);
             
             // Error text
             Canvas->SetDrawColor(FColor::White);
-            FString ErrorText = FString::Printf(TEXT("[%s] %s"), 
-                *Error.GetSeverityString(), 
-                *Error.Message);
-            
-            if (Error.OccurrenceCount > 1)
-            {
-                ErrorText += FString::Printf(TEXT(" (x%d)"), Error.OccurrenceCount);
-            }
-            
-            Canvas->DrawText(GEngine->GetMediumFont(), ErrorText, 40.0f, CurrentY + 5.0f);
+            Canvas->DrawText(GEngine->GetMediumFont(), Row.Text, 40.0f, CurrentY + 5.0f);
             
             // Context (smaller)
             Canvas->SetDrawColor(FColor(200, 200, 200));
-            Canvas->DrawText(GEngine->GetSmallFont(), Error.Context, 40.0f, CurrentY + 30.0f);
+            Canvas->DrawText(GEngine->GetSmallFont(), Row.Context, 40.0f, CurrentY + 30.0f);
             
             // Timestamp
-            FString TimeStr = Error.Timestamp.ToString(TEXT("%H:%M:%S"));
-            Canvas->DrawText(GEngine->GetSmallFont(), TimeStr, 40.0f, CurrentY + 50.0f);
+            Canvas->DrawText(GEngine->GetSmallFont(), Row.Time, 40.0f, CurrentY + 50.0f);
             
-            CurrentY += ItemHeight;
+            CurrentY += OverlayItemHeight;
         }
         
-        // Show "... and N more" if truncated
-        if (ActiveErrors.Num() > MaxVisible)
+        if (!OverlayCache.MoreText.IsEmpty())
         {
             Canvas->SetDrawColor(FColor::Yellow);
-            FString MoreText = FString::Printf(TEXT("... and %d more errors"), 
-                ActiveErrors.Num() - MaxVisible);
-            Canvas->DrawText(GEngine->GetMediumFont(), MoreText, 20.0f, CurrentY);
+            Canvas->DrawText(GEngine->GetMediumFont(), OverlayCache.MoreText, 20.0f, CurrentY);
         }
     }
     
     // Instructions
     {
+        static const FString Instructions = TEXT("Press F9 to clear errors | F10 to reset budget");
         Canvas->SetDrawColor(FColor::White);
-        FString Instructions = TEXT("Press F9 to clear errors | F10 to reset budget");
         Canvas->DrawText(GEngine->GetSmallFont(), Instructions, 20.0f, ScreenHeight - 40.0f);
     }
     
@@ -478,7 +818,12 @@ void FLifeDomainErrorFloodlight::RegisterInterceptCategory(const FName& Category
 {
 	if (OutputDevice)
 	{
-		OutputDevice->InterceptedCategories.Add(Category);
+		if (!OutputDevice->AddInterceptedCategory(Category))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Can't intercept category %s, all %d slots are taken"), *Category.ToString(),
+				FLifeDomainErrorOutputDevice::MaxInterceptedCategories);
+			return;
+		}
 		UE_LOG(LogTemp, Log, TEXT("Registered domain error interception for category: %s"), *Category.ToString());
 	}
 }
@@ -487,95 +832,263 @@ void FLifeDomainErrorFloodlight::UnregisterInterceptCategory(const FName& Catego
 {
 	if (OutputDevice)
 	{
-		OutputDevice->InterceptedCategories.Remove(Category);
+		OutputDevice->RemoveInterceptedCategory(Category);
 	}
 }
 
+void FLifeDomainErrorFloodlight::ReportAtSite(FLifeDomainCallSite& Site, ELifeDomainErrorSeverity Severity,
+	FStringView Message)
+{
+	ReportInternal(Message, Site.Context, Site.ContextHash, Severity);
+}
+
 void FLifeDomainErrorFloodlight::ReportInternal(const FString& Message, const FString& Context,
 	ELifeDomainErrorSeverity Severity)
+{
+	ReportInternal(FStringView(Message), Context, HashDomainErrorContext(Context), Severity);
+}
+
+void FLifeDomainErrorFloodlight::ReportInternal(FStringView Message, const FString& Context, uint64 ContextHash,
+	ELifeDomainErrorSeverity Severity)
 {
 	#if !UE_BUILD_SHIPPING
+	LG_SCOPE_CYCLE_COUNTER(STAT_LifeFloodlightReport);
+	INC_DWORD_STAT(STAT_LifeFloodlightReports);
     
     if (!bInitialized)
     {
         // Fallback to regular logging if not initialized
-        UE_LOG(LogTemp, Error, TEXT("Domain Error (System Not Initialized): %s"), *Message);
+        UE_LOG(LogTemp, Error, TEXT("Domain Error (System Not Initialized): %.*s"), Message.Len(), Message.GetData());
         return;
     }
     
     // Critical errors bypass the budget system and crash immediately
     if (Severity == ELifeDomainErrorSeverity::Critical)
     {
-        UE_LOG(LogTemp, Fatal, TEXT("CRITICAL DOMAIN ERROR: %s\nContext: %s"), *Message, *Context);
-        checkf(false, TEXT("Critical Domain Error: %s"), *Message);
+        // The errors of this frame go to the log before the crash
+        if (IsInGameThread())
+        {
+            ApplyReportBatch();
+        }
+        
+        // The export file is what CI reads, make sure the crash is in it
+        if (FLifeDomainErrorExporter::IsEnabled() && IsInGameThread())
+        {
+            FLifeDomainError CriticalError;
+            CriticalError.Message = Message;
+            CriticalError.Context = Context;
+            CriticalError.Timestamp = FDateTime::Now();
+            CriticalError.Severity = Severity;
+            CriticalError.Signature = ComputeSignature(Message, ContextHash, Severity);
+            FLifeDomainErrorExporter::OnNewError(CriticalError);
+            FLifeDomainErrorExporter::Flush(true);
+        }
+        UE_LOG(LogTemp, Fatal, TEXT("CRITICAL DOMAIN ERROR: %.*s\nContext: %s"), Message.Len(), Message.GetData(), *Context);
+        checkf(false, TEXT("Critical Domain Error: %.*s"), Message.Len(), Message.GetData());
         return;
     }
     
-    // Check for duplicate error (increment count instead of adding new)
-    for (FLifeDomainError& Error : ActiveErrors)
+    // Workers only queue the report, the game thread owns the errors, the budget and the overlay
+    if (!IsInGameThread())
+    {
+        PendingReports.Enqueue({ FString(Message), Context, ContextHash, Severity });
+        return;
+    }
+    
+    // Apply earlier reports from workers first, so errors stay roughly in report order
+    DrainPendingReports();
+    ApplyReport(Message, Context, ContextHash, Severity);
+    
+    #endif
+
+}
+
+void FLifeDomainErrorFloodlight::ApplyReport(FStringView Message, FStringView Context, uint64 ContextHash,
+	ELifeDomainErrorSeverity Severity)
+{
+    // Nothing may call Tick, the first report of a frame applies the batch of the last one
+    if (Batch.Frame != GFrameCounter)
+    {
+        ApplyReportBatch();
+        Batch.Frame = GFrameCounter;
+    }
+    
+    // Check for duplicate error (increment count instead of adding new). The index finds the candidate slot, a
+    // single compare confirms it's not a hash collision. Stored text may be truncated, so it's compared as a prefix.
+    // Nothing on this path allocates.
+    const uint64 Signature = ComputeSignature(Message, ContextHash, Severity);
+    if (const int32* Slot = ErrorIndex.Find(Signature))
     {
-        if (Error.Message == Message && Error.Severity == Severity)
+        FLifeDomainError& Error = ErrorRing[*Slot];
+        if (Error.Severity == Severity && Context.StartsWith(Error.Context, ESearchCase::CaseSensitive)
+            && Message.StartsWith(Error.Message, ESearchCase::CaseSensitive))
         {
             Error.OccurrenceCount++;
             Error.Timestamp = FDateTime::Now();
+            Error.RecordOccurrence(FPlatformTime::Seconds());
+            FLifeDomainErrorExporter::OnRepeat(Signature);
             
             // Still consume budget for repeated errors
             int32 Cost = (Severity == ELifeDomainErrorSeverity::Warning) ? Config.WarningCost : Config.ErrorCost;
-            ConsumeBudget(Cost);
+            BatchBudget(Cost);
             
             return;
         }
     }
     
-    // Add new error
-    FLifeDomainError NewError(Message, Context, Severity);
-    ActiveErrors.Add(NewError);
-    
-    // Log to output
-    ELogVerbosity::Type LogVerbosity = (Severity == ELifeDomainErrorSeverity::Warning) 
-        ? ELogVerbosity::Warning 
-        : ELogVerbosity::Error;
-    
-    UE_LOG(LogTemp, Error, TEXT("[DOMAIN %s] %s\n  Context: %s\n  Budget: %d/%d"), 
-        *NewError.GetSeverityString(), 
-        *Message, 
-        *Context,
-        CurrentBudget + ((Severity == ELifeDomainErrorSeverity::Warning) ? Config.WarningCost : Config.ErrorCost),
-        Config.MaxBudget);
-    
-    // Trigger visual feedback
-    TriggerFlash(Severity);
-    
-    // Play sound
-    if (Config.bPlaySounds)
+    // Add new error. One that was evicted before carries on counting from where it was.
+    FLifeDomainError NewError;
+    NewError.Timestamp = FDateTime::Now();
+    NewError.FirstSeen = NewError.Timestamp;
+    NewError.RateWindowStart = FPlatformTime::Seconds();
+    NewError.RateWindowCount = 1;
+    NewError.Severity = Severity;
+    NewError.Signature = Signature;
+    if (const int32* EvictedCount = EvictedCounts.Find(Signature))
     {
-        PlayAlertSound(Severity);
+        NewError.OccurrenceCount += *EvictedCount;
+        --Overflow.NumErrors;
+        Overflow.NumWarnings -= Severity == ELifeDomainErrorSeverity::Warning ? 1 : 0;
+        Overflow.OccurrenceCount -= *EvictedCount;
+        EvictedCounts.Remove(Signature);
     }
     
-    // Consume budget
-    int32 Cost = (Severity == ELifeDomainErrorSeverity::Warning) ? Config.WarningCost : Config.ErrorCost;
-    ConsumeBudget(Cost);
+    // Full ring, the oldest error goes to the overflow bucket
+    if (NumErrors == ErrorRing.Num())
+    {
+        EvictOldestError();
+    }
+    const int32 NewSlot = GetErrorSlot(NumErrors++);
+    StoreError(NewSlot, NewError, Message, Context);
+    FLifeDomainErrorExporter::OnNewError(ErrorRing[NewSlot]);
+    if (!ErrorIndex.Contains(Signature))
+    {
+        ErrorIndex.Add(Signature, NewSlot);
+    }
     
-    // Pause game if configured
-    if (Config.bPauseOnError && Severity == ELifeDomainErrorSeverity::Error)
+    // Log, flash, sound and pause wait for the end of the frame, see ApplyReportBatch
+    Batch.NewErrors.Add({ Signature, NewError.OccurrenceCount, Severity });
+    if (!Batch.HighestSeverity.IsSet() || Severity > Batch.HighestSeverity.GetValue())
     {
-        if (UWorld* World = GEngine->GetWorldFromContextObject(GEngine, EGetWorldErrorMode::ReturnNull))
-        {
-            UGameplayStatics::SetGamePaused(World, true);
-        }
+        Batch.HighestSeverity = Severity;
     }
     
-    #endif
+    // Consume budget
+    int32 Cost = (Severity == ELifeDomainErrorSeverity::Warning) ? Config.WarningCost : Config.ErrorCost;
+    BatchBudget(Cost);
+}
+
+void FLifeDomainErrorFloodlight::BatchBudget(int32 Amount)
+{
+	Batch.Budget += Amount;
+	
+	// The crash happens on the same report as without batching, with this frame's errors logged first
+	if (CurrentBudget + Batch.Budget >= Config.MaxBudget)
+	{
+		ApplyReportBatch();
+	}
+}
 
+void FLifeDomainErrorFloodlight::ApplyReportBatch()
+{
+	check(IsInGameThread());
+	
+	if (Batch.NewErrors.IsEmpty() && Batch.Budget == 0)
+	{
+		return;
+	}
+	
+	// Taken out first, the logs below may be intercepted and report again
+	TArray<FBatchedError> NewErrors = MoveTemp(Batch.NewErrors);
+	const int32 Budget = Batch.Budget;
+	const TOptional<ELifeDomainErrorSeverity> HighestSeverity = Batch.HighestSeverity;
+	Batch.NewErrors.Reset();
+	Batch.Budget = 0;
+	Batch.HighestSeverity.Reset();
+	
+	// One line per new error, with its repeats of the frame. Errors evicted or acknowledged since are still counted.
+	const int32 BudgetAfter = CurrentBudget + Budget;
+	int32 NumGone = 0;
+	for (const FBatchedError& Batched : NewErrors)
+	{
+		const int32* Slot = ErrorIndex.Find(Batched.Signature);
+		if (!Slot)
+		{
+			++NumGone;
+			continue;
+		}
+		const FLifeDomainError& Error = ErrorRing[*Slot];
+		const int32 NumReports = Error.OccurrenceCount - Batched.FirstOccurrenceCount + 1;
+		if (NumReports > 1)
+		{
+			UE_LOG(LogTemp, Error, TEXT("[DOMAIN %s] %.*s (x%d this frame)\n  Context: %.*s\n  Budget: %d/%d"), 
+				*Error.GetSeverityString(), 
+				Error.Message.Len(), Error.Message.GetData(), NumReports,
+				Error.Context.Len(), Error.Context.GetData(),
+				BudgetAfter, Config.MaxBudget);
+		}
+		else
+		{
+			UE_LOG(LogTemp, Error, TEXT("[DOMAIN %s] %.*s\n  Context: %.*s\n  Budget: %d/%d"), 
+				*Error.GetSeverityString(), 
+				Error.Message.Len(), Error.Message.GetData(),
+				Error.Context.Len(), Error.Context.GetData(),
+				BudgetAfter, Config.MaxBudget);
+		}
+	}
+	if (NumGone > 0)
+	{
+		UE_LOG(LogTemp, Error, TEXT("[DOMAIN] %d more new errors this frame, already evicted or acknowledged. Budget: %d/%d"),
+			NumGone, BudgetAfter, Config.MaxBudget);
+	}
+	
+	if (HighestSeverity.IsSet())
+	{
+		// Trigger visual feedback
+		TriggerFlash(HighestSeverity.GetValue());
+		
+		// Play sound
+		if (Config.bPlaySounds)
+		{
+			PlayAlertSound(HighestSeverity.GetValue());
+		}
+	}
+	
+	if (Budget > 0)
+	{
+		ConsumeBudget(Budget);
+	}
+	
+	// Pause game if configured
+	if (Config.bPauseOnError && HighestSeverity.IsSet() && HighestSeverity.GetValue() == ELifeDomainErrorSeverity::Error)
+	{
+		if (UWorld* World = GEngine->GetWorldFromContextObject(GEngine, EGetWorldErrorMode::ReturnNull))
+		{
+			UGameplayStatics::SetGamePaused(World, true);
+		}
+	}
+	
+	// Keeps the allocation for the next frame, unless the logs above batched something
+	if (Batch.NewErrors.IsEmpty())
+	{
+		Batch.NewErrors = MoveTemp(NewErrors);
+		Batch.NewErrors.Reset();
+	}
 }
 
 void FLifeDomainErrorFloodlight::ConsumeBudget(int32 Amount)
 {
 	CurrentBudget += Amount;
+	// Once per batch of reports, new errors and repeat counts alike
+	bOverlayDirty = true;
     
 	if (CurrentBudget >= Config.MaxBudget)
 	{
-		// Budget exhausted - crash
+		// Budget exhausted - crash, with the export file complete
+		if (IsInGameThread())
+		{
+			FLifeDomainErrorExporter::Flush(true);
+		}
 		UE_LOG(LogTemp, Fatal, TEXT("DOMAIN ERROR BUDGET EXHAUSTED (%d/%d)"), CurrentBudget, Config.MaxBudget);
 		checkf(false, TEXT("Domain Error Budget Exhausted! Too many domain errors (%d/%d). Fix your content/configuration!"), 
 			CurrentBudget, Config.MaxBudget);
@@ -0,0 +1,262 @@
+﻿#include "LifeFloodlightExport.h"
+
+#include "HAL/FileManager.h"
+#include "LifeFloodlight.h"
+#include "LifeLogChannels.h"
+#include "Misc/CommandLine.h"
+#include "Misc/FileHelper.h"
+#include "String/Find.h"
+#include "String/ParseLines.h"
+#include "Tasks/Pipe.h"
+
+// Static member initialization
+bool FLifeDomainErrorExporter::bEnabled = false;
+FString FLifeDomainErrorExporter::Path;
+TSet<uint64> FLifeDomainErrorExporter::ExportedSignatures;
+TMap<uint64, int32> FLifeDomainErrorExporter::PendingDeltas;
+TArray<uint8> FLifeDomainErrorExporter::Buffer;
+double FLifeDomainErrorExporter::LastFlushSeconds = 0.0;
+
+// Writes run one after the other on a background thread, and only they touch the file until Shutdown
+static UE::Tasks::FPipe GLifeExportPipe(TEXT("FloodlightExport"));
+static TUniquePtr<FArchive> GLifeExportFile;
+
+// Buffered lines are handed to the writer every second, or once they reach this size
+static constexpr int32 LifeExportFlushBytes = 64 * 1024;
+
+/** Appends Text as a JSON string, quotes included. */
+static void AppendJsonString(FStringBuilderBase& Out, FStringView Text)
+{
+	Out.AppendChar(TEXT('"'));
+	for (const TCHAR Char : Text) {
+		switch (Char) {
+		case TEXT('"'): Out.Append(TEXT("\\\"")); break;
+		case TEXT('\\'): Out.Append(TEXT("\\\\")); break;
+		case TEXT('\n'): Out.Append(TEXT("\\n")); break;
+		case TEXT('\r'): Out.Append(TEXT("\\r")); break;
+		case TEXT('\t'): Out.Append(TEXT("\\t")); break;
+		default:
+			if (Char < 0x20) {
+				Out.Appendf(TEXT("\\u%04x"), static_cast<uint32>(Char));
+			} else {
+				Out.AppendChar(Char);
+			}
+		}
+	}
+	Out.AppendChar(TEXT('"'));
+}
+
+void FLifeDomainErrorExporter::Initialize(const FString& InPath)
+{
+	if (InPath.IsEmpty() || bEnabled) {
+		return;
+	}
+
+	GLifeExportFile.Reset(IFileManager::Get().CreateFileWriter(*InPath, FILEWRITE_Append | FILEWRITE_AllowRead));
+	if (!GLifeExportFile) {
+		UE_LOG(LogLife, Warning, TEXT("Can't open Floodlight export file %s"), *InPath);
+		return;
+	}
+
+	Path = InPath;
+	bEnabled = true;
+	LastFlushSeconds = FPlatformTime::Seconds();
+
+	TStringBuilder<1024> Line;
+	Line.Append(TEXT("{\"t\":\"run\",\"time\":"));
+	AppendJsonString(Line, FDateTime::Now().ToIso8601());
+	Line.Append(TEXT(",\"cmdline\":"));
+	AppendJsonString(Line, FCommandLine::Get());
+	Line.AppendChar(TEXT('}'));
+	AppendLine(Line.ToView());
+
+	UE_LOG(LogLife, Log, TEXT("Streaming Floodlight errors to %s"), *Path);
+}
+
+void FLifeDomainErrorExporter::Shutdown()
+{
+	if (!bEnabled) {
+		return;
+	}
+
+	Flush(true);
+	GLifeExportFile.Reset();
+	ExportedSignatures.Empty();
+	PendingDeltas.Empty();
+	Buffer.Empty();
+	bEnabled = false;
+}
+
+void FLifeDomainErrorExporter::OnNewError(const FLifeDomainError& Error)
+{
+	if (!bEnabled) {
+		return;
+	}
+
+	// Evicted or cleared errors that come back are already in the file
+	bool bAlreadyExported = false;
+	ExportedSignatures.Add(Error.Signature, &bAlreadyExported);
+	if (bAlreadyExported) {
+		OnRepeat(Error.Signature);
+		return;
+	}
+
+	TStringBuilder<1024> Line;
+	Line.Appendf(TEXT("{\"t\":\"new\",\"sig\":\"%016llx\",\"sev\":\"%s\",\"msg\":"), Error.Signature, *Error.GetSeverityString());
+	AppendJsonString(Line, Error.Message);
+	Line.Append(TEXT(",\"ctx\":"));
+	AppendJsonString(Line, Error.Context);
+	Line.Append(TEXT(",\"time\":"));
+	AppendJsonString(Line, Error.Timestamp.ToIso8601());
+	Line.AppendChar(TEXT('}'));
+	AppendLine(Line.ToView());
+}
+
+void FLifeDomainErrorExporter::OnRepeat(uint64 Signature)
+{
+	if (bEnabled) {
+		++PendingDeltas.FindOrAdd(Signature, 0);
+	}
+}
+
+void FLifeDomainErrorExporter::Tick()
+{
+	if (bEnabled && (Buffer.Num() >= LifeExportFlushBytes || FPlatformTime::Seconds() - LastFlushSeconds >= 1.0)) {
+		Flush(false);
+	}
+}
+
+void FLifeDomainErrorExporter::Flush(bool bWait)
+{
+	if (!bEnabled) {
+		return;
+	}
+	check(IsInGameThread());
+
+	EmitCountDeltas();
+	LastFlushSeconds = FPlatformTime::Seconds();
+
+	if (Buffer.Num() > 0) {
+		GLifeExportPipe.Launch(TEXT("FloodlightExportWrite"), [Data = MoveTemp(Buffer)]() {
+			GLifeExportFile->Serialize(const_cast<uint8*>(Data.GetData()), Data.Num());
+			GLifeExportFile->Flush();
+		});
+		Buffer.Reset();
+	}
+
+	if (bWait) {
+		GLifeExportPipe.WaitUntilEmpty();
+	}
+}
+
+void FLifeDomainErrorExporter::AppendLine(FStringView Line)
+{
+	const FTCHARToUTF8 Utf8(Line.GetData(), Line.Len());
+	Buffer.Append(reinterpret_cast<const uint8*>(Utf8.Get()), Utf8.Length());
+	Buffer.Add('\n');
+}
+
+void FLifeDomainErrorExporter::EmitCountDeltas()
+{
+	TStringBuilder<128> Line;
+	for (const TPair<uint64, int32>& Delta : PendingDeltas) {
+		Line.Reset();
+		Line.Appendf(TEXT("{\"t\":\"count\",\"sig\":\"%016llx\",\"delta\":%d}"), Delta.Key, Delta.Value);
+		AppendLine(Line.ToView());
+	}
+	PendingDeltas.Reset();
+}
+
+/**
+ * Finds "Key": in a line written by FLifeDomainErrorExporter and returns its raw value, without the quotes for strings
+ * and still escaped. Keys can't match inside string values, their quotes would be escaped.
+ */
+static bool FindExportField(FStringView Line, FStringView Key, FStringView& OutValue)
+{
+	TStringBuilder<32> Pattern;
+	Pattern << TEXT('"') << Key << TEXT("\":");
+	const int32 KeyStart = UE::String::FindFirst(Line, Pattern.ToView(), ESearchCase::CaseSensitive);
+	if (KeyStart == INDEX_NONE) {
+		return false;
+	}
+
+	int32 Start = KeyStart + Pattern.Len();
+	if (Start < Line.Len() && Line[Start] == TEXT('"')) {
+		++Start;
+		for (int32 Index = Start; Index < Line.Len(); ++Index) {
+			if (Line[Index] == TEXT('\\')) {
+				++Index;
+			} else if (Line[Index] == TEXT('"')) {
+				OutValue = Line.Mid(Start, Index - Start);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	int32 End = Start;
+	while (End < Line.Len() && Line[End] != TEXT(',') && Line[End] != TEXT('}')) {
+		++End;
+	}
+	OutValue = Line.Mid(Start, End - Start);
+	return true;
+}
+
+/** Keeps the text of the first "new" line seen for a signature, and the earliest first-seen time. */
+static void MergeSignatureText(FLifeMergedErrorSignature& Into, const FLifeMergedErrorSignature& From)
+{
+	if (Into.Message.IsEmpty() && Into.Context.IsEmpty()) {
+		Into.Severity = From.Severity;
+		Into.Message = From.Message;
+		Into.Context = From.Context;
+	}
+	if (!From.FirstSeen.IsEmpty() && (Into.FirstSeen.IsEmpty() || From.FirstSeen < Into.FirstSeen)) {
+		Into.FirstSeen = From.FirstSeen;
+	}
+}
+
+bool FLifeDomainErrorExportMerger::ParseFile(const FString& File, FLifeMergedErrorSignatures& OutSignatures)
+{
+	FString Text;
+	if (!FFileHelper::LoadFileToString(Text, *File)) {
+		return false;
+	}
+
+	UE::String::ParseLines(Text, [&OutSignatures](FStringView Line) {
+		// Run lines have no signature
+		FStringView Type, Sig;
+		if (!FindExportField(Line, TEXT("t"), Type) || !FindExportField(Line, TEXT("sig"), Sig)) {
+			return;
+		}
+
+		FLifeMergedErrorSignature& Merged = OutSignatures.FindOrAdd(FParse::HexNumber64(Sig.GetData()));
+		Merged.NumFiles = 1;
+		if (Type.Equals(TEXT("new"))) {
+			++Merged.Count;
+
+			FLifeMergedErrorSignature Parsed;
+			FStringView Value;
+			Parsed.Severity = FindExportField(Line, TEXT("sev"), Value) ? FString(Value) : FString();
+			Parsed.Message = FindExportField(Line, TEXT("msg"), Value) ? FString(Value) : FString();
+			Parsed.Context = FindExportField(Line, TEXT("ctx"), Value) ? FString(Value) : FString();
+			Parsed.FirstSeen = FindExportField(Line, TEXT("time"), Value) ? FString(Value) : FString();
+			MergeSignatureText(Merged, Parsed);
+		} else if (Type.Equals(TEXT("count"))) {
+			FStringView Delta;
+			if (FindExportField(Line, TEXT("delta"), Delta)) {
+				Merged.Count += FCString::Atoi64(*FString(Delta));
+			}
+		}
+	});
+	return true;
+}
+
+void FLifeDomainErrorExportMerger::Merge(FLifeMergedErrorSignatures& Total, const FLifeMergedErrorSignatures& File)
+{
+	for (const TPair<uint64, FLifeMergedErrorSignature>& Pair : File) {
+		FLifeMergedErrorSignature& Merged = Total.FindOrAdd(Pair.Key);
+		Merged.Count += Pair.Value.Count;
+		Merged.NumFiles += Pair.Value.NumFiles;
+		MergeSignatureText(Merged, Pair.Value);
+	}
+}
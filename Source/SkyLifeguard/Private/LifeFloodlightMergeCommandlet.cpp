@@ -0,0 +1,83 @@
+﻿#include "LifeFloodlightMergeCommandlet.h"
+
+#include "Async/ParallelFor.h"
+#include "HAL/FileManager.h"
+#include "LifeFloodlightExport.h"
+#include "LifeLogChannels.h"
+#include "Misc/FileHelper.h"
+
+ULifeFloodlightMergeCommandlet::ULifeFloodlightMergeCommandlet()
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+
+	HelpDescription = TEXT("Merges Floodlight export files into one, one line per error signature.");
+	HelpUsage = TEXT("-run=LifeFloodlightMerge -Input=<dir>[;<dir>...] -Output=<file>");
+}
+
+int32 ULifeFloodlightMergeCommandlet::Main(const FString& Params)
+{
+	FString Inputs;
+	FString Output;
+	if (!FParse::Value(*Params, TEXT("Input="), Inputs, false) || !FParse::Value(*Params, TEXT("Output="), Output)) {
+		UE_LOG(LogLife, Error, TEXT("Usage: %s"), *HelpUsage);
+		return 1;
+	}
+
+	TArray<FString> InputDirs;
+	Inputs.ParseIntoArray(InputDirs, TEXT(";"));
+	TArray<FString> Files;
+	for (const FString& Dir : InputDirs) {
+		TArray<FString> DirFiles;
+		IFileManager::Get().FindFilesRecursive(DirFiles, *Dir, TEXT("*.ndjson"), true, false, false);
+		Files.Append(DirFiles);
+	}
+
+	// Files are parsed in parallel into their own maps, merging them is cheap next to the parsing
+	TArray<FLifeMergedErrorSignatures> PerFile;
+	PerFile.SetNum(Files.Num());
+	TArray<bool> Parsed;
+	Parsed.SetNumZeroed(Files.Num());
+	ParallelFor(Files.Num(), [&](int32 Index) {
+		Parsed[Index] = FLifeDomainErrorExportMerger::ParseFile(Files[Index], PerFile[Index]);
+	});
+
+	FLifeMergedErrorSignatures Merged;
+	int32 NumParsed = 0;
+	for (int32 Index = 0; Index < Files.Num(); ++Index) {
+		if (!Parsed[Index]) {
+			UE_LOG(LogLife, Warning, TEXT("Can't read %s"), *Files[Index]);
+			continue;
+		}
+		++NumParsed;
+		FLifeDomainErrorExportMerger::Merge(Merged, PerFile[Index]);
+	}
+
+	// Most frequent first
+	TArray<TPair<uint64, const FLifeMergedErrorSignature*>> Sorted;
+	Sorted.Reserve(Merged.Num());
+	for (const TPair<uint64, FLifeMergedErrorSignature>& Pair : Merged) {
+		Sorted.Emplace(Pair.Key, &Pair.Value);
+	}
+	Sorted.Sort([](const TPair<uint64, const FLifeMergedErrorSignature*>& A, const TPair<uint64, const FLifeMergedErrorSignature*>& B) {
+		return A.Value->Count > B.Value->Count;
+	});
+
+	// Text fields are still escaped, so they're written back verbatim
+	FString Result = FString::Printf(TEXT("{\"t\":\"merge\",\"files\":%d,\"signatures\":%d}\n"), NumParsed, Sorted.Num());
+	for (const TPair<uint64, const FLifeMergedErrorSignature*>& Pair : Sorted) {
+		const FLifeMergedErrorSignature& Signature = *Pair.Value;
+		Result += FString::Printf(TEXT("{\"t\":\"sig\",\"sig\":\"%016llx\",\"sev\":\"%s\",\"msg\":\"%s\",\"ctx\":\"%s\",\"first\":\"%s\",\"count\":%lld,\"files\":%d}\n"),
+			Pair.Key, *Signature.Severity, *Signature.Message, *Signature.Context, *Signature.FirstSeen, Signature.Count, Signature.NumFiles);
+	}
+
+	if (!FFileHelper::SaveStringToFile(Result, *Output, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM)) {
+		UE_LOG(LogLife, Error, TEXT("Can't write %s"), *Output);
+		return 1;
+	}
+
+	UE_LOG(LogLife, Display, TEXT("Merged %d Floodlight export files into %s, %d signatures"), NumParsed, *Output, Sorted.Num());
+	return 0;
+}
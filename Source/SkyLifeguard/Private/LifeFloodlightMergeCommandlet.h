@@ -0,0 +1,22 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "LifeFloodlightMergeCommandlet.generated.h"
+
+/**
+ * Merges Floodlight export files (see LifeFloodlightExport.h) from many runs into one, one line per signature with its
+ * total count and the number of files it showed up in, most frequent first.
+ *
+ * Usage: -run=LifeFloodlightMerge -Input=<dir>[;<dir>...] -Output=<file>
+ */
+UCLASS()
+class ULifeFloodlightMergeCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	ULifeFloodlightMergeCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,109 @@
+﻿#include "LifeInvariantDeferred.h"
+
+#include "HAL/IConsoleManager.h"
+#include "LifeStats.h"
+#include "Misc/ScopeExit.h"
+
+static bool GLifeInvariantsDeferred = true;
+static FAutoConsoleVariableRef CVarLifeInvariantsDeferred(
+	TEXT("Lifeguard.Invariants.Deferred"),
+	GLifeInvariantsDeferred,
+	TEXT("If true, LG_CLASS_INVARIANTS_DEFERRED queues its checks and runs them over the next frames. If false, it checks immediately like LG_CLASS_INVARIANTS."));
+
+static float GLifeInvariantsDeferredBudgetMs = 1.0f;
+static FAutoConsoleVariableRef CVarLifeInvariantsDeferredBudgetMs(
+	TEXT("Lifeguard.Invariants.Deferred.BudgetMs"),
+	GLifeInvariantsDeferredBudgetMs,
+	TEXT("Time the queued LG_CLASS_INVARIANTS_DEFERRED checks may take per frame, in milliseconds. At least one check runs every frame."));
+
+namespace Debug
+{
+	// Static member initialization
+	TArray<FLifeDeferredInvariants::FPendingCheck> FLifeDeferredInvariants::Queue;
+	int32 FLifeDeferredInvariants::Head = 0;
+	const FLifeInvariantCallSite* FLifeDeferredInvariants::CurrentCallSite = nullptr;
+	FTSTicker::FDelegateHandle FLifeDeferredInvariants::TickerHandle;
+
+	void DeferClassInvariants(const UObject* Object, const FLifeInvariantCallSite& Site)
+	{
+		LG_PRECOND(Object);
+
+		if (GLifeInvariantsDeferred && IsInGameThread()) {
+			FLifeDeferredInvariants::Enqueue(Object, Site);
+		} else {
+			CheckClassInvariants(Object);
+		}
+	}
+
+	void FLifeDeferredInvariants::Initialize()
+	{
+		TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateStatic(&FLifeDeferredInvariants::Tick));
+	}
+
+	void FLifeDeferredInvariants::Shutdown()
+	{
+		FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+		TickerHandle.Reset();
+		Queue.Empty();
+		Head = 0;
+	}
+
+	void FLifeDeferredInvariants::Enqueue(const UObject* Object, const FLifeInvariantCallSite& Site)
+	{
+		check(IsInGameThread());
+		Queue.Add({ Object, Site });
+		INC_DWORD_STAT(STAT_LifeDeferredPending);
+	}
+
+	void FLifeDeferredInvariants::Flush()
+	{
+		while (GetNumPending() > 0) {
+			Drain(TNumericLimits<double>::Max());
+		}
+	}
+
+	int32 FLifeDeferredInvariants::Drain(double BudgetSeconds)
+	{
+		check(IsInGameThread());
+		LG_SCOPE_CYCLE_COUNTER(STAT_LifeDeferredInvariants);
+
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+		const double BudgetCycles = BudgetSeconds / FPlatformTime::GetSecondsPerCycle64();
+
+		int32 NumProcessed = 0;
+		while (Head < Queue.Num()) {
+			// Copied, the check may queue more and move the array
+			const FPendingCheck Check = Queue[Head++];
+			++NumProcessed;
+			DEC_DWORD_STAT(STAT_LifeDeferredPending);
+
+			if (const UObject* Object = Check.Object.Get()) {
+				const FLifeInvariantCallSite* const PreviousCallSite = CurrentCallSite;
+				CurrentCallSite = &Check.Site;
+				ON_SCOPE_EXIT { CurrentCallSite = PreviousCallSite; };
+				CheckClassInvariants(Object);
+			}
+
+			if (static_cast<double>(FPlatformTime::Cycles64() - StartCycles) >= BudgetCycles) {
+				break;
+			}
+		}
+
+		if (Head == Queue.Num()) {
+			Queue.Reset();
+			Head = 0;
+		} else if (Head > Queue.Num() / 2) {
+			Queue.RemoveAt(0, Head);
+			Head = 0;
+		}
+		return NumProcessed;
+	}
+
+	bool FLifeDeferredInvariants::Tick(float DeltaTime)
+	{
+		if (GetNumPending() > 0) {
+			Drain(FMath::Max(GLifeInvariantsDeferredBudgetMs, 0.0f) / 1000.0);
+		}
+		return true;
+	}
+}
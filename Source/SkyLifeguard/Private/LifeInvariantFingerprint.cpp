@@ -0,0 +1,116 @@
+﻿#include "LifeInvariantFingerprint.h"
+
+#include "Hash/CityHash.h"
+#include "HAL/IConsoleManager.h"
+#include "LifeInvariantPlan.h"
+#include "LifeLogChannels.h"
+#include "UObject/UObjectGlobals.h"
+
+static bool GLifeInvariantIncremental = false;
+static FAutoConsoleVariableRef CVarLifeInvariantIncremental(
+	TEXT("Lifeguard.Invariants.Incremental"),
+	GLifeInvariantIncremental,
+	TEXT("If true, invariants whose inputs are the object's own bytes are skipped while those bytes are unchanged since the object last passed. Fingerprints are reset on GC."),
+	FConsoleVariableDelegate::CreateLambda([](IConsoleVariable*) {
+		// Turning the mode off and on again must not trust fingerprints from before
+		Debug::FLifeInvariantFingerprints::Invalidate();
+	}));
+
+namespace Debug
+{
+	// Static member initialization
+	TMap<const UObject*, uint64> FLifeInvariantFingerprints::Fingerprints;
+	FLifeInvariantFingerprintStats FLifeInvariantFingerprints::Stats;
+	FDelegateHandle FLifeInvariantFingerprints::PostGarbageCollectHandle;
+	FDelegateHandle FLifeInvariantFingerprints::ReloadCompleteHandle;
+	FDelegateHandle FLifeInvariantFingerprints::ObjectsReinstancedHandle;
+
+	void FLifeInvariantFingerprints::Initialize()
+	{
+		// Collected objects free their address for new ones, and pointed-to objects may have died
+		PostGarbageCollectHandle = FCoreUObjectDelegates::GetPostGarbageCollect().AddLambda([]() {
+			Invalidate();
+		});
+
+		// Same triggers as the plan cache: layouts (and so the hashed bytes) may have changed
+		ReloadCompleteHandle = FCoreUObjectDelegates::ReloadCompleteDelegate.AddLambda([](EReloadCompleteReason) {
+			Invalidate();
+		});
+#if WITH_EDITOR
+		ObjectsReinstancedHandle = FCoreUObjectDelegates::OnObjectsReinstanced.AddLambda([](const TMap<UObject*, UObject*>&) {
+			Invalidate();
+		});
+#endif
+	}
+
+	void FLifeInvariantFingerprints::Shutdown()
+	{
+		FCoreUObjectDelegates::GetPostGarbageCollect().Remove(PostGarbageCollectHandle);
+		FCoreUObjectDelegates::ReloadCompleteDelegate.Remove(ReloadCompleteHandle);
+#if WITH_EDITOR
+		FCoreUObjectDelegates::OnObjectsReinstanced.Remove(ObjectsReinstancedHandle);
+#endif
+		Fingerprints.Empty();
+	}
+
+	bool FLifeInvariantFingerprints::IsEnabled()
+	{
+		return GLifeInvariantIncremental && IsInGameThread();
+	}
+
+	uint64 FLifeInvariantFingerprints::Compute(const UObject* Object, const FLifeInvariantPlan& Plan)
+	{
+		const uint8* ObjectBase = reinterpret_cast<const uint8*>(Object);
+
+		// Ranges include TArray headers (data pointer, Num, Max), the elements are hashed on top
+		uint64 Hash = 0;
+		for (const FLifeInvariantFingerprintRange& Range : Plan.FingerprintRanges) {
+			Hash = CityHash64WithSeed(reinterpret_cast<const char*>(ObjectBase + Range.Offset), Range.Size, Hash);
+		}
+		for (const FLifeInvariantFingerprintArray& Array : Plan.FingerprintArrays) {
+			const FScriptArray* ScriptArray = reinterpret_cast<const FScriptArray*>(ObjectBase + Array.Offset);
+			const uint32 NumBytes = static_cast<uint32>(ScriptArray->Num()) * Array.ElementSize;
+			if (NumBytes > 0) {
+				Hash = CityHash64WithSeed(static_cast<const char*>(ScriptArray->GetData()), NumBytes, Hash);
+			}
+		}
+		return Hash;
+	}
+
+	bool FLifeInvariantFingerprints::IsUnchanged(const UObject* Object, uint64 Fingerprint)
+	{
+		const uint64* Stored = Fingerprints.Find(Object);
+		if (Stored && *Stored == Fingerprint) {
+			++Stats.NumUnchanged;
+			return true;
+		}
+		++Stats.NumChanged;
+		return false;
+	}
+
+	void FLifeInvariantFingerprints::Store(const UObject* Object, uint64 Fingerprint)
+	{
+		Fingerprints.Add(Object, Fingerprint);
+	}
+
+	void FLifeInvariantFingerprints::Invalidate(const UObject* Object)
+	{
+		if (Object) {
+			Fingerprints.Remove(Object);
+		} else {
+			Fingerprints.Reset();
+		}
+	}
+}
+
+static FAutoConsoleCommand GLifeCmd_IncrementalReset(
+	TEXT("Lifeguard.Invariants.Incremental.Reset"),
+	TEXT("Forgets every invariant fingerprint, so the next check of every object is a full one"),
+	FConsoleCommandDelegate::CreateLambda([]()
+	{
+		const Debug::FLifeInvariantFingerprintStats Stats = Debug::FLifeInvariantFingerprints::GetStats();
+		UE_LOG(LogLife, Log, TEXT("Dropping %d invariant fingerprints (%llu unchanged, %llu changed checks so far)"),
+			Debug::FLifeInvariantFingerprints::GetNum(), Stats.NumUnchanged, Stats.NumChanged);
+		Debug::FLifeInvariantFingerprints::Invalidate();
+	})
+);
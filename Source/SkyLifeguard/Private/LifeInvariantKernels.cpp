@@ -0,0 +1,506 @@
+﻿#include "LifeInvariantKernels.h"
+
+#include "HAL/IConsoleManager.h"
+
+static bool GLifeInvariantsStrictMemSafe = false;
+static FAutoConsoleVariableRef CVarLifeInvariantsStrictMemSafe(
+	TEXT("Lifeguard.Invariants.StrictMemSafe"),
+	GLifeInvariantsStrictMemSafe,
+	TEXT("If true, Invariant=MemSafe and MemSafeContainer test hard object pointers for the Garbage and Unreachable flags (and that their GUObjectArray item holds them) instead of just null. The objects must still be allocated, pointers to collected objects aren't detected."),
+	FConsoleVariableDelegate::CreateLambda([](IConsoleVariable*) {
+		// Kernels are picked when plans are built
+		Debug::FLifeInvariantPlanCache::Invalidate();
+	}));
+
+namespace Debug
+{
+	bool IsStrictMemSafeEnabled()
+	{
+		return GLifeInvariantsStrictMemSafe;
+	}
+
+	void PrefetchObjectItems(const FLifeInvariantPlan& Plan, const uint8* ObjectBase)
+	{
+		for (const int32 Offset : Plan.StrictPointerOffsets) {
+			if (const UObject* Target = reinterpret_cast<const FObjectPtr*>(ObjectBase + Offset)->Get()) {
+				FPlatformMisc::Prefetch(Target);
+			}
+		}
+		for (const int32 Offset : Plan.StrictPointerOffsets) {
+			const UObject* Target = reinterpret_cast<const FObjectPtr*>(ObjectBase + Offset)->Get();
+			const int32 Index = Target ? GUObjectArray.ObjectToIndex(Target) : INDEX_NONE;
+			if (Index >= 0 && Index < GUObjectArray.GetObjectArrayNum()) {
+				FPlatformMisc::Prefetch(GUObjectArray.IndexToObject(Index));
+			}
+		}
+	}
+
+	/** Where a numeric kernel finds its values: the property itself, or the elements/values of a container. */
+	enum class ENumericShape : uint8
+	{
+		Value,
+		Array,
+		Set,
+		MapValue,
+	};
+
+	/** Lowest and highest element of a contiguous run, and whether any element is NaN. */
+	template<typename T>
+	struct TMinMax
+	{
+		T Min;
+		T Max;
+		bool bHasNaN = false;
+	};
+
+	// Min/max reductions, 4 lanes at a time. Num must be > 0.
+
+	static TMinMax<int32> ReduceMinMax(const int32* Data, int32 Num)
+	{
+		TMinMax<int32> Result{ Data[0], Data[0] };
+		int32 i = 0;
+		if (Num >= 4) {
+			VectorRegister4Int Min = VectorIntLoad(Data);
+			VectorRegister4Int Max = Min;
+			for (i = 4; i + 4 <= Num; i += 4) {
+				const VectorRegister4Int Values = VectorIntLoad(Data + i);
+				Min = VectorIntMin(Min, Values);
+				Max = VectorIntMax(Max, Values);
+			}
+			alignas(16) int32 MinLanes[4];
+			alignas(16) int32 MaxLanes[4];
+			VectorIntStoreAligned(Min, MinLanes);
+			VectorIntStoreAligned(Max, MaxLanes);
+			for (int32 Lane = 0; Lane < 4; ++Lane) {
+				Result.Min = FMath::Min(Result.Min, MinLanes[Lane]);
+				Result.Max = FMath::Max(Result.Max, MaxLanes[Lane]);
+			}
+		}
+		for (; i < Num; ++i) {
+			Result.Min = FMath::Min(Result.Min, Data[i]);
+			Result.Max = FMath::Max(Result.Max, Data[i]);
+		}
+		return Result;
+	}
+
+	/** Shared by float and double, the vector min/max don't propagate NaN so it's detected on the side. */
+	template<typename T, typename TRegister>
+	static TMinMax<T> ReduceMinMaxFloating(const T* Data, int32 Num)
+	{
+		TMinMax<T> Result{ Data[0], Data[0] };
+		int32 i = 0;
+		if (Num >= 4) {
+			TRegister Min = VectorLoad(Data);
+			TRegister Max = Min;
+			TRegister NaN = VectorCompareNE(Min, Min);
+			for (i = 4; i + 4 <= Num; i += 4) {
+				const TRegister Values = VectorLoad(Data + i);
+				Min = VectorMin(Min, Values);
+				Max = VectorMax(Max, Values);
+				NaN = VectorBitwiseOr(NaN, VectorCompareNE(Values, Values));
+			}
+			Result.bHasNaN = VectorMaskBits(NaN) != 0;
+			alignas(32) T MinLanes[4];
+			alignas(32) T MaxLanes[4];
+			VectorStoreAligned(Min, MinLanes);
+			VectorStoreAligned(Max, MaxLanes);
+			for (int32 Lane = 0; Lane < 4; ++Lane) {
+				Result.Min = FMath::Min(Result.Min, MinLanes[Lane]);
+				Result.Max = FMath::Max(Result.Max, MaxLanes[Lane]);
+			}
+		}
+		for (; i < Num; ++i) {
+			Result.bHasNaN |= FMath::IsNaN(Data[i]);
+			Result.Min = FMath::Min(Result.Min, Data[i]);
+			Result.Max = FMath::Max(Result.Max, Data[i]);
+		}
+		return Result;
+	}
+
+	static TMinMax<float> ReduceMinMax(const float* Data, int32 Num)
+	{
+		return ReduceMinMaxFloating<float, VectorRegister4Float>(Data, Num);
+	}
+
+	static TMinMax<double> ReduceMinMax(const double* Data, int32 Num)
+	{
+		return ReduceMinMaxFloating<double, VectorRegister4Double>(Data, Num);
+	}
+
+	template<typename T>
+	static constexpr bool bHasMinMaxReduction = std::is_same_v<T, int32> || std::is_same_v<T, float> || std::is_same_v<T, double>;
+
+	/**
+	 * Element-wise rule on a TArray. The elements are contiguous, so they're read as a plain T array. Int32, float and
+	 * double arrays are reduced to their min and max first, and only scanned one by one when those don't pass.
+	 */
+	template<typename TRule, typename T>
+	static bool TestNumericArray(const FLifeInvariantEntry& Entry, const void* Value)
+	{
+		FScriptArrayHelper ArrayHelper(static_cast<const FArrayProperty*>(Entry.Property), Value);
+		const int32 Num = ArrayHelper.Num();
+		if (Num == 0) {
+			return true;
+		}
+		const T* Data = reinterpret_cast<const T*>(ArrayHelper.GetRawPtr(0));
+
+		if constexpr (bHasMinMaxReduction<T>) {
+			const TMinMax<T> MinMax = ReduceMinMax(Data, Num);
+			if (LIKELY(!MinMax.bHasNaN && TRule::TestExtremes(Entry, MinMax.Min, MinMax.Max))) {
+				return true;
+			}
+		}
+
+		for (int32 i = 0; i < Num; ++i) {
+			if (!TRule::Test(Entry, Data[i])) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	template<typename TRule, typename T>
+	static bool TestNumericSet(const FLifeInvariantEntry& Entry, const void* Value)
+	{
+		FScriptSetHelper SetHelper(static_cast<const FSetProperty*>(Entry.Property), Value);
+		for (int32 i = 0; i < SetHelper.GetMaxIndex(); ++i) {
+			if (SetHelper.IsValidIndex(i) && !TRule::Test(Entry, *reinterpret_cast<const T*>(SetHelper.GetElementPtr(i)))) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	template<typename TRule, typename T>
+	static bool TestNumericMapValues(const FLifeInvariantEntry& Entry, const void* Value)
+	{
+		FScriptMapHelper MapHelper(static_cast<const FMapProperty*>(Entry.Property), Value);
+		for (int32 i = 0; i < MapHelper.GetMaxIndex(); ++i) {
+			if (MapHelper.IsValidIndex(i) && !TRule::Test(Entry, *reinterpret_cast<const T*>(MapHelper.GetValuePtr(i)))) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	template<ENumericShape Shape, typename TRule, typename T>
+	static bool NumericKernel(const FLifeInvariantEntry& Entry, const void* Value)
+	{
+		if constexpr (Shape == ENumericShape::Array) {
+			return TestNumericArray<TRule, T>(Entry, Value);
+		} else if constexpr (Shape == ENumericShape::Set) {
+			return TestNumericSet<TRule, T>(Entry, Value);
+		} else if constexpr (Shape == ENumericShape::MapValue) {
+			return TestNumericMapValues<TRule, T>(Entry, Value);
+		} else {
+			return TRule::Test(Entry, *static_cast<const T*>(Value));
+		}
+	}
+
+	static bool NameKernel(const FLifeInvariantEntry&, const void* Value)
+	{
+		return !static_cast<const FName*>(Value)->IsNone();
+	}
+
+	// Bools can be bitfields, so they're read through the property (no cast, the kind is already known)
+	static bool TrueKernel(const FLifeInvariantEntry& Entry, const void* Value)
+	{
+		return static_cast<const FBoolProperty*>(Entry.Property)->GetPropertyValue(Value);
+	}
+
+	static bool FalseKernel(const FLifeInvariantEntry& Entry, const void* Value)
+	{
+		return !static_cast<const FBoolProperty*>(Entry.Property)->GetPropertyValue(Value);
+	}
+
+	template<typename TPtr>
+	static bool MemSafeKernel(const FLifeInvariantEntry&, const void* Value)
+	{
+		if constexpr (std::is_same_v<TPtr, FObjectPtr>) {
+			return !static_cast<const FObjectPtr*>(Value)->IsNull();
+		} else if constexpr (std::is_same_v<TPtr, FScriptInterface>) {
+			return static_cast<const FScriptInterface*>(Value)->GetObject() != nullptr;
+		} else {
+			return *static_cast<const TPtr*>(Value) != nullptr;
+		}
+	}
+
+	static bool StrictMemSafeObjectKernel(const FLifeInvariantEntry&, const void* Value)
+	{
+		return IsObjectAlive(static_cast<const FObjectPtr*>(Value)->Get());
+	}
+
+	static bool StrictMemSafeInterfaceKernel(const FLifeInvariantEntry&, const void* Value)
+	{
+		return IsObjectAlive(static_cast<const FScriptInterface*>(Value)->GetObject());
+	}
+
+	template<bool bStrict>
+	static bool MemSafeArrayKernel(const FLifeInvariantEntry& Entry, const void* Value)
+	{
+		FScriptArrayHelper ArrayHelper(static_cast<const FArrayProperty*>(Entry.Property), Value);
+		for (int32 i = 0; i < ArrayHelper.Num(); ++i) {
+			if (!IsPointerElementValid<bStrict>(Entry.ElementKind, ArrayHelper.GetRawPtr(i))) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// Sets and maps are sparse, so walk up to the max index and skip the holes
+	template<bool bStrict>
+	static bool MemSafeSetKernel(const FLifeInvariantEntry& Entry, const void* Value)
+	{
+		FScriptSetHelper SetHelper(static_cast<const FSetProperty*>(Entry.Property), Value);
+		for (int32 i = 0; i < SetHelper.GetMaxIndex(); ++i) {
+			if (SetHelper.IsValidIndex(i) && !IsPointerElementValid<bStrict>(Entry.ElementKind, SetHelper.GetElementPtr(i))) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	template<bool bStrict>
+	static bool MemSafeMapKernel(const FLifeInvariantEntry& Entry, const void* Value)
+	{
+		FScriptMapHelper MapHelper(static_cast<const FMapProperty*>(Entry.Property), Value);
+		for (int32 i = 0; i < MapHelper.GetMaxIndex(); ++i) {
+			if (!MapHelper.IsValidIndex(i)) {
+				continue;
+			}
+			if (!IsPointerElementValid<bStrict>(Entry.ElementKind, MapHelper.GetKeyPtr(i)) ||
+				!IsPointerElementValid<bStrict>(Entry.MapValueKind, MapHelper.GetValuePtr(i))) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	template<bool bStrict>
+	static bool MemSafeOptionalKernel(const FLifeInvariantEntry& Entry, const void* Value)
+	{
+		const FOptionalProperty* OptProp = static_cast<const FOptionalProperty*>(Entry.Property);
+
+		// Unset optional is memory safe since it's not set to anything
+		if (!OptProp->IsSet(Value)) {
+			return true;
+		}
+		return IsPointerElementValid<bStrict>(Entry.ElementKind, OptProp->GetValuePointerForRead(Value));
+	}
+
+	static bool IsPointerLikeKind(ELifeInvariantKind Kind)
+	{
+		return Kind >= ELifeInvariantKind::Object && Kind <= ELifeInvariantKind::Interface;
+	}
+
+	static bool AlwaysValidKernel(const FLifeInvariantEntry&, const void*)
+	{
+		return true;
+	}
+
+	template<typename TRule, ENumericShape Shape = ENumericShape::Value>
+	static FLifeInvariantKernel FindNumericKernel(ELifeInvariantKind Kind)
+	{
+		switch (Kind)
+		{
+		case ELifeInvariantKind::Int8:   return &NumericKernel<Shape, TRule, int8>;
+		case ELifeInvariantKind::Int16:  return &NumericKernel<Shape, TRule, int16>;
+		case ELifeInvariantKind::Int32:  return &NumericKernel<Shape, TRule, int32>;
+		case ELifeInvariantKind::Int64:  return &NumericKernel<Shape, TRule, int64>;
+		case ELifeInvariantKind::UInt8:  return &NumericKernel<Shape, TRule, uint8>;
+		case ELifeInvariantKind::UInt16: return &NumericKernel<Shape, TRule, uint16>;
+		case ELifeInvariantKind::UInt32: return &NumericKernel<Shape, TRule, uint32>;
+		case ELifeInvariantKind::UInt64: return &NumericKernel<Shape, TRule, uint64>;
+		case ELifeInvariantKind::Float:  return TRule::bIntegerOnly ? nullptr : &NumericKernel<Shape, TRule, float>;
+		case ELifeInvariantKind::Double: return TRule::bIntegerOnly ? nullptr : &NumericKernel<Shape, TRule, double>;
+		default:                         return nullptr;
+		}
+	}
+
+	/** Numeric rules apply to the property itself, or element-wise to TArray/TSet elements and TMap values. */
+	template<typename TRule>
+	static FLifeInvariantKernel FindNumericRuleKernel(const FLifeInvariantEntry& Entry)
+	{
+		const ELifeInvariantKind ValueKind = Entry.GetRuleValueKind();
+		switch (Entry.Kind)
+		{
+		case ELifeInvariantKind::Array: return FindNumericKernel<TRule, ENumericShape::Array>(ValueKind);
+		case ELifeInvariantKind::Set:   return FindNumericKernel<TRule, ENumericShape::Set>(ValueKind);
+		case ELifeInvariantKind::Map:   return FindNumericKernel<TRule, ENumericShape::MapValue>(ValueKind);
+		default:                        return FindNumericKernel<TRule>(ValueKind);
+		}
+	}
+
+	static FLifeInvariantKernel FindMemSafeKernel(ELifeInvariantKind Kind)
+	{
+		const bool bStrict = IsStrictMemSafeEnabled();
+		switch (Kind)
+		{
+		case ELifeInvariantKind::Object:
+		case ELifeInvariantKind::Class:      return bStrict ? &StrictMemSafeObjectKernel : &MemSafeKernel<FObjectPtr>;
+		case ELifeInvariantKind::SoftObject:
+		case ELifeInvariantKind::SoftClass:  return &MemSafeKernel<FSoftObjectPtr>;
+		case ELifeInvariantKind::WeakObject: return &MemSafeKernel<FWeakObjectPtr>;
+		case ELifeInvariantKind::Interface:  return bStrict ? &StrictMemSafeInterfaceKernel : &MemSafeKernel<FScriptInterface>;
+		default:                             return nullptr;
+		}
+	}
+
+	template<bool bStrict>
+	static FLifeInvariantKernel PickMemSafeContainerKernel(const FLifeInvariantEntry& Entry)
+	{
+		switch (Entry.Kind)
+		{
+		case ELifeInvariantKind::Array:    return &MemSafeArrayKernel<bStrict>;
+		case ELifeInvariantKind::Set:      return &MemSafeSetKernel<bStrict>;
+		case ELifeInvariantKind::Map:      return &MemSafeMapKernel<bStrict>;
+		case ELifeInvariantKind::Optional: return &MemSafeOptionalKernel<bStrict>;
+		default:                           return nullptr;
+		}
+	}
+
+	static FLifeInvariantKernel FindMemSafeContainerKernel(const FLifeInvariantEntry& Entry)
+	{
+		// If no element type is pointer-like, the container is valid whatever it holds
+		if (!IsPointerLikeKind(Entry.ElementKind) && !IsPointerLikeKind(Entry.MapValueKind)) {
+			return &AlwaysValidKernel;
+		}
+		return IsStrictMemSafeEnabled() ? PickMemSafeContainerKernel<true>(Entry) : PickMemSafeContainerKernel<false>(Entry);
+	}
+
+	/** Gathers 4 int32 lanes from their offsets. */
+	static FORCEINLINE VectorRegister4Int GatherInt4(const uint8* ObjectBase, const int32* Offsets)
+	{
+		return MakeVectorRegisterInt(
+			*reinterpret_cast<const int32*>(ObjectBase + Offsets[0]),
+			*reinterpret_cast<const int32*>(ObjectBase + Offsets[1]),
+			*reinterpret_cast<const int32*>(ObjectBase + Offsets[2]),
+			*reinterpret_cast<const int32*>(ObjectBase + Offsets[3]));
+	}
+
+	/** Gathers 4 float lanes from their offsets. */
+	static FORCEINLINE VectorRegister4Float GatherFloat4(const uint8* ObjectBase, const int32* Offsets)
+	{
+		return MakeVectorRegisterFloat(
+			*reinterpret_cast<const float*>(ObjectBase + Offsets[0]),
+			*reinterpret_cast<const float*>(ObjectBase + Offsets[1]),
+			*reinterpret_cast<const float*>(ObjectBase + Offsets[2]),
+			*reinterpret_cast<const float*>(ObjectBase + Offsets[3]));
+	}
+
+	/**
+	 * Int32 lanes: accumulates a failure mask; any set lane means a failure.
+	 */
+	static bool TestInt32Batch(const FLifeInvariantBatch& Batch, const uint8* ObjectBase)
+	{
+		const VectorRegister4Int Zero = VectorIntSet1(0);
+		const VectorRegister4Int Lower = VectorIntSet1(Batch.LowerInt);
+		const VectorRegister4Int Upper = VectorIntSet1(Batch.UpperInt);
+		VectorRegister4Int Failed = Zero;
+
+		const int32* Offsets = Batch.Offsets.GetData();
+		for (int32 i = 0; i < Batch.Offsets.Num(); i += 4) {
+			const VectorRegister4Int Values = GatherInt4(ObjectBase, Offsets + i);
+			switch (Batch.Op)
+			{
+			case ELifeInvariantOp::Gte0: Failed = VectorIntOr(Failed, VectorIntCompareLT(Values, Zero)); break;
+			case ELifeInvariantOp::Gt0:  Failed = VectorIntOr(Failed, VectorIntCompareLE(Values, Zero)); break;
+			case ELifeInvariantOp::Lte0: Failed = VectorIntOr(Failed, VectorIntCompareGT(Values, Zero)); break;
+			case ELifeInvariantOp::Lt0:  Failed = VectorIntOr(Failed, VectorIntCompareGE(Values, Zero)); break;
+			case ELifeInvariantOp::Range:
+			{
+				const VectorRegister4Int BelowLower = Batch.bLowerInclusive ? VectorIntCompareLT(Values, Lower) : VectorIntCompareLE(Values, Lower);
+				const VectorRegister4Int AboveUpper = Batch.bUpperInclusive ? VectorIntCompareGT(Values, Upper) : VectorIntCompareGE(Values, Upper);
+				Failed = VectorIntOr(Failed, VectorIntOr(BelowLower, AboveUpper));
+				break;
+			}
+			default:
+				checkNoEntry();
+				return false;
+			}
+		}
+
+		return VectorMaskBits(VectorCastIntToFloat(Failed)) == 0;
+	}
+
+	/**
+	 * Float lanes: accumulates a pass mask with ordered compares, so NaN fails exactly like the scalar comparison.
+	 */
+	static bool TestFloatBatch(const FLifeInvariantBatch& Batch, const uint8* ObjectBase)
+	{
+		const VectorRegister4Float Zero = VectorZeroFloat();
+		const VectorRegister4Float Lower = VectorSetFloat1(Batch.LowerFloat);
+		const VectorRegister4Float Upper = VectorSetFloat1(Batch.UpperFloat);
+		VectorRegister4Float Passed = VectorCastIntToFloat(VectorIntSet1(-1));
+
+		const int32* Offsets = Batch.Offsets.GetData();
+		for (int32 i = 0; i < Batch.Offsets.Num(); i += 4) {
+			const VectorRegister4Float Values = GatherFloat4(ObjectBase, Offsets + i);
+			switch (Batch.Op)
+			{
+			case ELifeInvariantOp::Gte0: Passed = VectorBitwiseAnd(Passed, VectorCompareGE(Values, Zero)); break;
+			case ELifeInvariantOp::Gt0:  Passed = VectorBitwiseAnd(Passed, VectorCompareGT(Values, Zero)); break;
+			case ELifeInvariantOp::Lte0: Passed = VectorBitwiseAnd(Passed, VectorCompareLE(Values, Zero)); break;
+			case ELifeInvariantOp::Lt0:  Passed = VectorBitwiseAnd(Passed, VectorCompareLT(Values, Zero)); break;
+			case ELifeInvariantOp::Range:
+			{
+				const VectorRegister4Float AboveLower = Batch.bLowerInclusive ? VectorCompareGE(Values, Lower) : VectorCompareGT(Values, Lower);
+				const VectorRegister4Float BelowUpper = Batch.bUpperInclusive ? VectorCompareLE(Values, Upper) : VectorCompareLT(Values, Upper);
+				Passed = VectorBitwiseAnd(Passed, VectorBitwiseAnd(AboveLower, BelowUpper));
+				break;
+			}
+			default:
+				checkNoEntry();
+				return false;
+			}
+		}
+
+		return VectorMaskBits(Passed) == 0xF;
+	}
+
+	bool TestInvariantBatch(const FLifeInvariantBatch& Batch, const uint8* ObjectBase)
+	{
+		return Batch.Kind == ELifeInvariantKind::Int32
+			? TestInt32Batch(Batch, ObjectBase)
+			: TestFloatBatch(Batch, ObjectBase);
+	}
+
+	FLifeInvariantKernel FindInvariantKernel(const FLifeInvariantEntry& Entry)
+	{
+		const ELifeInvariantKind Kind = Entry.Kind;
+		switch (Entry.Op)
+		{
+		case ELifeInvariantOp::MemSafe:          return FindMemSafeKernel(Kind);
+		case ELifeInvariantOp::MemSafeContainer: return FindMemSafeContainerKernel(Entry);
+		case ELifeInvariantOp::ID:               return FindNumericRuleKernel<InvariantRules::FID>(Entry);
+		case ELifeInvariantOp::Gte0:             return FindNumericRuleKernel<InvariantRules::FGte0>(Entry);
+		case ELifeInvariantOp::Gt0:              return FindNumericRuleKernel<InvariantRules::FGt0>(Entry);
+		case ELifeInvariantOp::Lte0:             return FindNumericRuleKernel<InvariantRules::FLte0>(Entry);
+		case ELifeInvariantOp::Lt0:              return FindNumericRuleKernel<InvariantRules::FLt0>(Entry);
+		case ELifeInvariantOp::Range:            return FindNumericRuleKernel<InvariantRules::FRange>(Entry);
+		case ELifeInvariantOp::Name:             return Kind == ELifeInvariantKind::Name ? &NameKernel : nullptr;
+		case ELifeInvariantOp::True:             return Kind == ELifeInvariantKind::Bool ? &TrueKernel : nullptr;
+		case ELifeInvariantOp::False:            return Kind == ELifeInvariantKind::Bool ? &FalseKernel : nullptr;
+		default:                                 return nullptr;
+		}
+	}
+
+	FLifeInvariantKernel FindInvariantElementKernel(const FLifeInvariantEntry& Entry)
+	{
+		if (Entry.Kind != ELifeInvariantKind::Array && Entry.Kind != ELifeInvariantKind::Set && Entry.Kind != ELifeInvariantKind::Map) {
+			return nullptr;
+		}
+
+		const ELifeInvariantKind ValueKind = Entry.GetRuleValueKind();
+		switch (Entry.Op)
+		{
+		case ELifeInvariantOp::ID:    return FindNumericKernel<InvariantRules::FID>(ValueKind);
+		case ELifeInvariantOp::Gte0:  return FindNumericKernel<InvariantRules::FGte0>(ValueKind);
+		case ELifeInvariantOp::Gt0:   return FindNumericKernel<InvariantRules::FGt0>(ValueKind);
+		case ELifeInvariantOp::Lte0:  return FindNumericKernel<InvariantRules::FLte0>(ValueKind);
+		case ELifeInvariantOp::Lt0:   return FindNumericKernel<InvariantRules::FLt0>(ValueKind);
+		case ELifeInvariantOp::Range: return FindNumericKernel<InvariantRules::FRange>(ValueKind);
+		default:                      return nullptr;
+		}
+	}
+}
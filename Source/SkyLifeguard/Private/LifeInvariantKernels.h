@@ -0,0 +1,166 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "LifeInvariantPlan.h"
+#include "UObject/UObjectArray.h"
+
+/*
+ * Invariant kernels: one function per (rule, underlying type), e.g. Gte0<int32>, Range<double>, MemSafe<FObjectPtr>.
+ * The plan builder picks the kernel for each entry once, so a check is a single indirect call that reads the value
+ * straight from (uint8*)Object + Offset.
+ */
+
+namespace Debug
+{
+	namespace InvariantRules
+	{
+		// Numeric rules. Test() gets the entry so rules with parameters (Range) can read them.
+		// TestExtremes() is the container fast path: true if every value in [Min, Max] passes. It may be stricter than
+		// Test(), a false only sends the caller to the per-element scan.
+
+		struct FID
+		{
+			static constexpr bool bIntegerOnly = true;
+			template<typename T> static FORCEINLINE bool Test(const FLifeInvariantEntry&, T Value) { return Value != INDEX_NONE; }
+			template<typename T> static FORCEINLINE bool TestExtremes(const FLifeInvariantEntry&, T Min, T Max) { return Min > INDEX_NONE || Max < INDEX_NONE; }
+		};
+
+		struct FGte0
+		{
+			static constexpr bool bIntegerOnly = false;
+			template<typename T> static FORCEINLINE bool Test(const FLifeInvariantEntry&, T Value) { return Value >= 0; }
+			template<typename T> static FORCEINLINE bool TestExtremes(const FLifeInvariantEntry&, T Min, T) { return Min >= 0; }
+		};
+
+		struct FGt0
+		{
+			static constexpr bool bIntegerOnly = false;
+			template<typename T> static FORCEINLINE bool Test(const FLifeInvariantEntry&, T Value) { return Value > 0; }
+			template<typename T> static FORCEINLINE bool TestExtremes(const FLifeInvariantEntry&, T Min, T) { return Min > 0; }
+		};
+
+		struct FLte0
+		{
+			static constexpr bool bIntegerOnly = false;
+			template<typename T> static FORCEINLINE bool Test(const FLifeInvariantEntry&, T Value) { return Value <= 0; }
+			template<typename T> static FORCEINLINE bool TestExtremes(const FLifeInvariantEntry&, T, T Max) { return Max <= 0; }
+		};
+
+		struct FLt0
+		{
+			static constexpr bool bIntegerOnly = false;
+			template<typename T> static FORCEINLINE bool Test(const FLifeInvariantEntry&, T Value) { return Value < 0; }
+			template<typename T> static FORCEINLINE bool TestExtremes(const FLifeInvariantEntry&, T, T Max) { return Max < 0; }
+		};
+
+		struct FRange
+		{
+			static constexpr bool bIntegerOnly = false;
+			template<typename T> static FORCEINLINE bool Test(const FLifeInvariantEntry& Entry, T Value)
+			{
+				// Integers never go through double
+				if constexpr (std::is_floating_point_v<T>) {
+					return Entry.Range.Floating.Contains(static_cast<double>(Value));
+				} else if constexpr (std::is_signed_v<T>) {
+					return Entry.Range.Signed.Contains(static_cast<int64>(Value));
+				} else {
+					return Entry.Range.Unsigned.Contains(static_cast<uint64>(Value));
+				}
+			}
+			template<typename T> static FORCEINLINE bool TestExtremes(const FLifeInvariantEntry& Entry, T Min, T Max)
+			{
+				// Floating point bounds without the epsilon, values within it of a bound take the per-element scan
+				if constexpr (std::is_floating_point_v<T>) {
+					const TLifeInvariantBounds<double>& Bounds = Entry.Range.Floating;
+					const double Lower = static_cast<double>(Min);
+					const double Upper = static_cast<double>(Max);
+					return (Bounds.bLowerInclusive ? Lower >= Bounds.Lower : Lower > Bounds.Lower)
+						&& (Bounds.bUpperInclusive ? Upper <= Bounds.Upper : Upper < Bounds.Upper);
+				} else {
+					return Test(Entry, Min) && Test(Entry, Max);
+				}
+			}
+		};
+	}
+
+	/**
+	 * True if Lifeguard.Invariants.StrictMemSafe is on. Plans are built with the strict kernels then, and rebuilt when
+	 * it changes.
+	 */
+	bool IsStrictMemSafeEnabled();
+
+	/**
+	 * Strict MemSafe test of a hard object pointer: the object's GUObjectArray item must hold it and must not be flagged
+	 * Garbage (PendingKill) or Unreachable. Catches pointers to objects that were destroyed or marked for collection but
+	 * not purged yet. It reads InternalIndex from the object, so the object must still be allocated: a pointer to a
+	 * collected object is a read of freed memory, and passes if a new object took the address. Use weak pointers
+	 * (index plus serial) for those.
+	 */
+	FORCEINLINE bool IsObjectAlive(const UObject* Object)
+	{
+		if (!Object || !GUObjectArray.IsValid(Object)) {
+			return false;
+		}
+		return !GUObjectArray.ObjectToObjectItem(Object)->HasAnyFlags(EInternalObjectFlags::Garbage | EInternalObjectFlags::Unreachable);
+	}
+
+	/**
+	 * Checks a single pointer-like element of a container.
+	 * @param bStrict Test hard pointers for liveness (IsObjectAlive) instead of just null.
+	 * @return true if valid (or not a pointer type), false if null/invalid pointer
+	 */
+	template<bool bStrict = false>
+	FORCEINLINE bool IsPointerElementValid(ELifeInvariantKind Kind, const void* Element)
+	{
+		switch (Kind)
+		{
+		case ELifeInvariantKind::Object:
+		case ELifeInvariantKind::Class:
+			if constexpr (bStrict) {
+				return IsObjectAlive(static_cast<const FObjectPtr*>(Element)->Get());
+			} else {
+				return !static_cast<const FObjectPtr*>(Element)->IsNull();
+			}
+		case ELifeInvariantKind::WeakObject:
+			return static_cast<const FWeakObjectPtr*>(Element)->IsValid();
+		case ELifeInvariantKind::SoftObject:
+		case ELifeInvariantKind::SoftClass:
+			return !static_cast<const FSoftObjectPtr*>(Element)->IsNull();
+		case ELifeInvariantKind::Interface:
+			if constexpr (bStrict) {
+				return IsObjectAlive(static_cast<const FScriptInterface*>(Element)->GetObject());
+			} else {
+				return static_cast<const FScriptInterface*>(Element)->GetObject() != nullptr;
+			}
+		default:
+			// Not a pointer type - considered valid
+			return true;
+		}
+	}
+
+	/**
+	 * Strict MemSafe: prefetches the objects behind the plan's hard pointers, then their GUObjectArray items, so the
+	 * lookups of the following checks overlap instead of missing the cache one after the other.
+	 */
+	void PrefetchObjectItems(const FLifeInvariantPlan& Plan, const uint8* ObjectBase);
+
+	/**
+	 * Tests every lane of a batch with vector compares.
+	 *
+	 * @return True if every batched value passes. False means at least one lane failed, and the caller must run the
+	 *		 scalar kernels of the batch entries to find (and confirm) the failing one.
+	 */
+	bool TestInvariantBatch(const FLifeInvariantBatch& Batch, const uint8* ObjectBase);
+
+	/**
+	 * Returns the kernel for the entry's rule applied to its property kind, or nullptr if there is none (Contract*,
+	 * custom functions, or a rule that doesn't apply to the kind).
+	 */
+	FLifeInvariantKernel FindInvariantKernel(const FLifeInvariantEntry& Entry);
+
+	/**
+	 * For numeric rules on containers: returns the kernel that tests a single element (TArray/TSet) or value (TMap),
+	 * used to find the failing one for the report. Null for everything else.
+	 */
+	FLifeInvariantKernel FindInvariantElementKernel(const FLifeInvariantEntry& Entry);
+}
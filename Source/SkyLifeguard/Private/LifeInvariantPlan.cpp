@@ -0,0 +1,785 @@
+﻿#include "LifeInvariantPlan.h"
+
+#include "LifeContracts.h"
+#include "LifeInvariantKernels.h"
+#include "LifeInvariantTable.h"
+#include "LifeLogChannels.h"
+#include "LifeStats.h"
+#include "UObject/UObjectGlobals.h"
+
+#include <cmath>
+
+namespace Debug
+{
+	// Static member initialization
+	TMap<const UClass*, TUniquePtr<FLifeInvariantPlan>> FLifeInvariantPlanCache::Plans;
+	FDelegateHandle FLifeInvariantPlanCache::ReloadCompleteHandle;
+	FDelegateHandle FLifeInvariantPlanCache::ObjectsReinstancedHandle;
+
+	/**
+	 * Decodes the storage type of a property. Derived property classes are tested before their bases
+	 * (FClassProperty is an FObjectProperty, FSoftClassProperty is an FSoftObjectProperty).
+	 */
+	static ELifeInvariantKind ClassifyProperty(const FProperty* Property)
+	{
+		if (CastField<FInt8Property>(Property))       { return ELifeInvariantKind::Int8; }
+		if (CastField<FInt16Property>(Property))      { return ELifeInvariantKind::Int16; }
+		if (CastField<FIntProperty>(Property))        { return ELifeInvariantKind::Int32; }
+		if (CastField<FInt64Property>(Property))      { return ELifeInvariantKind::Int64; }
+		if (CastField<FByteProperty>(Property))       { return ELifeInvariantKind::UInt8; }
+		if (CastField<FUInt16Property>(Property))     { return ELifeInvariantKind::UInt16; }
+		if (CastField<FUInt32Property>(Property))     { return ELifeInvariantKind::UInt32; }
+		if (CastField<FUInt64Property>(Property))     { return ELifeInvariantKind::UInt64; }
+		if (CastField<FFloatProperty>(Property))      { return ELifeInvariantKind::Float; }
+		if (CastField<FDoubleProperty>(Property))     { return ELifeInvariantKind::Double; }
+		if (CastField<FBoolProperty>(Property))       { return ELifeInvariantKind::Bool; }
+		if (CastField<FNameProperty>(Property))       { return ELifeInvariantKind::Name; }
+		if (CastField<FClassProperty>(Property))      { return ELifeInvariantKind::Class; }
+		if (CastField<FObjectProperty>(Property))     { return ELifeInvariantKind::Object; }
+		if (CastField<FSoftClassProperty>(Property))  { return ELifeInvariantKind::SoftClass; }
+		if (CastField<FSoftObjectProperty>(Property)) { return ELifeInvariantKind::SoftObject; }
+		if (CastField<FWeakObjectProperty>(Property)) { return ELifeInvariantKind::WeakObject; }
+		if (CastField<FInterfaceProperty>(Property))  { return ELifeInvariantKind::Interface; }
+		if (CastField<FArrayProperty>(Property))      { return ELifeInvariantKind::Array; }
+		if (CastField<FSetProperty>(Property))        { return ELifeInvariantKind::Set; }
+		if (CastField<FMapProperty>(Property))        { return ELifeInvariantKind::Map; }
+		if (CastField<FOptionalProperty>(Property))   { return ELifeInvariantKind::Optional; }
+		return ELifeInvariantKind::Unsupported;
+	}
+
+	/** Decodes the element type of a container property, and the value type of a map (Unsupported otherwise). */
+	static void ClassifyElementProperties(const FProperty* Property, ELifeInvariantKind& OutElementKind, ELifeInvariantKind& OutMapValueKind)
+	{
+		OutElementKind = ELifeInvariantKind::Unsupported;
+		OutMapValueKind = ELifeInvariantKind::Unsupported;
+		if (const FArrayProperty* ArrayProp = CastField<FArrayProperty>(Property)) {
+			OutElementKind = ClassifyProperty(ArrayProp->Inner);
+		} else if (const FSetProperty* SetProp = CastField<FSetProperty>(Property)) {
+			OutElementKind = ClassifyProperty(SetProp->ElementProp);
+		} else if (const FMapProperty* MapProp = CastField<FMapProperty>(Property)) {
+			OutElementKind = ClassifyProperty(MapProp->KeyProp);
+			OutMapValueKind = ClassifyProperty(MapProp->ValueProp);
+		} else if (const FOptionalProperty* OptProp = CastField<FOptionalProperty>(Property)) {
+			OutElementKind = ClassifyProperty(OptProp->GetValueProperty());
+		}
+	}
+
+	static bool IsIntegerKind(ELifeInvariantKind Kind)
+	{
+		return Kind >= ELifeInvariantKind::Int8 && Kind <= ELifeInvariantKind::UInt64;
+	}
+
+	static bool IsArithmeticKind(ELifeInvariantKind Kind)
+	{
+		return Kind >= ELifeInvariantKind::Int8 && Kind <= ELifeInvariantKind::Double;
+	}
+
+	static bool IsSignedKind(ELifeInvariantKind Kind)
+	{
+		return Kind >= ELifeInvariantKind::Int8 && Kind <= ELifeInvariantKind::Int64;
+	}
+
+	static bool IsPointerKind(ELifeInvariantKind Kind)
+	{
+		return Kind >= ELifeInvariantKind::Object && Kind <= ELifeInvariantKind::Interface;
+	}
+
+	static bool IsContainerKind(ELifeInvariantKind Kind)
+	{
+		return Kind >= ELifeInvariantKind::Array && Kind <= ELifeInvariantKind::Optional;
+	}
+
+	/**
+	 * Decodes the rule string. Like the FString compares this replaces, matching is case-insensitive.
+	 * Anything that is not a built-in rule is the name of a custom invariant function.
+	 */
+	static ELifeInvariantOp DecodeInvariantOp(const FString& Rule)
+	{
+		if (Rule == TEXT("MemSafe"))          { return ELifeInvariantOp::MemSafe; }
+		if (Rule == TEXT("MemSafeContainer")) { return ELifeInvariantOp::MemSafeContainer; }
+		if (Rule == TEXT("ID"))               { return ELifeInvariantOp::ID; }
+		if (Rule == TEXT("Gte0"))             { return ELifeInvariantOp::Gte0; }
+		if (Rule == TEXT("Gt0"))              { return ELifeInvariantOp::Gt0; }
+		if (Rule == TEXT("Lte0"))             { return ELifeInvariantOp::Lte0; }
+		if (Rule == TEXT("Lt0"))              { return ELifeInvariantOp::Lt0; }
+		if (Rule.StartsWith(TEXT("Range")))   { return ELifeInvariantOp::Range; }
+		if (Rule == TEXT("Name"))             { return ELifeInvariantOp::Name; }
+		if (Rule == TEXT("True"))             { return ELifeInvariantOp::True; }
+		if (Rule == TEXT("False"))            { return ELifeInvariantOp::False; }
+		if (Rule == TEXT("Contract*"))        { return ELifeInvariantOp::Contract; }
+		return ELifeInvariantOp::Function;
+	}
+
+	/**
+	 * Strips whitespace and common thousands separators from a bound, e.g. " 1_000 " -> "1000".
+	 */
+	static FString SanitizeRangeBound(const FString& In)
+	{
+		FString Out;
+		Out.Reserve(In.Len());
+		for (const TCHAR C : In) {
+			if (FChar::IsWhitespace(C) || C == '_') {
+				continue;
+			}
+			Out.AppendChar(C);
+		}
+		return Out;
+	}
+
+	/** Matches [+-]digits */
+	static bool IsIntegerLiteral(const FString& In)
+	{
+		int32 i = (In.Len() > 0 && (In[0] == '+' || In[0] == '-')) ? 1 : 0;
+		if (i >= In.Len()) {
+			return false;
+		}
+		for (; i < In.Len(); ++i) {
+			if (!FChar::IsDigit(In[i])) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/** Matches [+-]digits[.digits][(e|E)[+-]digits], with digits allowed on either side of the decimal point. */
+	static bool IsFloatLiteral(const FString& In)
+	{
+		int32 i = (In.Len() > 0 && (In[0] == '+' || In[0] == '-')) ? 1 : 0;
+		int32 NumMantissaDigits = 0;
+		for (; i < In.Len() && FChar::IsDigit(In[i]); ++i) {
+			++NumMantissaDigits;
+		}
+		if (i < In.Len() && In[i] == '.') {
+			for (++i; i < In.Len() && FChar::IsDigit(In[i]); ++i) {
+				++NumMantissaDigits;
+			}
+		}
+		if (NumMantissaDigits == 0) {
+			return false;
+		}
+		if (i < In.Len() && (In[i] == 'e' || In[i] == 'E')) {
+			return IsIntegerLiteral(In.Mid(i + 1));
+		}
+		return i == In.Len();
+	}
+
+	bool ParseRangeInvariant(const FString& Rule, ELifeInvariantKind Kind, FLifeInvariantRange& OutRange, FString& OutError)
+	{
+		// Expect syntax Range[lo,hi], Range(lo,hi], etc. but also allow for Range (1, 2)
+		const FString RangeSpec = Rule.Mid(5).TrimStartAndEnd(); // skip "Range", trim space
+		if (RangeSpec.Len() < 2) {
+			OutError = TEXT("expected Range[lower,upper]");
+			return false;
+		}
+
+		const TCHAR LowerBracket = RangeSpec[0];
+		const TCHAR UpperBracket = RangeSpec[RangeSpec.Len() - 1];
+		if ((LowerBracket != '(' && LowerBracket != '[') || (UpperBracket != ')' && UpperBracket != ']')) {
+			OutError = TEXT("bounds must be enclosed in () or []");
+			return false;
+		}
+		const bool bLowerInclusive = (LowerBracket == TEXT('['));
+		const bool bUpperInclusive = (UpperBracket == TEXT(']'));
+
+		// inner content between brackets
+		TArray<FString> Parts;
+		RangeSpec.Mid(1, RangeSpec.Len() - 2).ParseIntoArray(Parts, TEXT(","), false);
+		if (Parts.Num() != 2) {
+			OutError = TEXT("must contain two comma-separated bounds");
+			return false;
+		}
+
+		const FString Lower = SanitizeRangeBound(Parts[0]);
+		const FString Upper = SanitizeRangeBound(Parts[1]);
+
+		if (IsIntegerKind(Kind)) {
+			// Do not allow floating-point bounds for integer properties, require integer bounds.
+			if (!IsIntegerLiteral(Lower) || !IsIntegerLiteral(Upper)) {
+				OutError = FString::Printf(TEXT("integer property requires integer bounds, got '%s' and '%s'"), *Lower, *Upper);
+				return false;
+			}
+
+			if (IsSignedKind(Kind)) {
+				TLifeInvariantBounds<int64>& Bounds = OutRange.Signed;
+				Bounds.Lower = FCString::Strtoi64(*Lower, nullptr, 10);
+				Bounds.Upper = FCString::Strtoi64(*Upper, nullptr, 10);
+				Bounds.bLowerInclusive = bLowerInclusive;
+				Bounds.bUpperInclusive = bUpperInclusive;
+				if (Bounds.Lower > Bounds.Upper) {
+					OutError = TEXT("lower bound must be <= upper bound");
+					return false;
+				}
+			} else {
+				if (Lower[0] == '-' || Upper[0] == '-') {
+					OutError = TEXT("unsigned property requires non-negative bounds");
+					return false;
+				}
+				TLifeInvariantBounds<uint64>& Bounds = OutRange.Unsigned;
+				Bounds.Lower = FCString::Strtoui64(*Lower, nullptr, 10);
+				Bounds.Upper = FCString::Strtoui64(*Upper, nullptr, 10);
+				Bounds.bLowerInclusive = bLowerInclusive;
+				Bounds.bUpperInclusive = bUpperInclusive;
+				if (Bounds.Lower > Bounds.Upper) {
+					OutError = TEXT("lower bound must be <= upper bound");
+					return false;
+				}
+			}
+			return true;
+		}
+
+		if (Kind == ELifeInvariantKind::Float || Kind == ELifeInvariantKind::Double) {
+			if (!IsFloatLiteral(Lower) || !IsFloatLiteral(Upper)) {
+				OutError = FString::Printf(TEXT("bounds must be numbers, got '%s' and '%s'"), *Lower, *Upper);
+				return false;
+			}
+
+			TLifeInvariantBounds<double>& Bounds = OutRange.Floating;
+			Bounds.Lower = FCString::Atod(*Lower);
+			Bounds.Upper = FCString::Atod(*Upper);
+			Bounds.bLowerInclusive = bLowerInclusive;
+			Bounds.bUpperInclusive = bUpperInclusive;
+			if (Bounds.Lower > Bounds.Upper) {
+				OutError = TEXT("lower bound must be <= upper bound");
+				return false;
+			}
+			return true;
+		}
+
+		OutError = TEXT("property is not arithmetic");
+		return false;
+	}
+
+	/**
+	 * Checks that the rule can be applied to the property kind. These only depend on the class, so they're reported
+	 * once when the plan is built instead of on every check.
+	 */
+	static void ValidateEntry(const UClass* Class, const FLifeInvariantEntry& Entry)
+	{
+		const FProperty* Property = Entry.Property;
+
+		switch (Entry.Op)
+		{
+		case ELifeInvariantOp::MemSafe:
+			checkf(IsPointerKind(Entry.Kind), TEXT("Invariant=MemSafe used on non-pointer property %s::%s"), *Class->GetName(), *Property->GetName());
+			break;
+		case ELifeInvariantOp::MemSafeContainer:
+			checkf(IsContainerKind(Entry.Kind), TEXT("Invariant=MemSafeContainer used on non-container property %s::%s"), *Class->GetName(), *Property->GetName());
+			break;
+		// Numeric rules also take containers of numbers, see GetRuleValueKind
+		case ELifeInvariantOp::ID:
+			checkf(IsIntegerKind(Entry.GetRuleValueKind()), TEXT("Invariant=ID used on non-integer property %s::%s"), *Class->GetName(), *Property->GetName());
+			break;
+		case ELifeInvariantOp::Gte0:
+		case ELifeInvariantOp::Gt0:
+		case ELifeInvariantOp::Lte0:
+		case ELifeInvariantOp::Lt0:
+			checkf(IsArithmeticKind(Entry.GetRuleValueKind()), TEXT("Invariant=%s used on non-arithmetic property %s::%s"), *Entry.Rule, *Class->GetName(), *Property->GetName());
+			break;
+		case ELifeInvariantOp::Range:
+			checkf(IsArithmeticKind(Entry.GetRuleValueKind()), TEXT("Range invariant used on non-arithmetic property %s::%s"), *Class->GetName(), *Property->GetName());
+			break;
+		case ELifeInvariantOp::Name:
+			checkf(Entry.Kind == ELifeInvariantKind::Name, TEXT("Invariant=name used on non-FName property %s::%s"), *Class->GetName(), *Property->GetName());
+			break;
+		case ELifeInvariantOp::True:
+		case ELifeInvariantOp::False:
+			checkf(Entry.Kind == ELifeInvariantKind::Bool, TEXT("Invariant=%s used on non-bool property %s::%s"), *Entry.Rule, *Class->GetName(), *Property->GetName());
+			break;
+		case ELifeInvariantOp::Contract:
+			checkf(Entry.Kind == ELifeInvariantKind::Object || Entry.Kind == ELifeInvariantKind::Class,
+				TEXT("Invariant=Contract* used on non-pointer property %s::%s"), *Class->GetName(), *Property->GetName());
+			break;
+		case ELifeInvariantOp::Function:
+		{
+			if (Entry.NativeFunction) {
+				// The signature was checked by the compiler
+				break;
+			}
+			const UFunction* Function = Entry.Function;
+			checkf(Function != nullptr, TEXT("Invariant function '%s' not found."), *Entry.Rule);
+			if (Function) {
+				// Check for const and no parameters
+				checkf(Function->HasAnyFunctionFlags(FUNC_Const), TEXT("Invariant function '%s' must be const."), *Entry.Rule);
+				checkf(Function->NumParms == 1, TEXT("Invariant function '%s' must have exactly one return value (bool) and no parameters."), *Entry.Rule);
+				checkf(CastField<FBoolProperty>(Function->GetReturnProperty()) != nullptr, TEXT("Invariant function '%s' must return a bool."), *Entry.Rule);
+			}
+			break;
+		}
+		}
+	}
+
+	/** Batches smaller than this stay on the scalar path, gathering wouldn't pay off. */
+	static constexpr int32 MinInvariantBatchSize = 4;
+
+	/**
+	 * Fills the batch parameters for an entry, or returns false if the entry can't be vectorized.
+	 */
+	static bool MakeBatchKey(const FLifeInvariantEntry& Entry, FLifeInvariantBatch& OutBatch)
+	{
+		if (Entry.Kind != ELifeInvariantKind::Int32 && Entry.Kind != ELifeInvariantKind::Float) {
+			return false;
+		}
+
+		switch (Entry.Op)
+		{
+		case ELifeInvariantOp::Gte0:
+		case ELifeInvariantOp::Gt0:
+		case ELifeInvariantOp::Lte0:
+		case ELifeInvariantOp::Lt0:
+			break;
+		case ELifeInvariantOp::Range:
+			if (Entry.Kind == ELifeInvariantKind::Int32) {
+				const TLifeInvariantBounds<int64>& Bounds = Entry.Range.Signed;
+				if (Bounds.Lower < MIN_int32 || Bounds.Upper > MAX_int32) {
+					return false;
+				}
+				OutBatch.LowerInt = static_cast<int32>(Bounds.Lower);
+				OutBatch.UpperInt = static_cast<int32>(Bounds.Upper);
+				OutBatch.bLowerInclusive = Bounds.bLowerInclusive;
+				OutBatch.bUpperInclusive = Bounds.bUpperInclusive;
+			} else {
+				const TLifeInvariantBounds<double>& Bounds = Entry.Range.Floating;
+				if (FMath::Abs(Bounds.Lower) > MAX_flt || FMath::Abs(Bounds.Upper) > MAX_flt) {
+					return false;
+				}
+				// Round inward: the vector test may be stricter than the scalar one (which adds an epsilon), never laxer
+				float Lower = static_cast<float>(Bounds.Lower);
+				float Upper = static_cast<float>(Bounds.Upper);
+				if (static_cast<double>(Lower) < Bounds.Lower) {
+					Lower = std::nextafter(Lower, MAX_flt);
+				}
+				if (static_cast<double>(Upper) > Bounds.Upper) {
+					Upper = std::nextafter(Upper, -MAX_flt);
+				}
+				OutBatch.LowerFloat = Lower;
+				OutBatch.UpperFloat = Upper;
+				OutBatch.bLowerInclusive = Bounds.bLowerInclusive;
+				OutBatch.bUpperInclusive = Bounds.bUpperInclusive;
+			}
+			break;
+		default:
+			return false;
+		}
+
+		OutBatch.Op = Entry.Op;
+		OutBatch.Kind = Entry.Kind;
+		return true;
+	}
+
+	static bool HasSameBatchKey(const FLifeInvariantBatch& A, const FLifeInvariantBatch& B)
+	{
+		return A.Op == B.Op && A.Kind == B.Kind &&
+			A.LowerInt == B.LowerInt && A.UpperInt == B.UpperInt &&
+			A.LowerFloat == B.LowerFloat && A.UpperFloat == B.UpperFloat &&
+			A.bLowerInclusive == B.bLowerInclusive && A.bUpperInclusive == B.bUpperInclusive;
+	}
+
+	/**
+	 * Groups same-type numeric entries under the same rule into vector batches. The entries don't need to be
+	 * contiguous, each batch gathers its values from a list of offsets.
+	 */
+	static void BuildBatches(FLifeInvariantPlan& Plan)
+	{
+		TArray<FLifeInvariantBatch> Candidates;
+		for (int32 EntryIndex = 0; EntryIndex < Plan.Entries.Num(); ++EntryIndex) {
+			FLifeInvariantBatch Key;
+			if (!MakeBatchKey(Plan.Entries[EntryIndex], Key)) {
+				continue;
+			}
+
+			FLifeInvariantBatch* Batch = Candidates.FindByPredicate([&Key](const FLifeInvariantBatch& Candidate) {
+				return HasSameBatchKey(Candidate, Key);
+			});
+			if (!Batch) {
+				Batch = &Candidates.Add_GetRef(MoveTemp(Key));
+			}
+			Batch->EntryIndices.Add(EntryIndex);
+		}
+
+		for (FLifeInvariantBatch& Batch : Candidates) {
+			if (Batch.EntryIndices.Num() < MinInvariantBatchSize) {
+				continue;
+			}
+
+			for (const int32 EntryIndex : Batch.EntryIndices) {
+				FLifeInvariantEntry& Entry = Plan.Entries[EntryIndex];
+				Entry.bBatched = true;
+				Batch.Offsets.Add(Entry.Offset);
+			}
+			// Pad the last vector with a lane we already test
+			while (Batch.Offsets.Num() % 4 != 0) {
+				Batch.Offsets.Add(Batch.Offsets.Last());
+			}
+
+			Plan.Batches.Add(MoveTemp(Batch));
+		}
+	}
+
+	/**
+	 * True if the entry's result is fully determined by its own bytes (and for TArray/TOptional, their elements).
+	 * Weak pointers, and every pointer in strict MemSafe mode, depend on the liveness of their target. Sets and maps
+	 * are too expensive to hash.
+	 */
+	static bool IsFingerprintable(const FLifeInvariantEntry& Entry)
+	{
+		if (Entry.Kind == ELifeInvariantKind::Set || Entry.Kind == ELifeInvariantKind::Map) {
+			return false;
+		}
+		if (IsStrictMemSafeEnabled() && (Entry.Op == ELifeInvariantOp::MemSafe || Entry.Op == ELifeInvariantOp::MemSafeContainer)) {
+			return false;
+		}
+
+		switch (Entry.Op)
+		{
+		case ELifeInvariantOp::MemSafe:
+			return Entry.Kind != ELifeInvariantKind::WeakObject;
+		case ELifeInvariantOp::MemSafeContainer:
+			return (Entry.Kind == ELifeInvariantKind::Array || Entry.Kind == ELifeInvariantKind::Optional)
+				&& Entry.ElementKind != ELifeInvariantKind::WeakObject;
+		case ELifeInvariantOp::Contract:
+		case ELifeInvariantOp::Function:
+			return false;
+		default:
+			return Entry.Kernel != nullptr;
+		}
+	}
+
+	/**
+	 * Flags the fingerprinted entries and collects their bytes into sorted, merged ranges.
+	 */
+	static void BuildFingerprint(FLifeInvariantPlan& Plan)
+	{
+		TArray<FLifeInvariantFingerprintRange> Ranges;
+		for (FLifeInvariantEntry& Entry : Plan.Entries) {
+			Entry.bFingerprinted = IsFingerprintable(Entry);
+			if (!Entry.bFingerprinted) {
+				continue;
+			}
+			Ranges.Add({ Entry.Offset, Entry.Property->GetSize() });
+			if (const FArrayProperty* ArrayProp = CastField<FArrayProperty>(Entry.Property)) {
+				Plan.FingerprintArrays.Add({ Entry.Offset, ArrayProp->Inner->GetSize() });
+			}
+		}
+
+		Ranges.Sort([](const FLifeInvariantFingerprintRange& A, const FLifeInvariantFingerprintRange& B) { return A.Offset < B.Offset; });
+		for (const FLifeInvariantFingerprintRange& Range : Ranges) {
+			FLifeInvariantFingerprintRange* Last = Plan.FingerprintRanges.IsEmpty() ? nullptr : &Plan.FingerprintRanges.Last();
+			if (Last && Range.Offset <= Last->Offset + Last->Size) {
+				// Adjacent or overlapping (bitfield bools share a byte)
+				Last->Size = FMath::Max(Last->Size, Range.Offset + Range.Size - Last->Offset);
+			} else {
+				Plan.FingerprintRanges.Add(Range);
+			}
+		}
+
+		Plan.bFullyFingerprinted = Plan.Functions.IsEmpty() && !Plan.Entries.IsEmpty()
+			&& !Plan.Entries.ContainsByPredicate([](const FLifeInvariantEntry& Entry) { return !Entry.bFingerprinted; });
+	}
+
+	/** A registered LG_REGISTER_NATIVE_INVARIANT binding. */
+	struct FLifeNativeInvariant
+	{
+		UClass* (*GetClass)() = nullptr;
+		const TCHAR* FunctionName = nullptr;
+		FLifeNativeInvariantFunc Function = nullptr;
+	};
+
+	/** Function local, so registrations from other translation units' static initializers always find it constructed. */
+	static TArray<FLifeNativeInvariant>& GetNativeInvariants()
+	{
+		static TArray<FLifeNativeInvariant> NativeInvariants;
+		return NativeInvariants;
+	}
+
+	/**
+	 * Finds the native binding of FunctionName for Class. Bindings registered on a subclass override the ones on its
+	 * parents, like a virtual would.
+	 */
+	static FLifeNativeInvariantFunc FindNativeInvariant(const UClass* Class, const TCHAR* FunctionName)
+	{
+		const UClass* BestClass = nullptr;
+		FLifeNativeInvariantFunc BestFunction = nullptr;
+		for (const FLifeNativeInvariant& Native : GetNativeInvariants()) {
+			if (FCString::Stricmp(Native.FunctionName, FunctionName) != 0) {
+				continue;
+			}
+			const UClass* NativeClass = Native.GetClass();
+			if (Class->IsChildOf(NativeClass) && (!BestClass || NativeClass->IsChildOf(BestClass))) {
+				BestClass = NativeClass;
+				BestFunction = Native.Function;
+			}
+		}
+		return BestFunction;
+	}
+
+	void RegisterNativeInvariant(UClass* (*GetClass)(), const TCHAR* FunctionName, FLifeNativeInvariantFunc Function)
+	{
+		check(GetClass && FunctionName && Function);
+		GetNativeInvariants().Add({ GetClass, FunctionName, Function });
+
+		// A module loaded at runtime may bind functions of classes that already have a plan
+		if (GIsRunning && IsInGameThread()) {
+			FLifeInvariantPlanCache::Invalidate();
+		}
+	}
+
+	void FLifeInvariantPlanCache::Initialize()
+	{
+		// Live Coding and hot reload can change class layouts in place
+		ReloadCompleteHandle = FCoreUObjectDelegates::ReloadCompleteDelegate.AddLambda([](EReloadCompleteReason) {
+			Invalidate();
+		});
+
+#if WITH_EDITOR
+		// Blueprint recompiles reinstance every object of the class
+		ObjectsReinstancedHandle = FCoreUObjectDelegates::OnObjectsReinstanced.AddLambda([](const TMap<UObject*, UObject*>&) {
+			Invalidate();
+		});
+#endif
+	}
+
+	void FLifeInvariantPlanCache::Shutdown()
+	{
+		FCoreUObjectDelegates::ReloadCompleteDelegate.Remove(ReloadCompleteHandle);
+#if WITH_EDITOR
+		FCoreUObjectDelegates::OnObjectsReinstanced.Remove(ObjectsReinstancedHandle);
+#endif
+		Plans.Empty();
+	}
+
+	const FLifeInvariantPlan& FLifeInvariantPlanCache::GetPlan(const UClass* Class)
+	{
+		LG_PRECOND(Class);
+
+		TUniquePtr<FLifeInvariantPlan>& Plan = Plans.FindOrAdd(Class);
+
+		// A class at a recycled address fails the weak pointer serial check, so it gets a fresh plan
+		if (!Plan.IsValid() || Plan->Class.Get() != Class) {
+			Plan = BuildPlan(Class);
+		}
+
+		return *Plan;
+	}
+
+	void FLifeInvariantPlanCache::Invalidate()
+	{
+		if (Plans.Num() > 0) {
+			UE_LOG(LogLife, Verbose, TEXT("Invalidating %d invariant plans"), Plans.Num());
+		}
+		Plans.Empty();
+	}
+
+	/** An annotated property, as read from the precompiled invariant table or from metadata. */
+	struct FLifeInvariantSource
+	{
+		FProperty* Property = nullptr;
+		FString Rule;
+		ELifeInvariantOp Op = ELifeInvariantOp::Function;
+		/** Bounds parsed when the table was written. Null for metadata, Range rules are parsed when the plan is built. */
+		const FLifeInvariantRange* Range = nullptr;
+	};
+
+	/** Logs why a table record can't be used and drops what was read from it. */
+	static bool RejectTableRecord(const UClass* Class, const FString& ChangedName, TArray<FLifeInvariantSource>& OutProperties, TArray<UFunction*>& OutFunctions)
+	{
+		UE_LOG(LogLife, Warning, TEXT("Invariant table record of %s is stale (%s changed), rebuild the table with -run=LifeInvariantTable"),
+			*Class->GetName(), *ChangedName);
+		OutProperties.Reset();
+		OutFunctions.Reset();
+		return false;
+	}
+
+	/**
+	 * Reads the annotations of a class from the precompiled table. False if the class isn't in the table, or if its
+	 * record is stale: a property or function it names is gone, or a property moved or changed type since the table
+	 * was written. With metadata, the record must also still match the annotations: same rules on the same
+	 * properties and functions, none added or removed.
+	 */
+	static bool ReadTableSources(const UClass* Class, TArray<FLifeInvariantSource>& OutProperties, TArray<UFunction*>& OutFunctions)
+	{
+		const InvariantTable::FClass* Record = FLifeInvariantTable::FindClass(Class);
+		if (!Record) {
+			return false;
+		}
+
+		for (const InvariantTable::FEntry& TableEntry : FLifeInvariantTable::GetEntries(*Record)) {
+			const FString PropertyName = FLifeInvariantTable::GetString(TableEntry.PropertyName);
+			FProperty* Property = FindFProperty<FProperty>(Class, FName(*PropertyName));
+			if (!Property || Property->GetOffset_ForInternal() != TableEntry.Offset) {
+				return RejectTableRecord(Class, PropertyName, OutProperties, OutFunctions);
+			}
+
+			// The stored bounds are only meaningful for the type they were parsed for
+			ELifeInvariantKind ElementKind;
+			ELifeInvariantKind MapValueKind;
+			ClassifyElementProperties(Property, ElementKind, MapValueKind);
+			if (ClassifyProperty(Property) != TableEntry.Kind || ElementKind != TableEntry.ElementKind || MapValueKind != TableEntry.MapValueKind) {
+				return RejectTableRecord(Class, PropertyName, OutProperties, OutFunctions);
+			}
+
+			FString Rule = FLifeInvariantTable::GetString(TableEntry.Rule);
+#if WITH_METADATA
+			const FString* MetadataRule = Property->FindMetaData(TEXT("Invariant"));
+			if (!MetadataRule || *MetadataRule != Rule) {
+				return RejectTableRecord(Class, PropertyName, OutProperties, OutFunctions);
+			}
+#endif
+			OutProperties.Add({ Property, MoveTemp(Rule), TableEntry.Op, &TableEntry.Range });
+		}
+
+		for (const InvariantTable::FFunction& TableFunction : FLifeInvariantTable::GetFunctions(*Record)) {
+			const FString FunctionName = FLifeInvariantTable::GetString(TableFunction.Name);
+			UFunction* Function = Class->FindFunctionByName(FName(*FunctionName));
+#if WITH_METADATA
+			const bool bAnnotated = Function && Function->HasMetaData(TEXT("Invariant"));
+#else
+			const bool bAnnotated = Function != nullptr;
+#endif
+			if (!bAnnotated) {
+				return RejectTableRecord(Class, FunctionName, OutProperties, OutFunctions);
+			}
+			OutFunctions.Add(Function);
+		}
+
+#if WITH_METADATA
+		// Every record matched, so a count mismatch means annotations were added since
+		int32 NumAnnotatedProperties = 0;
+		for (TFieldIterator<FProperty> PropIt(Class); PropIt; ++PropIt) {
+			NumAnnotatedProperties += PropIt->HasMetaData(TEXT("Invariant")) ? 1 : 0;
+		}
+		int32 NumAnnotatedFunctions = 0;
+		for (TFieldIterator<UFunction> FuncIt(Class); FuncIt; ++FuncIt) {
+			NumAnnotatedFunctions += FuncIt->HasMetaData(TEXT("Invariant")) ? 1 : 0;
+		}
+		if (NumAnnotatedProperties != OutProperties.Num() || NumAnnotatedFunctions != OutFunctions.Num()) {
+			return RejectTableRecord(Class, TEXT("an annotation"), OutProperties, OutFunctions);
+		}
+#endif
+		return true;
+	}
+
+#if WITH_METADATA
+	static void ReadMetadataSources(const UClass* Class, TArray<FLifeInvariantSource>& OutProperties, TArray<UFunction*>& OutFunctions)
+	{
+		for (TFieldIterator<FProperty> PropIt(Class); PropIt; ++PropIt) {
+			FProperty* Property = *PropIt;
+			if (Property->HasMetaData(TEXT("Invariant"))) {
+				const FString& Rule = Property->GetMetaData(TEXT("Invariant"));
+				OutProperties.Add({ Property, Rule, DecodeInvariantOp(Rule), nullptr });
+			}
+		}
+
+		for (TFieldIterator<UFunction> FuncIt(Class); FuncIt; ++FuncIt) {
+			if (FuncIt->HasMetaData(TEXT("Invariant"))) {
+				OutFunctions.Add(*FuncIt);
+			}
+		}
+	}
+#endif
+
+	TUniquePtr<FLifeInvariantPlan> FLifeInvariantPlanCache::BuildPlan(const UClass* Class)
+	{
+		TUniquePtr<FLifeInvariantPlan> Plan = MakeUnique<FLifeInvariantPlan>();
+		Plan->Class = Class;
+
+		// The table is preferred when present and up to date. Without metadata (packaged builds), classes it doesn't have
+		// get no invariants
+		TArray<FLifeInvariantSource> Sources;
+		TArray<UFunction*> InvariantFunctions;
+		Plan->bFromTable = ReadTableSources(Class, Sources, InvariantFunctions);
+		if (!Plan->bFromTable) {
+#if WITH_METADATA
+			ReadMetadataSources(Class, Sources, InvariantFunctions);
+#endif
+		}
+
+		for (const FLifeInvariantSource& Source : Sources) {
+			FProperty* Property = Source.Property;
+
+			FLifeInvariantEntry& Entry = Plan->Entries.AddDefaulted_GetRef();
+			Entry.Rule = Source.Rule;
+			Entry.Op = Source.Op;
+			Entry.Kind = ClassifyProperty(Property);
+			Entry.Offset = Property->GetOffset_ForInternal();
+			Entry.Property = Property;
+
+			ClassifyElementProperties(Property, Entry.ElementKind, Entry.MapValueKind);
+
+			if (Entry.Op == ELifeInvariantOp::Function) {
+				Entry.NativeFunction = FindNativeInvariant(Class, *Entry.Rule);
+				if (!Entry.NativeFunction) {
+					Entry.Function = Class->FindFunctionByName(*Entry.Rule);
+				}
+			}
+
+			ValidateEntry(Class, Entry);
+
+			// Malformed specs are reported when the class is registered in the cache, not when a value is checked
+			if (Source.Range) {
+				Entry.Range = *Source.Range;
+			} else if (Entry.Op == ELifeInvariantOp::Range) {
+				FString Error;
+				const bool bParsed = ParseRangeInvariant(Entry.Rule, Entry.GetRuleValueKind(), Entry.Range, Error);
+				checkf(bParsed, TEXT("Invalid Range invariant '%s' on %s::%s: %s"), *Entry.Rule, *Class->GetName(), *Property->GetName(), *Error);
+			}
+
+			Entry.Kernel = FindInvariantKernel(Entry);
+			Entry.ElementKernel = FindInvariantElementKernel(Entry);
+
+			if (Entry.Op == ELifeInvariantOp::MemSafe && IsStrictMemSafeEnabled()
+				&& (Entry.Kind == ELifeInvariantKind::Object || Entry.Kind == ELifeInvariantKind::Class)) {
+				Plan->StrictPointerOffsets.Add(Entry.Offset);
+			}
+		}
+
+		BuildBatches(*Plan);
+
+		for (UFunction* Function : InvariantFunctions) {
+			// Check for const, no parameters, and bool return type
+			checkf(Function->HasAnyFunctionFlags(FUNC_Const), TEXT("Invariant function '%s' on class '%s' must be const."), *Function->GetName(), *Class->GetName());
+			checkf(Function->NumParms == 1, TEXT("Invariant function '%s' on class '%s' must have no parameters and return a bool."), *Function->GetName(), *Class->GetName());
+			checkf(CastField<FBoolProperty>(Function->GetReturnProperty()) != nullptr, TEXT("Invariant function '%s' on class '%s' must return a bool."), *Function->GetName(), *Class->GetName());
+
+			Plan->Functions.Add({ Function->GetFName(), FindNativeInvariant(Class, *Function->GetName()), Function });
+		}
+
+		// Native invariants that nothing references run as class level invariants, once per name
+		for (const FLifeNativeInvariant& Native : GetNativeInvariants()) {
+			if (!Class->IsChildOf(Native.GetClass())) {
+				continue;
+			}
+			const FName Name(Native.FunctionName);
+			const bool bReferenced =
+				Plan->Functions.ContainsByPredicate([Name](const FLifeInvariantFunction& Function) { return Function.Name == Name; }) ||
+				Plan->Entries.ContainsByPredicate([Name](const FLifeInvariantEntry& Entry) {
+					return Entry.Op == ELifeInvariantOp::Function && FName(*Entry.Rule) == Name;
+				});
+			if (!bReferenced) {
+				Plan->Functions.Add({ Name, FindNativeInvariant(Class, Native.FunctionName), nullptr });
+			}
+		}
+
+		BuildFingerprint(*Plan);
+
+		Plan->bHasContracts = Plan->Entries.ContainsByPredicate([](const FLifeInvariantEntry& Entry) {
+			return Entry.Op == ELifeInvariantOp::Contract;
+		});
+		// Workers call the kernels blindly, so every entry needs one (Function and Contract* entries never have one)
+		Plan->bPureFieldReads = Plan->Functions.IsEmpty() && !Plan->bHasContracts && !Plan->Entries.ContainsByPredicate([](const FLifeInvariantEntry& Entry) {
+			return Entry.Kernel == nullptr;
+		});
+
+		// Dynamic stats are never freed, so only classes that have checks get one
+		if (IsPerClassStatsEnabled() && !Plan->IsEmpty()) {
+			Plan->TraceName = FString::Printf(TEXT("Invariants %s"), *Class->GetName());
+#if STATS
+			Plan->StatId = FDynamicStats::CreateStatId<FStatGroup_STATGROUP_Lifeguard>(Plan->TraceName);
+#endif
+		}
+
+		UE_LOG(LogLife, Verbose, TEXT("Built invariant plan for %s: %d properties (%d vector batches), %d functions"),
+			*Class->GetName(), Plan->Entries.Num(), Plan->Batches.Num(), Plan->Functions.Num());
+
+		return Plan;
+	}
+}
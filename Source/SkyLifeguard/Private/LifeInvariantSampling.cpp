@@ -0,0 +1,205 @@
+﻿#include "LifeInvariantSampling.h"
+
+#include "HAL/IConsoleManager.h"
+#include "LifeLogChannels.h"
+
+static bool GLifeInvariantSampling = false;
+static FAutoConsoleVariableRef CVarLifeInvariantSampling(
+	TEXT("Lifeguard.Invariants.Sampling"),
+	GLifeInvariantSampling,
+	TEXT("If true, LG_CLASS_INVARIANTS only runs a share of its checks every frame, see Lifeguard.Invariants.Sampling.Rate and Lifeguard.Invariants.Sampling.BudgetMs."));
+
+static float GLifeInvariantSampleRate = 1.0f;
+static FAutoConsoleVariableRef CVarLifeInvariantSampleRate(
+	TEXT("Lifeguard.Invariants.Sampling.Rate"),
+	GLifeInvariantSampleRate,
+	TEXT("Share of the invariant checks of each class that run every frame (0, 1]. Objects are picked round-robin, so each one is checked at least every 1/Rate frames."));
+
+static float GLifeInvariantBudgetMs = 0.5f;
+static FAutoConsoleVariableRef CVarLifeInvariantBudgetMs(
+	TEXT("Lifeguard.Invariants.Sampling.BudgetMs"),
+	GLifeInvariantBudgetMs,
+	TEXT("Time all invariant checks may take per frame, in milliseconds. 0 means no budget. Checks that don't fit are resumed next frame."));
+
+namespace Debug
+{
+	// Static member initialization
+	TMap<const UClass*, TUniquePtr<FLifeInvariantSamplingState>> FLifeInvariantSampler::States;
+	FLifeInvariantSamplingStats FLifeInvariantSampler::Stats;
+	uint64 FLifeInvariantSampler::Frame = 0;
+	int64 FLifeInvariantSampler::SpentCycles = 0;
+
+	/** Converts a budget in milliseconds to cycles, 0 (no budget) for anything not positive. */
+	static int64 BudgetMsToCycles(float BudgetMs)
+	{
+		return BudgetMs > 0.0f ? static_cast<int64>(BudgetMs / 1000.0 / FPlatformTime::GetSecondsPerCycle64()) : 0;
+	}
+
+	bool FLifeInvariantSampler::IsEnabled()
+	{
+		return GLifeInvariantSampling && IsInGameThread();
+	}
+
+	FLifeInvariantSamplingState& FLifeInvariantSampler::GetState(const UClass* Class)
+	{
+		TUniquePtr<FLifeInvariantSamplingState>& State = States.FindOrAdd(Class);
+		// A new class at the address of a collected one starts over
+		if (!State.IsValid() || State->Class.Get() != Class) {
+			State = MakeUnique<FLifeInvariantSamplingState>();
+			State->Class = Class;
+		}
+		return *State;
+	}
+
+	void FLifeInvariantSampler::BeginFrame()
+	{
+		if (Frame != GFrameCounter) {
+			Frame = GFrameCounter;
+			SpentCycles = 0;
+		}
+	}
+
+	FLifeInvariantSamplingState* FLifeInvariantSampler::Admit(const UClass* Class)
+	{
+		check(IsInGameThread());
+
+		BeginFrame();
+		FLifeInvariantSamplingState& State = GetState(Class);
+
+		if (State.Frame != Frame) {
+			// Resume where the budget ran out, or start over if last frame got through all its calls
+			State.ResumeIndex = State.ExhaustedIndex != INDEX_NONE ? State.ExhaustedIndex : 0;
+			State.ExhaustedIndex = INDEX_NONE;
+			State.Frame = Frame;
+			State.CallIndex = 0;
+			State.SpentCycles = 0;
+			State.bAdmittedThisFrame = false;
+		}
+
+		const int32 CallIndex = State.CallIndex++;
+		bool bAdmit = CallIndex >= State.ResumeIndex;
+
+		// Rate: one call in Stride, the phase shifts every frame so every position comes up
+		const float SampleRate = State.SampleRate >= 0.0f ? State.SampleRate : GLifeInvariantSampleRate;
+		if (bAdmit && SampleRate < 1.0f) {
+			const int32 Stride = SampleRate > 0.0f ? FMath::Max(1, FMath::RoundToInt(1.0f / SampleRate)) : MAX_int32;
+			bAdmit = (static_cast<uint64>(CallIndex) + Frame) % Stride == 0;
+		}
+
+		// Budget: the check is admitted if its expected cost still fits. The first one of the frame always is, or a check
+		// costing more than the whole budget would pin ResumeIndex forever
+		if (bAdmit && State.bAdmittedThisFrame) {
+			const int64 GlobalBudget = BudgetMsToCycles(GLifeInvariantBudgetMs);
+			const int64 ClassBudget = State.BudgetMs >= 0.0f ? BudgetMsToCycles(State.BudgetMs) : 0;
+			const bool bGlobalExhausted = GlobalBudget > 0 && SpentCycles + State.EstimatedCycles > GlobalBudget;
+			const bool bClassExhausted = ClassBudget > 0 && State.SpentCycles + State.EstimatedCycles > ClassBudget;
+			if (bGlobalExhausted || bClassExhausted) {
+				bAdmit = false;
+				if (State.ExhaustedIndex == INDEX_NONE) {
+					State.ExhaustedIndex = CallIndex;
+				}
+			}
+		}
+
+		if (!bAdmit) {
+			++State.Stats.NumSkipped;
+			++Stats.NumSkipped;
+			return nullptr;
+		}
+
+		State.bAdmittedThisFrame = true;
+		// Reserve now so admitting many objects before running them (batches) doesn't overshoot
+		SpentCycles += State.EstimatedCycles;
+		State.SpentCycles += State.EstimatedCycles;
+		++State.Stats.NumExecuted;
+		++Stats.NumExecuted;
+		return &State;
+	}
+
+	void FLifeInvariantSampler::Record(FLifeInvariantSamplingState& State, uint64 Cycles, int32 NumChecks)
+	{
+		check(NumChecks > 0);
+
+		// Swap the reservation for the real cost
+		const int64 Correction = static_cast<int64>(Cycles) - State.EstimatedCycles * NumChecks;
+		SpentCycles = FMath::Max<int64>(0, SpentCycles + Correction);
+		State.SpentCycles = FMath::Max<int64>(0, State.SpentCycles + Correction);
+
+		const int64 CyclesPerCheck = static_cast<int64>(Cycles) / NumChecks;
+		State.EstimatedCycles = State.EstimatedCycles == 0 ? CyclesPerCheck : (State.EstimatedCycles * 7 + CyclesPerCheck) / 8;
+	}
+
+	void FLifeInvariantSampler::SetClassSampling(const UClass* Class, float SampleRate, float BudgetMs)
+	{
+		check(IsInGameThread());
+		FLifeInvariantSamplingState& State = GetState(Class);
+		State.SampleRate = SampleRate;
+		State.BudgetMs = BudgetMs;
+	}
+
+	FLifeInvariantSamplingStats FLifeInvariantSampler::GetClassStats(const UClass* Class)
+	{
+		const TUniquePtr<FLifeInvariantSamplingState>* State = States.Find(Class);
+		return State && (*State)->Class.Get() == Class ? (*State)->Stats : FLifeInvariantSamplingStats();
+	}
+
+	void FLifeInvariantSampler::LogStats()
+	{
+		const uint64 Total = Stats.NumExecuted + Stats.NumSkipped;
+		UE_LOG(LogLife, Log, TEXT("Invariant checks: %llu executed, %llu skipped (%.1f%% coverage)"),
+			Stats.NumExecuted, Stats.NumSkipped, Total > 0 ? 100.0 * Stats.NumExecuted / Total : 100.0);
+
+		for (const TPair<const UClass*, TUniquePtr<FLifeInvariantSamplingState>>& Pair : States) {
+			const FLifeInvariantSamplingState& State = *Pair.Value;
+			if (const UClass* Class = State.Class.Get()) {
+				UE_LOG(LogLife, Log, TEXT("  %s: %llu executed, %llu skipped"), *Class->GetName(), State.Stats.NumExecuted, State.Stats.NumSkipped);
+			}
+		}
+	}
+
+	void FLifeInvariantSampler::ResetStats()
+	{
+		Stats = FLifeInvariantSamplingStats();
+		for (TPair<const UClass*, TUniquePtr<FLifeInvariantSamplingState>>& Pair : States) {
+			Pair.Value->Stats = FLifeInvariantSamplingStats();
+		}
+	}
+}
+
+static FAutoConsoleCommand GLifeCmd_SamplingClass(
+	TEXT("Lifeguard.Invariants.Sampling.Class"),
+	TEXT("Overrides the sample rate and budget of one class. Negative values use the global CVars. Usage: Lifeguard.Invariants.Sampling.Class <ClassName> <Rate> [BudgetMs]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		if (Args.Num() < 2) {
+			UE_LOG(LogLife, Warning, TEXT("Usage: Lifeguard.Invariants.Sampling.Class <ClassName> <Rate> [BudgetMs]"));
+			return;
+		}
+
+		const UClass* Class = FindFirstObject<UClass>(*Args[0], EFindFirstObjectOptions::NativeFirst);
+		if (!Class) {
+			UE_LOG(LogLife, Warning, TEXT("Class '%s' not found"), *Args[0]);
+			return;
+		}
+
+		const float SampleRate = FCString::Atof(*Args[1]);
+		const float BudgetMs = Args.Num() > 2 ? FCString::Atof(*Args[2]) : -1.0f;
+		Debug::FLifeInvariantSampler::SetClassSampling(Class, SampleRate, BudgetMs);
+		UE_LOG(LogLife, Log, TEXT("Invariant sampling for %s: rate %.3f, budget %.3f ms"), *Class->GetName(), SampleRate, BudgetMs);
+	})
+);
+
+static FAutoConsoleCommand GLifeCmd_SamplingStats(
+	TEXT("Lifeguard.Invariants.Sampling.Stats"),
+	TEXT("Logs executed vs skipped invariant checks, overall and per class. Usage: Lifeguard.Invariants.Sampling.Stats [reset]"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		if (Args.Num() > 0 && Args[0].Equals(TEXT("reset"), ESearchCase::IgnoreCase)) {
+			Debug::FLifeInvariantSampler::ResetStats();
+			UE_LOG(LogLife, Log, TEXT("Invariant sampling stats reset"));
+			return;
+		}
+
+		Debug::FLifeInvariantSampler::LogStats();
+	})
+);
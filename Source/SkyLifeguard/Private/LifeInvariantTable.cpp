@@ -0,0 +1,297 @@
+﻿#include "LifeInvariantTable.h"
+
+#include "Algo/BinarySearch.h"
+#include "Algo/Sort.h"
+#include "Async/MappedFileHandle.h"
+#include "Hash/CityHash.h"
+#include "HAL/PlatformFileManager.h"
+#include "Interfaces/IPluginManager.h"
+#include "LifeLogChannels.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "UObject/UObjectIterator.h"
+
+namespace Debug
+{
+	using namespace InvariantTable;
+
+	// Static member initialization
+	IMappedFileHandle* FLifeInvariantTable::MappedFile = nullptr;
+	IMappedFileRegion* FLifeInvariantTable::MappedRegion = nullptr;
+	TArray<uint8> FLifeInvariantTable::LoadedData;
+	const FHeader* FLifeInvariantTable::Header = nullptr;
+	const FClass* FLifeInvariantTable::Classes = nullptr;
+	const FEntry* FLifeInvariantTable::Entries = nullptr;
+	const FFunction* FLifeInvariantTable::Functions = nullptr;
+	const ANSICHAR* FLifeInvariantTable::Strings = nullptr;
+
+	static uint64 HashClassPath(FStringView Path)
+	{
+		const FTCHARToUTF8 Utf8(Path.GetData(), Path.Len());
+		return CityHash64(Utf8.Get(), Utf8.Length());
+	}
+
+	void FLifeInvariantTable::Initialize(const FString& Path)
+	{
+		Shutdown();
+
+		IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+		if (!PlatformFile.FileExists(*Path)) {
+			return;
+		}
+
+		MappedFile = PlatformFile.OpenMapped(*Path);
+		if (MappedFile) {
+			MappedRegion = MappedFile->MapRegion(0, MappedFile->GetFileSize());
+		}
+
+		bool bBound = false;
+		if (MappedRegion) {
+			bBound = Bind(MappedRegion->GetMappedPtr(), MappedRegion->GetMappedSize());
+		} else if (FFileHelper::LoadFileToArray(LoadedData, *Path)) {
+			bBound = Bind(LoadedData.GetData(), LoadedData.Num());
+		}
+
+		if (bBound) {
+			UE_LOG(LogLife, Log, TEXT("Loaded the invariant table %s: %d classes (%s)"), *Path, Header->NumClasses, MappedRegion ? TEXT("mapped") : TEXT("loaded"));
+		} else {
+			UE_LOG(LogLife, Warning, TEXT("Ignoring the invariant table %s, it's truncated, corrupt or from another version. Rebuild it with -run=LifeInvariantTable"), *Path);
+			Shutdown();
+		}
+	}
+
+	void FLifeInvariantTable::Shutdown()
+	{
+		Header = nullptr;
+		Classes = nullptr;
+		Entries = nullptr;
+		Functions = nullptr;
+		Strings = nullptr;
+
+		delete MappedRegion;
+		MappedRegion = nullptr;
+		delete MappedFile;
+		MappedFile = nullptr;
+		LoadedData.Empty();
+	}
+
+	FString FLifeInvariantTable::GetDefaultPath()
+	{
+		const TSharedPtr<IPlugin> Plugin = IPluginManager::Get().FindPlugin(TEXT("SkyLifeguard"));
+		const FString ContentDir = Plugin.IsValid() ? Plugin->GetContentDir() : FPaths::ProjectPluginsDir() / TEXT("SkyLifeguard/Content");
+		return ContentDir / TEXT("Lifeguard/InvariantTable.bin");
+	}
+
+	/** True if [First, First + Num) lies within a section of Total records. */
+	static bool IsValidSpan(int32 First, int32 Num, int32 Total)
+	{
+		return First >= 0 && Num >= 0 && static_cast<int64>(First) + Num <= Total;
+	}
+
+	/** True if Offset starts a string of the blob. The blob ends with a null, so every such string is terminated. */
+	static bool IsValidString(int32 Offset, int32 NumStringBytes)
+	{
+		return Offset >= 0 && Offset < NumStringBytes;
+	}
+
+	/**
+	 * Checks every offset and span of the table against its sections, so a corrupt or hand-edited file is rejected
+	 * here instead of being read out of bounds later.
+	 */
+	static bool ValidateRecords(const FHeader& TableHeader, const FClass* TableClasses, const FEntry* TableEntries,
+		const FFunction* TableFunctions, const ANSICHAR* TableStrings)
+	{
+		const int32 NumStringBytes = TableHeader.NumStringBytes;
+		if (NumStringBytes > 0 && TableStrings[NumStringBytes - 1] != '\0') {
+			return false;
+		}
+
+		for (int32 Index = 0; Index < TableHeader.NumClasses; ++Index) {
+			const FClass& Record = TableClasses[Index];
+			if (!IsValidString(Record.Path, NumStringBytes)
+				|| !IsValidSpan(Record.FirstEntry, Record.NumEntries, TableHeader.NumEntries)
+				|| !IsValidSpan(Record.FirstFunction, Record.NumFunctions, TableHeader.NumFunctions)) {
+				return false;
+			}
+		}
+
+		for (int32 Index = 0; Index < TableHeader.NumEntries; ++Index) {
+			const FEntry& Entry = TableEntries[Index];
+			if (!IsValidString(Entry.PropertyName, NumStringBytes) || !IsValidString(Entry.Rule, NumStringBytes)
+				|| Entry.Offset < 0 || static_cast<uint8>(Entry.Op) > static_cast<uint8>(ELifeInvariantOp::Function)) {
+				return false;
+			}
+		}
+
+		for (int32 Index = 0; Index < TableHeader.NumFunctions; ++Index) {
+			if (!IsValidString(TableFunctions[Index].Name, NumStringBytes)) {
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool FLifeInvariantTable::Bind(const uint8* Data, int64 Size)
+	{
+		if (Size < static_cast<int64>(sizeof(FHeader))) {
+			return false;
+		}
+		const FHeader* TableHeader = reinterpret_cast<const FHeader*>(Data);
+		if (TableHeader->Magic != Magic || TableHeader->Version != Version) {
+			return false;
+		}
+		if (TableHeader->NumClasses < 0 || TableHeader->NumEntries < 0 || TableHeader->NumFunctions < 0 || TableHeader->NumStringBytes < 0) {
+			return false;
+		}
+
+		const int64 ClassesOffset = sizeof(FHeader);
+		const int64 EntriesOffset = ClassesOffset + static_cast<int64>(TableHeader->NumClasses) * sizeof(FClass);
+		const int64 FunctionsOffset = EntriesOffset + static_cast<int64>(TableHeader->NumEntries) * sizeof(FEntry);
+		const int64 StringsOffset = FunctionsOffset + static_cast<int64>(TableHeader->NumFunctions) * sizeof(FFunction);
+		if (StringsOffset + TableHeader->NumStringBytes != Size) {
+			return false;
+		}
+
+		if (!ValidateRecords(*TableHeader, reinterpret_cast<const FClass*>(Data + ClassesOffset), reinterpret_cast<const FEntry*>(Data + EntriesOffset),
+			reinterpret_cast<const FFunction*>(Data + FunctionsOffset), reinterpret_cast<const ANSICHAR*>(Data + StringsOffset))) {
+			return false;
+		}
+
+		Header = TableHeader;
+		Classes = reinterpret_cast<const FClass*>(Data + ClassesOffset);
+		Entries = reinterpret_cast<const FEntry*>(Data + EntriesOffset);
+		Functions = reinterpret_cast<const FFunction*>(Data + FunctionsOffset);
+		Strings = reinterpret_cast<const ANSICHAR*>(Data + StringsOffset);
+		return true;
+	}
+
+	const FClass* FLifeInvariantTable::FindClass(const UClass* Class)
+	{
+		if (!Header) {
+			return nullptr;
+		}
+
+		const FString Path = Class->GetPathName();
+		const uint64 PathHash = HashClassPath(Path);
+		const TConstArrayView<FClass> AllClasses(Classes, Header->NumClasses);
+		int32 Index = Algo::LowerBoundBy(AllClasses, PathHash, &FClass::PathHash);
+		for (; Index < AllClasses.Num() && AllClasses[Index].PathHash == PathHash; ++Index) {
+			if (GetString(AllClasses[Index].Path) == Path) {
+				return &AllClasses[Index];
+			}
+		}
+		return nullptr;
+	}
+
+	TConstArrayView<FEntry> FLifeInvariantTable::GetEntries(const FClass& Record)
+	{
+		return TConstArrayView<FEntry>(Entries + Record.FirstEntry, Record.NumEntries);
+	}
+
+	TConstArrayView<FFunction> FLifeInvariantTable::GetFunctions(const FClass& Record)
+	{
+		return TConstArrayView<FFunction>(Functions + Record.FirstFunction, Record.NumFunctions);
+	}
+
+	FString FLifeInvariantTable::GetString(int32 Offset)
+	{
+		return FString(UTF8_TO_TCHAR(Strings + Offset));
+	}
+
+#if WITH_METADATA
+	/** Appends a null-terminated UTF-8 string to the blob and returns its offset. Equal strings are stored once. */
+	static int32 AddTableString(TArray<uint8>& Blob, TMap<FString, int32>& Offsets, const FString& String)
+	{
+		if (const int32* Existing = Offsets.Find(String)) {
+			return *Existing;
+		}
+		const int32 Offset = Blob.Num();
+		const FTCHARToUTF8 Utf8(*String);
+		Blob.Append(reinterpret_cast<const uint8*>(Utf8.Get()), Utf8.Length());
+		Blob.Add(0);
+		Offsets.Add(String, Offset);
+		return Offset;
+	}
+
+	int32 FLifeInvariantTable::Write(const FString& Path)
+	{
+		// Plans must come from metadata, not from the table we're replacing
+		Shutdown();
+		FLifeInvariantPlanCache::Invalidate();
+
+		TArray<FClass> TableClasses;
+		TArray<FEntry> TableEntries;
+		TArray<FFunction> TableFunctions;
+		TArray<uint8> Blob;
+		TMap<FString, int32> StringOffsets;
+
+		for (TObjectIterator<UClass> It; It; ++It) {
+			const UClass* Class = *It;
+			// Stale copies left behind by hot reload and blueprint compiles
+			if (Class->HasAnyClassFlags(CLASS_NewerVersionExists) || Class->GetName().StartsWith(TEXT("SKEL_")) || Class->GetName().StartsWith(TEXT("REINST_"))) {
+				continue;
+			}
+
+			const FLifeInvariantPlan& Plan = FLifeInvariantPlanCache::GetPlan(Class);
+			const bool bHasReflectedFunctions = Plan.Functions.ContainsByPredicate([](const FLifeInvariantFunction& Function) { return Function.Function != nullptr; });
+			if (Plan.Entries.IsEmpty() && !bHasReflectedFunctions) {
+				continue;
+			}
+
+			FClass& Record = TableClasses.AddDefaulted_GetRef();
+			const FString ClassPath = Class->GetPathName();
+			Record.PathHash = HashClassPath(ClassPath);
+			Record.Path = AddTableString(Blob, StringOffsets, ClassPath);
+			Record.FirstEntry = TableEntries.Num();
+			Record.NumEntries = Plan.Entries.Num();
+			Record.FirstFunction = TableFunctions.Num();
+
+			for (const FLifeInvariantEntry& PlanEntry : Plan.Entries) {
+				// Zeroed, so padding doesn't make the file differ between runs
+				FEntry& Entry = TableEntries.AddZeroed_GetRef();
+				Entry.Range = PlanEntry.Range;
+				Entry.PropertyName = AddTableString(Blob, StringOffsets, PlanEntry.Property->GetName());
+				Entry.Offset = PlanEntry.Offset;
+				Entry.Rule = AddTableString(Blob, StringOffsets, PlanEntry.Rule);
+				Entry.Op = PlanEntry.Op;
+				Entry.Kind = PlanEntry.Kind;
+				Entry.ElementKind = PlanEntry.ElementKind;
+				Entry.MapValueKind = PlanEntry.MapValueKind;
+			}
+
+			// Native invariants that no metadata references are found through the registry at runtime
+			for (const FLifeInvariantFunction& Function : Plan.Functions) {
+				if (Function.Function) {
+					TableFunctions.Add({ AddTableString(Blob, StringOffsets, Function.Function->GetName()) });
+				}
+			}
+			Record.NumFunctions = TableFunctions.Num() - Record.FirstFunction;
+		}
+
+		// Plans built here must not outlive the commandlet's view of the classes
+		FLifeInvariantPlanCache::Invalidate();
+
+		Algo::SortBy(TableClasses, &FClass::PathHash);
+
+		FHeader TableHeader;
+		TableHeader.Magic = Magic;
+		TableHeader.Version = Version;
+		TableHeader.NumClasses = TableClasses.Num();
+		TableHeader.NumEntries = TableEntries.Num();
+		TableHeader.NumFunctions = TableFunctions.Num();
+		TableHeader.NumStringBytes = Blob.Num();
+
+		TArray<uint8> Data;
+		Data.Append(reinterpret_cast<const uint8*>(&TableHeader), sizeof(TableHeader));
+		Data.Append(reinterpret_cast<const uint8*>(TableClasses.GetData()), TableClasses.Num() * sizeof(FClass));
+		Data.Append(reinterpret_cast<const uint8*>(TableEntries.GetData()), TableEntries.Num() * sizeof(FEntry));
+		Data.Append(reinterpret_cast<const uint8*>(TableFunctions.GetData()), TableFunctions.Num() * sizeof(FFunction));
+		Data.Append(Blob);
+
+		if (!FFileHelper::SaveArrayToFile(Data, *Path)) {
+			return INDEX_NONE;
+		}
+		return TableClasses.Num();
+	}
+#endif
+}
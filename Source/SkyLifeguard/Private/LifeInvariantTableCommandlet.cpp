@@ -0,0 +1,37 @@
+﻿#include "LifeInvariantTableCommandlet.h"
+
+#include "LifeInvariantTable.h"
+#include "LifeLogChannels.h"
+
+ULifeInvariantTableCommandlet::ULifeInvariantTableCommandlet()
+{
+	IsClient = false;
+	IsEditor = false;
+	IsServer = false;
+	LogToConsole = true;
+
+	HelpDescription = TEXT("Writes the precompiled invariant table from the meta=(Invariant) annotations of every loaded class.");
+	HelpUsage = TEXT("-run=LifeInvariantTable [-Output=<file>]");
+}
+
+int32 ULifeInvariantTableCommandlet::Main(const FString& Params)
+{
+#if WITH_METADATA
+	FString Output;
+	if (!FParse::Value(*Params, TEXT("Output="), Output)) {
+		Output = Debug::FLifeInvariantTable::GetDefaultPath();
+	}
+
+	const int32 NumClasses = Debug::FLifeInvariantTable::Write(Output);
+	if (NumClasses == INDEX_NONE) {
+		UE_LOG(LogLife, Error, TEXT("Can't write %s"), *Output);
+		return 1;
+	}
+
+	UE_LOG(LogLife, Display, TEXT("Wrote the invariant table of %d classes to %s"), NumClasses, *Output);
+	return 0;
+#else
+	UE_LOG(LogLife, Error, TEXT("The invariant table is written from metadata, run this from an editor build"));
+	return 1;
+#endif
+}
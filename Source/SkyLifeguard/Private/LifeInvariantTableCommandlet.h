@@ -0,0 +1,22 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "LifeInvariantTableCommandlet.generated.h"
+
+/**
+ * Writes the precompiled invariant table (see LifeInvariantTable.h) from the metadata of every loaded class. Run it
+ * from an editor build before cooking, and again whenever annotations or annotated properties change.
+ *
+ * Usage: -run=LifeInvariantTable [-Output=<file>]
+ */
+UCLASS()
+class ULifeInvariantTableCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	ULifeInvariantTableCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,38 @@
+﻿#include "LifeStats.h"
+
+#include "HAL/IConsoleManager.h"
+#include "LifeInvariantPlan.h"
+
+DEFINE_STAT(STAT_LifeClassInvariants);
+DEFINE_STAT(STAT_LifeClassInvariantsBatch);
+DEFINE_STAT(STAT_LifeCheckAllInvariants);
+DEFINE_STAT(STAT_LifeDeferredInvariants);
+DEFINE_STAT(STAT_LifeChecklistSteps);
+DEFINE_STAT(STAT_LifeFloodlightReport);
+DEFINE_STAT(STAT_LifeFloodlightTick);
+DEFINE_STAT(STAT_LifeFloodlightOverlay);
+
+DEFINE_STAT(STAT_LifeObjectsChecked);
+DEFINE_STAT(STAT_LifeDeferredPending);
+DEFINE_STAT(STAT_LifeChecklistStepsRun);
+DEFINE_STAT(STAT_LifeFloodlightReports);
+
+UE_TRACE_CHANNEL_DEFINE(LifeguardChannel);
+
+static bool GLifeStatsPerClass = false;
+static FAutoConsoleVariableRef CVarLifeStatsPerClass(
+	TEXT("Lifeguard.Stats.PerClass"),
+	GLifeStatsPerClass,
+	TEXT("If true, the invariant checks of every class are timed under their own cycle stat in STATGROUP_Lifeguard, and traced under the class name on the Lifeguard trace channel."),
+	FConsoleVariableDelegate::CreateLambda([](IConsoleVariable*) {
+		// Stats and trace names are made when plans are built
+		Debug::FLifeInvariantPlanCache::Invalidate();
+	}));
+
+namespace Debug
+{
+	bool IsPerClassStatsEnabled()
+	{
+		return GLifeStatsPerClass;
+	}
+}
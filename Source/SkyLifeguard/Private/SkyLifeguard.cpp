@@ -3,6 +3,10 @@
 #include "SkyLifeguard.h"
 
 #include "LifeFloodlight.h"
+#include "LifeInvariantDeferred.h"
+#include "LifeInvariantFingerprint.h"
+#include "LifeInvariantPlan.h"
+#include "LifeInvariantTable.h"
 
 #define LOCTEXT_NAMESPACE "FSkyLifeguardModule"
 
@@ -17,12 +21,25 @@ void FSkyLifeguardModule::StartupModule()
 	Config.FlashDuration = 2.0f;
 	
 	FLifeDomainErrorFloodlight::Initialize(Config);
+
+	// Before any plan is built, plans of the classes in the table are built from it
+	Debug::FLifeInvariantTable::Initialize();
+	Debug::FLifeInvariantPlanCache::Initialize();
+	Debug::FLifeInvariantFingerprints::Initialize();
+	Debug::FLifeDeferredInvariants::Initialize();
 }
 
 void FSkyLifeguardModule::ShutdownModule()
 {
 	// This function may be called during shutdown to clean up your module.  For modules that support dynamic reloading,
 	// we call this function before unloading the module.
+
+	Debug::FLifeDeferredInvariants::Shutdown();
+	Debug::FLifeInvariantFingerprints::Shutdown();
+	Debug::FLifeInvariantPlanCache::Shutdown();
+	Debug::FLifeInvariantTable::Shutdown();
+	// Flushes the error export and leaves GLog's output device chain
+	FLifeDomainErrorFloodlight::Shutdown();
 }
 
 #undef LOCTEXT_NAMESPACE
@@ -6,8 +6,7 @@
 
 #include "LifeLogChannels.h"
 #include "LifeContracts.h"
-
-#define VERBOSE_CHECKLISTS 1
+#include "LifeStats.h"
 
 /*
  * Checklists are our way to ensure complex systems are initialized in order. Checklists are good and simple, and one
@@ -23,6 +22,9 @@
 
 namespace LifeCheck
 {
+    /** Lifeguard.Checklists.Verbose, logs every step and every checklist done. */
+    SKYLIFEGUARD_API bool IsVerboseEnabled();
+
     // Concept: Type must expose:
     //   static constexpr const TCHAR* ChecklistName;
     //   static constexpr Steps range whose value_type convertible to const TCHAR*.
@@ -34,6 +36,29 @@ namespace LifeCheck
         } &&
         std::ranges::range<decltype(T::Steps)> &&
         std::convertible_to<std::ranges::range_value_t<decltype(T::Steps)>, const TCHAR*>;
+
+    constexpr bool StepNamesEqual(const TCHAR* A, const TCHAR* B)
+    {
+        while (*A != 0 && *A == *B) {
+            ++A;
+            ++B;
+        }
+        return *A == *B;
+    }
+
+    /** Index of Step in Checklist::Steps, INDEX_NONE if it isn't one of them. Evaluated at compile time by the typed API. */
+    template<HasChecklistDefinition Checklist>
+    consteval int32 FindStepIndex(const TCHAR* Step)
+    {
+        int32 Index = 0;
+        for (const TCHAR* Candidate : Checklist::Steps) {
+            if (StepNamesEqual(Candidate, Step)) {
+                return Index;
+            }
+            ++Index;
+        }
+        return INDEX_NONE;
+    }
 }
 
 // EXAMPLE CHECKLIST TO USE AS REFERENCE
@@ -65,7 +90,10 @@ struct FLifeChecklistRegistry
 {
 	struct FLifeChecklistState
 	{
+		FName Name;
 		TArray<FName> Steps;
+		/** "Checklist <Name>: <Step>" per step, the names of the steps' trace scopes. */
+		TArray<FString> TraceNames;
 		int32 LastFinishedStepIndex = INDEX_NONE;
 		bool bIsDone = false;
 	};
@@ -80,13 +108,15 @@ struct FLifeChecklistRegistry
 	void Register()
 	{
         const FName ChecklistFName(Checklist::ChecklistName);
-        if (Checklists.Contains(ChecklistFName)) {
+        if (SlotByName.Contains(ChecklistFName)) {
             return; // Already registered
         }
 
         FLifeChecklistState State;
+        State.Name = ChecklistFName;
         for (const TCHAR* Step : Checklist::Steps) {
             State.Steps.Add(FName(Step));
+            State.TraceNames.Add(FString::Printf(TEXT("Checklist %s: %s"), Checklist::ChecklistName, Step));
         }
 
 #if WITH_EDITOR
@@ -103,86 +133,131 @@ struct FLifeChecklistRegistry
         }
 #endif
 
-        Checklists.Add(ChecklistFName, MoveTemp(State));
+        // Slots are never removed, so the ones handed out by GetSlot stay valid
+        SlotByName.Add(ChecklistFName, States.Add(MoveTemp(State)));
+	}
+
+	/**
+	 * Slot of a registered checklist, for the typed API. Looked up once per checklist type, then it's a static.
+	 */
+	template<LifeCheck::HasChecklistDefinition Checklist>
+	static int32 GetSlot()
+	{
+		static const int32 Slot = Get().FindSlotChecked(FName(Checklist::ChecklistName));
+		return Slot;
+	}
+
+	int32 FindSlotChecked(const FName& ChecklistName) const
+	{
+		const int32* Slot = SlotByName.Find(ChecklistName);
+		checkf(Slot, TEXT("Checklist %s not registered"), *ChecklistName.ToString());
+		return *Slot;
 	}
 
     /** Returns true if the given step is the next expected step for the named checklist. */
     bool CanBeginStep(const FName& ChecklistName, const FName& StepName) const
     {
-		checkf(Checklists.Contains(ChecklistName), TEXT("Checklist %s not registered"), *ChecklistName.ToString())
-		
-        const FLifeChecklistState* State = Checklists.Find(ChecklistName);
+        const FLifeChecklistState& State = States[FindSlotChecked(ChecklistName)];
         
-        const int32 ExpectedIndex = State->LastFinishedStepIndex + 1;
-        if (ExpectedIndex < 0 || ExpectedIndex >= State->Steps.Num()) {
+        const int32 ExpectedIndex = State.LastFinishedStepIndex + 1;
+        if (ExpectedIndex < 0 || ExpectedIndex >= State.Steps.Num()) {
             return false;
         }
 		
-        return State->Steps[ExpectedIndex] == StepName;
+        return State.Steps[ExpectedIndex] == StepName;
     }
 
+	/** Typed API version, an integer compare. */
+	bool CanBeginStep(int32 Slot, int32 StepIndex) const
+	{
+		return States[Slot].LastFinishedStepIndex + 1 == StepIndex;
+	}
+
+	/** Trace scope name of a step, null if it's not one of the checklist's steps. */
+	const TCHAR* GetStepTraceName(const FName& ChecklistName, const FName& StepName) const
+	{
+		const FLifeChecklistState& State = States[FindSlotChecked(ChecklistName)];
+		const int32 StepIndex = State.Steps.IndexOfByKey(StepName);
+		return StepIndex != INDEX_NONE ? *State.TraceNames[StepIndex] : nullptr;
+	}
+
+	const TCHAR* GetStepTraceName(int32 Slot, int32 StepIndex) const
+	{
+		return *States[Slot].TraceNames[StepIndex];
+	}
+
 	/** Returns true if the given step has already been completed for the named checklist. */
     bool IsStepDone(const FName& ChecklistName, const FName& StepName) const
     {
-        checkf(Checklists.Contains(ChecklistName), TEXT("Checklist %s not registered"), *ChecklistName.ToString())
-
-        const FLifeChecklistState* State = Checklists.Find(ChecklistName);
-        const int32 StepIndex = State->Steps.IndexOfByKey(StepName);
+        const int32 Slot = FindSlotChecked(ChecklistName);
+        const int32 StepIndex = States[Slot].Steps.IndexOfByKey(StepName);
         if (StepIndex == INDEX_NONE) {
             return false;
         }
-        // A step is considered done if its index is <= CurrentIndex or if the checklist is done
-        return ((State->LastFinishedStepIndex != INDEX_NONE) && (StepIndex <= State->LastFinishedStepIndex)) || State->bIsDone;
+        return IsStepDone(Slot, StepIndex);
     }
 
+	bool IsStepDone(int32 Slot, int32 StepIndex) const
+	{
+		const FLifeChecklistState& State = States[Slot];
+		// A step is considered done if its index is <= CurrentIndex or if the checklist is done
+		return ((State.LastFinishedStepIndex != INDEX_NONE) && (StepIndex <= State.LastFinishedStepIndex)) || State.bIsDone;
+	}
+
 	/** Returns true if the named checklist is fully completed. */
     bool IsChecklistDone(const FName& ChecklistName) const
     {
-		checkf(Checklists.Find(ChecklistName), TEXT("Checklist %s not registered"), *ChecklistName.ToString())
-		
-		const auto* const State = Checklists.Find(ChecklistName);
-        return State->bIsDone;
+		return States[FindSlotChecked(ChecklistName)].bIsDone;
     }
 
     /** Returns the last completed step name, or the strings "not started" / "completed". */
     FString GetLastCompletedStepName(const FName& ChecklistName) const
     {
-        checkf(Checklists.Find(ChecklistName), TEXT("Checklist %s not registered"), *ChecklistName.ToString())
+        return GetLastCompletedStepName(FindSlotChecked(ChecklistName));
+    }
 
-        const FLifeChecklistState* State = Checklists.Find(ChecklistName);
+	FString GetLastCompletedStepName(int32 Slot) const
+	{
+        const FLifeChecklistState& State = States[Slot];
 
-        if (State->bIsDone) {
+        if (State.bIsDone) {
             return FString(TEXT("completed"));
         }
 
-        if (State->LastFinishedStepIndex == INDEX_NONE) {
+        if (State.LastFinishedStepIndex == INDEX_NONE) {
             return FString(TEXT("not started"));
         }
 
         // Guard against out-of-range indexes
-        if (State->LastFinishedStepIndex >= 0 && State->LastFinishedStepIndex < State->Steps.Num()) {
-            return State->Steps[State->LastFinishedStepIndex].ToString();
+        if (State.LastFinishedStepIndex >= 0 && State.LastFinishedStepIndex < State.Steps.Num()) {
+            return State.Steps[State.LastFinishedStepIndex].ToString();
         }
 
         return FString(TEXT("invalid"));
-    }
+	}
 
 	/** Mark the named checklist as done. */
     void SetChecklistDone(const FName& ChecklistName)
     {
-		LG_PRECOND(Checklists.Find(ChecklistName))
+		LG_PRECOND(SlotByName.Find(ChecklistName))
 		
-        FLifeChecklistState* State = Checklists.Find(ChecklistName);
-        State->bIsDone = true;
-
-#if VERBOSE_CHECKLISTS
-		UE_LOG(LogLife, Log, TEXT("Checklist %s done"), *ChecklistName.ToString());
-#endif
+        SetChecklistDone(FindSlotChecked(ChecklistName));
     }
 
+	void SetChecklistDone(int32 Slot)
+	{
+		FLifeChecklistState& State = States[Slot];
+		State.bIsDone = true;
+
+		if (LifeCheck::IsVerboseEnabled()) {
+			UE_LOG(LogLife, Log, TEXT("Checklist %s done"), *State.Name.ToString());
+		}
+	}
+
 	void CheckStep(const FName& ChecklistName, const FName& StepName)
 	{
-		auto& State = Checklists[ChecklistName];
+		const int32 Slot = FindSlotChecked(ChecklistName);
+		const FLifeChecklistState& State = States[Slot];
 		const int32 ExpectedIndex = State.LastFinishedStepIndex + 1;
 		if (State.Steps[ExpectedIndex] != StepName) {
 			UE_LOG(LogLife, Fatal, TEXT("Checklist %s: expected '%s' but got '%s'"),
@@ -190,39 +265,60 @@ struct FLifeChecklistRegistry
 				*State.Steps[ExpectedIndex].ToString(),
 				*StepName.ToString());
 		}
+		CheckStep(Slot, ExpectedIndex);
+	}
+
+	/** Typed API version: an array index and an integer compare, names are only read on failure. */
+	void CheckStep(int32 Slot, int32 StepIndex)
+	{
+		FLifeChecklistState& State = States[Slot];
+		const int32 ExpectedIndex = State.LastFinishedStepIndex + 1;
+		if (UNLIKELY(ExpectedIndex != StepIndex)) {
+			UE_LOG(LogLife, Fatal, TEXT("Checklist %s: expected '%s' but got '%s'"),
+				*State.Name.ToString(),
+				State.Steps.IsValidIndex(ExpectedIndex) ? *State.Steps[ExpectedIndex].ToString() : TEXT("<none>"),
+				*State.Steps[StepIndex].ToString());
+		}
 		State.LastFinishedStepIndex++;
 
-#if VERBOSE_CHECKLISTS
-		UE_LOG(LogLife, Log, TEXT("Checklist %s advanced to step %s [%2d/%2d]"), *ChecklistName.ToString(), *StepName.ToString(), State.LastFinishedStepIndex, State.Steps.Num());
-#endif
+		if (LifeCheck::IsVerboseEnabled()) {
+			UE_LOG(LogLife, Log, TEXT("Checklist %s advanced to step %s [%2d/%2d]"), *State.Name.ToString(), *State.Steps[StepIndex].ToString(), State.LastFinishedStepIndex, State.Steps.Num());
+		}
 
 		// If we just completed the last step, mark checklist done.
         if (State.LastFinishedStepIndex == State.Steps.Num() - 1) {
-            SetChecklistDone(ChecklistName);
+            SetChecklistDone(Slot);
         }
 	}
 
+	/** Crashes with the "cannot begin step" message, kept out of line so the typed scope's happy path stays small. */
+	FORCENOINLINE void FailBeginStep(int32 Slot, int32 StepIndex) const
+	{
+		const FLifeChecklistState& State = States[Slot];
+		UE_LOG(LogLife, Fatal, TEXT("Checklist %s: cannot begin step %s - checklist is at step [%s]"),
+			*State.Name.ToString(), *State.Steps[StepIndex].ToString(), *GetLastCompletedStepName(Slot));
+	}
+
 	/** Reset a single checklist (clears progress). Useful when starting a new PIE session. */
 	void ResetChecklist(const FName& ChecklistName)
 	{
-		checkf(Checklists.Contains(ChecklistName), TEXT("Checklist %s not registered"), *ChecklistName.ToString())
-
-		FLifeChecklistState* State = Checklists.Find(ChecklistName);
-		State->LastFinishedStepIndex = INDEX_NONE;
-		State->bIsDone = false;
+		FLifeChecklistState& State = States[FindSlotChecked(ChecklistName)];
+		State.LastFinishedStepIndex = INDEX_NONE;
+		State.bIsDone = false;
 	}
 
 	/** Reset all registered checklists (intended for PIE session reset). */
 	void ResetAllForPie()
 	{
-		for (auto& Pair : Checklists) {
-			Pair.Value.LastFinishedStepIndex = INDEX_NONE;
-			Pair.Value.bIsDone = false;
+		for (FLifeChecklistState& State : States) {
+			State.LastFinishedStepIndex = INDEX_NONE;
+			State.bIsDone = false;
 		}
 	}
 	
 private:
-	TMap<FName, FLifeChecklistState> Checklists;
+	TArray<FLifeChecklistState> States;
+	TMap<FName, int32> SlotByName;
 };
 
 /**
@@ -232,20 +328,58 @@ struct FLifeChecklistScope
 {
 	FLifeChecklistScope(const FName& InChecklistName, const FName& InStepName)
 		: ChecklistName(InChecklistName), StepName(InStepName)
+		, TraceScope(FLifeTraceScope::IsEnabled() ? FLifeChecklistRegistry::Get().GetStepTraceName(InChecklistName, InStepName) : nullptr)
 	{
-		checkf(FLifeChecklistRegistry::Get().CanBeginStep(ChecklistName, StepName), 
-			TEXT("Checklist %s: cannot begin step %s - checklist is at step [%s]"), 
-			*ChecklistName.ToString(), *StepName.ToString(),
-			*FLifeChecklistRegistry::Get().GetLastCompletedStepName(ChecklistName))
+		SCOPE_CYCLE_COUNTER(STAT_LifeChecklistSteps);
+		INC_DWORD_STAT(STAT_LifeChecklistStepsRun);
+		LG_CHECK_LAZY(FLifeChecklistRegistry::Get().CanBeginStep(ChecklistName, StepName), [this]() {
+			return FString::Printf(TEXT("Checklist %s: cannot begin step %s - checklist is at step [%s]"),
+				*ChecklistName.ToString(), *StepName.ToString(),
+				*FLifeChecklistRegistry::Get().GetLastCompletedStepName(ChecklistName));
+		});
 	}
 
 	~FLifeChecklistScope()
 	{
+		SCOPE_CYCLE_COUNTER(STAT_LifeChecklistSteps);
 		FLifeChecklistRegistry::Get().CheckStep(ChecklistName, StepName);
 	}
 	
 	FName ChecklistName;
 	FName StepName;
+	/** Spans the whole step in captures of the Lifeguard trace channel. */
+	FLifeTraceScope TraceScope;
+};
+
+/**
+ * Typed version of FLifeChecklistScope. The step index is a template argument resolved at compile time and the
+ * checklist slot is resolved on first use, so entering and leaving the step is an array index plus an integer compare.
+ */
+template<LifeCheck::HasChecklistDefinition Checklist, int32 StepIndex>
+struct TLifeChecklistScope
+{
+	static_assert(StepIndex != INDEX_NONE, "Step is not one of the checklist's Steps");
+
+	TLifeChecklistScope()
+		: Slot(FLifeChecklistRegistry::GetSlot<Checklist>())
+		, TraceScope(FLifeTraceScope::IsEnabled() ? FLifeChecklistRegistry::Get().GetStepTraceName(Slot, StepIndex) : nullptr)
+	{
+		SCOPE_CYCLE_COUNTER(STAT_LifeChecklistSteps);
+		INC_DWORD_STAT(STAT_LifeChecklistStepsRun);
+		const FLifeChecklistRegistry& Registry = FLifeChecklistRegistry::Get();
+		if (UNLIKELY(!Registry.CanBeginStep(Slot, StepIndex))) {
+			Registry.FailBeginStep(Slot, StepIndex);
+		}
+	}
+
+	~TLifeChecklistScope()
+	{
+		SCOPE_CYCLE_COUNTER(STAT_LifeChecklistSteps);
+		FLifeChecklistRegistry::Get().CheckStep(Slot, StepIndex);
+	}
+
+	int32 Slot;
+	FLifeTraceScope TraceScope;
 };
 
 // Internal helpers to enforce acceptable arguments for LG_SCOPED_CHECKLIST_STEP.
@@ -277,15 +411,21 @@ inline FName LifeChecklistToFName(const TCHAR* Str) { return FName(Str); }
     LifeRequireChecklistArg(StepArg); \
     FLifeChecklistScope LIFE_CHECK_CONCAT(ChecklistScope_, __LINE__){ LifeChecklistToFName(ChecklistArg), LifeChecklistToFName(StepArg) }
 
+// Typed usage, the step is a member of the checklist struct and a typo doesn't compile:
+//   LG_SCOPED_CHECKLIST_STEP_T(FLoadWorldChecklist, LoadWorldJson);
+#define LG_SCOPED_CHECKLIST_STEP_T(Checklist, Step) \
+    TLifeChecklistScope<Checklist, LifeCheck::FindStepIndex<Checklist>(Checklist::Step)> LIFE_CHECK_CONCAT(ChecklistScope_, __LINE__)
+
 #define LG_RESET_CHECKLIST(ChecklistArg) \
 	LifeRequireChecklistArg(ChecklistArg); \
 	FLifeChecklistRegistry::Get().ResetChecklist(LifeChecklistToFName(ChecklistArg));
 
 #define LG_ENSURE_CHECKLIST_DONE(ChecklistArg) \
     LifeRequireChecklistArg(ChecklistArg); \
-    LG_CONTRACT_CHECK_MSG( \
+    LG_CONTRACT_CHECK_LAZY( \
         FLifeChecklistRegistry::Get().IsChecklistDone(LifeChecklistToFName(ChecklistArg)), \
-        FString::Printf(TEXT("Checklist '%s' not done (current: %s)"), \
-            *LifeChecklistToFName(ChecklistArg).ToString(), \
-            *FLifeChecklistRegistry::Get().GetLastCompletedStepName(LifeChecklistToFName(ChecklistArg))) \
-    )
\ No newline at end of file
+        [&]() { \
+            return FString::Printf(TEXT("Checklist '%s' not done (current: %s)"), \
+                *LifeChecklistToFName(ChecklistArg).ToString(), \
+                *FLifeChecklistRegistry::Get().GetLastCompletedStepName(LifeChecklistToFName(ChecklistArg))); \
+        })
\ No newline at end of file
@@ -1,10 +1,89 @@
-#pragma once
+﻿#pragma once
 
+#include "CoreMinimal.h"
 #include "Misc/ScopeExit.h"
 
 #define LG_TEST_CHECK(Expr) checkf((Expr), TEXT("Test failure: [%s] @ [%hs:%d]"), TEXT(#Expr), __FUNCTION__, __LINE__)
 #define LG_CONTRACT_CHECK(Expr) checkf((Expr), TEXT("Architecture violation: [%s] @ [%hs:%d]"), TEXT(#Expr), __FUNCTION__, __LINE__)
-#define LG_CONTRACT_CHECK_MSG(Expr, Msg) checkf((Expr), TEXT("Contract violation (%s): [%s] @ [%hs:%d]"), *FString(Msg), TEXT(#Expr), __FUNCTION__, __LINE__)
+#define LG_CONTRACT_CHECK_MSG(Expr, Msg) LG_CONTRACT_CHECK_LAZY(Expr, [&]() { return Msg; })
+
+namespace Debug
+{
+#if WITH_DEV_AUTOMATION_TESTS
+	/**
+	 * While set, failed LG_CHECK_LAZY and LG_CONTRACT_CHECK_LAZY checks (LG_PRECOND, LG_INVARIANT, ...) and class
+	 * invariant violations on the game thread pass their message to the hook and go on instead of asserting. For
+	 * automation tests of failure messages only.
+	 */
+	SKYLIFEGUARD_API void SetCheckFailureHook(TFunction<void(const FString&)> Hook);
+	SKYLIFEGUARD_API bool InterceptCheckFailure(const FString& Message);
+#endif
+
+	namespace Private
+	{
+		/**
+		 * Failing branch of LG_CHECK_LAZY, the message is only formatted here. Like checkf, returns true if the caller
+		 * should break into the debugger.
+		 */
+		template<typename TFormatter>
+		FORCENOINLINE bool FailCheck(const ANSICHAR* Expr, const ANSICHAR* File, int32 Line, const TFormatter& Formatter)
+		{
+			const FString Message(Formatter());
+#if WITH_DEV_AUTOMATION_TESTS
+			if (InterceptCheckFailure(Message)) {
+				return false;
+			}
+#endif
+			return FDebug::CheckVerifyFailedImpl2(Expr, File, Line, TEXT("%s"), *Message);
+		}
+
+		/** Failing branch of LG_CONTRACT_CHECK_LAZY. */
+		template<typename TFormatter>
+		FORCENOINLINE bool FailContract(const ANSICHAR* Expr, const ANSICHAR* File, const ANSICHAR* Function, int32 Line, const TFormatter& Formatter)
+		{
+			const FString Message = FString::Printf(TEXT("Contract violation (%s): [%hs] @ [%hs:%d]"), *FString(Formatter()), Expr, Function, Line);
+#if WITH_DEV_AUTOMATION_TESTS
+			if (InterceptCheckFailure(Message)) {
+				return false;
+			}
+#endif
+			return FDebug::CheckVerifyFailedImpl2(Expr, File, Line, TEXT("%s"), *Message);
+		}
+	}
+}
+
+#if DO_CHECK
+/**
+ * checkf with a message built only on failure. The message is a callable returning an FString or a TCHAR string, e.g.
+ * LG_CHECK_LAZY(Index < Num, [&] { return FString::Printf(TEXT("Index %d of %d"), Index, Num); }). The passing path is
+ * the test of Expr and nothing else, whatever the message captures or formats. Fails like checkf: the assert goes
+ * through FDebug::CheckVerifyFailedImpl2 and an attached debugger breaks at the failing line. Compiled out without
+ * DO_CHECK.
+ */
+#define LG_CHECK_LAZY(Expr, ...) \
+	{ \
+		if (UNLIKELY(!(Expr))) { \
+			if (Debug::Private::FailCheck(#Expr, __FILE__, __LINE__, __VA_ARGS__)) { \
+				PLATFORM_BREAK(); \
+			} \
+			CA_ASSUME(false); \
+		} \
+	}
+
+/** LG_CONTRACT_CHECK_MSG with a message built only on failure, see LG_CHECK_LAZY. */
+#define LG_CONTRACT_CHECK_LAZY(Expr, ...) \
+	{ \
+		if (UNLIKELY(!(Expr))) { \
+			if (Debug::Private::FailContract(#Expr, __FILE__, __FUNCTION__, __LINE__, __VA_ARGS__)) { \
+				PLATFORM_BREAK(); \
+			} \
+			CA_ASSUME(false); \
+		} \
+	}
+#else
+#define LG_CHECK_LAZY(Expr, ...) { CA_ASSUME(Expr); }
+#define LG_CONTRACT_CHECK_LAZY(Expr, ...) { CA_ASSUME(Expr); }
+#endif
 
 /**
  * Check a precondition: something that should be true at the beginning of some scope.
@@ -74,12 +153,11 @@
  * - Invariant=FunctionName - with signature bool FunctionName() const inside the class
  * - Invariant=Contract* - a pointer which must be valid, and which must also pass invariant validation
  *
- * Be careful with Invariant=Contract*. If you have the same class requiring the same class you get into an infinite
- * loop, but also if you get dupes at any level of the hierarchy so A - requires not null A = infinite loop, but also
- * A - requires not null B (that requires not null A) = also infinite loop.
- * This is not an error in the validation layer! This is an actual logic error. If any hierarchy has at least one loop
- * of MemSafe invariants then the invariants cannot possibly hold. Any class hierarchy that has a loop must have a
- * non-invariant, maybe null reference.
+ * Invariant=Contract* references are followed with an explicit stack, and each object is checked at most once per
+ * check (or per batch, or per Lifeguard.CheckAllInvariants sweep), so sub-objects shared by many parents cost one check.
+ * A loop of Contract* references, A -> B -> A, is a violation reported with the full path. This is not an error in the
+ * validation layer! This is an actual logic error: any hierarchy that has a loop must have a non-invariant, maybe null
+ * reference.
  * 
  * On a 10-year old Intel i7, the average time per full class invariant check on an object with 75 invariants
  * is 0.000024s or 24 microseconds.
@@ -87,8 +165,43 @@
  * @param Object - The object with an invariant contract. 
  */
 #define LG_CLASS_INVARIANTS(Object) Debug::CheckClassInvariants(Object);
+
+/**
+ * Checks the class invariants of a whole population of objects (all pawns, all projectiles, ...) at once. Same rules as
+ * LG_CLASS_INVARIANTS, but the objects are grouped by class and each invariant is run across every object of a class
+ * before the next one, which is much kinder to the cache than checking one object at a time.
+ *
+ * @param Objects - A TArray of UObject (or derived) pointers, or a TArrayView<const UObject*>.
+ */
+#define LG_CLASS_INVARIANTS_BATCH(Objects) Debug::CheckClassInvariantsBatch(Objects);
+
+/**
+ * Same checks as LG_CLASS_INVARIANTS, but queued and run over the next frames within a time budget, for BeginPlay and
+ * spawn paths where hundreds of objects may show up in one frame. A failure names the call site of the macro. See
+ * LifeInvariantDeferred.h.
+ *
+ * @param Object - The object with an invariant contract. Objects collected before their turn are not checked.
+ */
+#define LG_CLASS_INVARIANTS_DEFERRED(Object) Debug::DeferClassInvariants(Object, Debug::FLifeInvariantCallSite{ __FUNCTION__, __FILE__, __LINE__ });
+
+/**
+ * Binds a native `bool Function() const` member of Class as an invariant, called directly instead of through
+ * ProcessEvent. Put it at file scope in a .cpp, the function must be accessible from there. The function doesn't need to
+ * be a UFUNCTION.
+ *
+ * Once registered, the function backs any Invariant=Function property of Class (and its subclasses) and a UFUNCTION of
+ * the same name with meta=(Invariant). If nothing references it, it runs as a class level invariant, like an invariant
+ * UFUNCTION would. Blueprint functions keep going through ProcessEvent.
+ *
+ *	LG_REGISTER_NATIVE_INVARIANT(AHeroCharacter, ValidateWeaponSetup)
+ */
+#define LG_REGISTER_NATIVE_INVARIANT(Class, Function) \
+	static const Debug::TLifeNativeInvariantRegistrar<Class, &Class::Function> GLifeNativeInvariant_##Class##_##Function(TEXT(#Function));
 #else
 #define LG_CLASS_INVARIANTS(Object)
+#define LG_CLASS_INVARIANTS_BATCH(Objects)
+#define LG_CLASS_INVARIANTS_DEFERRED(Object)
+#define LG_REGISTER_NATIVE_INVARIANT(Class, Function)
 #endif
 
 /**
@@ -142,10 +255,80 @@ namespace Debug
     }    
 
     /**
-     * Iterate through all UPROPERTY and UFUNCTION fields. If any is marked meta=(Invariant) then check it.
+     * Check every UPROPERTY and UFUNCTION field marked meta=(Invariant). The fields are read from reflection once per
+     * class and cached as an invariant plan (see LifeInvariantPlan.h), so repeated checks don't touch metadata.
      * 
      * @param Object The object for which we want to check the invariants
      */
     SKYLIFEGUARD_API void CheckClassInvariants(const UObject* Object);
+
+    /** Where a deferred check was asked for. The strings are __FUNCTION__ and __FILE__, they live forever. */
+    struct FLifeInvariantCallSite
+    {
+        const ANSICHAR* Function = "";
+        const ANSICHAR* File = "";
+        int32 Line = 0;
+    };
+
+    /**
+     * Queues a class invariants check of the object, see LG_CLASS_INVARIANTS_DEFERRED.
+     *
+     * @param Object The object to check once its turn comes.
+     * @param Site Reported with any failure of the check.
+     */
+    SKYLIFEGUARD_API void DeferClassInvariants(const UObject* Object, const FLifeInvariantCallSite& Site);
+
+    /**
+     * Check the invariants of many objects. Objects are grouped by class (in order of first appearance) and every
+     * invariant of a class runs across all of its objects before moving on to the next invariant. Reports the same
+     * violations as calling CheckClassInvariants on each object.
+     *
+     * @param Objects The objects to check. None of them may be null.
+     */
+    SKYLIFEGUARD_API void CheckClassInvariantsBatch(TArrayView<const UObject*> Objects);
+
+    /**
+     * Check the invariants of every live object whose class has any (the Lifeguard.CheckAllInvariants command).
+     * Objects whose plans are pure field reads are checked on task graph workers; Contract* and custom function
+     * invariants stay on the game thread. Worker failures are all logged in a deterministic order after the join,
+     * then the first one is reported like any other invariant violation. Game thread only.
+     *
+     * @param bParallel False runs everything on the calling thread, e.g. to compare timings.
+     * @return The number of objects checked.
+     */
+    SKYLIFEGUARD_API int32 CheckAllClassInvariants(bool bParallel = true);
+
+    /** Direct call into a native invariant function. */
+    using FLifeNativeInvariantFunc = bool (*)(const UObject* Object);
+
+    /**
+     * Registers a native invariant function, see LG_REGISTER_NATIVE_INVARIANT. Safe to call during static
+     * initialization: the class is only resolved (through GetClass) when plans are built.
+     */
+    SKYLIFEGUARD_API void RegisterNativeInvariant(UClass* (*GetClass)(), const TCHAR* FunctionName, FLifeNativeInvariantFunc Function);
+
+    /** Registers a member function pointer at static initialization. Used by LG_REGISTER_NATIVE_INVARIANT. */
+    template<typename T, bool (T::*Function)() const>
+    struct TLifeNativeInvariantRegistrar
+    {
+        static bool Call(const UObject* Object) { return (static_cast<const T*>(Object)->*Function)(); }
+
+        explicit TLifeNativeInvariantRegistrar(const TCHAR* FunctionName)
+        {
+            RegisterNativeInvariant(&T::StaticClass, FunctionName, &Call);
+        }
+    };
+
+    /**
+     * Convenience overload for arrays of derived pointers (TArray<APawn*>, ...), which don't convert to a view of
+     * const UObject* on their own.
+     */
+    template<typename TObjectType>
+    void CheckClassInvariantsBatch(const TArray<TObjectType*>& Objects)
+    {
+        static_assert(TIsDerivedFrom<std::remove_cv_t<TObjectType>, UObject>::Value, "CheckClassInvariantsBatch only accepts UObject pointers");
+        // UObject is always the first base, so the pointers are the same bits
+        CheckClassInvariantsBatch(TArrayView<const UObject*>(const_cast<const UObject**>(reinterpret_cast<const UObject* const*>(Objects.GetData())), Objects.Num()));
+    }
 }
 
@@ -0,0 +1,299 @@
+﻿#pragma once
+
+#include <array>
+#include <atomic>
+
+#include "LifeChecklist.h"
+#include "Misc/ScopeLock.h"
+
+/*
+ * DAG checklists are checklists for init pipelines that run independent steps in parallel. Instead of a total order,
+ * every step lists the steps it depends on. Steps may begin and complete concurrently on any thread, and beginning a
+ * step whose prerequisites aren't all done is still a crash.
+ *
+ * Step states are bits in two atomic masks (started, done), so a checklist holds up to 64 steps and beginning or
+ * completing a step is one atomic read-modify-write. Prerequisites must be listed before the steps that need them,
+ * which makes cycles impossible, and they're resolved to bit masks at compile time.
+ */
+
+namespace LifeCheck
+{
+    static constexpr int32 MaxDagPrerequisites = 8;
+    static constexpr int32 MaxDagSteps = 64;
+
+    struct FDagStep
+    {
+        const TCHAR* Name;
+        std::array<const TCHAR*, MaxDagPrerequisites> Prerequisites{};
+    };
+
+    // Concept: Type must expose:
+    //   static constexpr const TCHAR* ChecklistName;
+    //   static constexpr Steps range of FDagStep.
+    template<typename T>
+    concept HasDagChecklistDefinition =
+        requires {
+            { T::ChecklistName } -> std::convertible_to<const TCHAR*>;
+            { T::Steps };
+        } &&
+        std::ranges::range<decltype(T::Steps)> &&
+        std::same_as<std::remove_cv_t<std::ranges::range_value_t<decltype(T::Steps)>>, FDagStep>;
+
+    template<HasDagChecklistDefinition Checklist>
+    constexpr int32 FindDagStepIndex(const TCHAR* Step)
+    {
+        int32 Index = 0;
+        for (const FDagStep& Candidate : Checklist::Steps) {
+            if (StepNamesEqual(Candidate.Name, Step)) {
+                return Index;
+            }
+            ++Index;
+        }
+        return INDEX_NONE;
+    }
+
+    /** True if every prerequisite is a step listed before the one that needs it. */
+    template<HasDagChecklistDefinition Checklist>
+    constexpr bool AreDagPrerequisitesOrdered()
+    {
+        int32 Index = 0;
+        for (const FDagStep& Step : Checklist::Steps) {
+            for (const TCHAR* Prerequisite : Step.Prerequisites) {
+                if (Prerequisite) {
+                    const int32 PrerequisiteIndex = FindDagStepIndex<Checklist>(Prerequisite);
+                    if (PrerequisiteIndex == INDEX_NONE || PrerequisiteIndex >= Index) {
+                        return false;
+                    }
+                }
+            }
+            ++Index;
+        }
+        return true;
+    }
+
+    template<HasDagChecklistDefinition Checklist>
+    constexpr auto BuildDagPrerequisiteMasks()
+    {
+        std::array<uint64, std::size(Checklist::Steps)> Masks{};
+        for (size_t Index = 0; Index < Masks.size(); ++Index) {
+            for (const TCHAR* Prerequisite : Checklist::Steps[Index].Prerequisites) {
+                if (Prerequisite) {
+                    Masks[Index] |= 1ull << FindDagStepIndex<Checklist>(Prerequisite);
+                }
+            }
+        }
+        return Masks;
+    }
+}
+
+// EXAMPLE DAG CHECKLIST TO USE AS REFERENCE
+// struct FInitEnginesDagChecklist
+// {
+//     static constexpr const TCHAR* ChecklistName = TEXT("InitEngines");
+//
+//     static constexpr const TCHAR* InitAtlas  = TEXT("init-atlas");
+//     static constexpr const TCHAR* InitDomi   = TEXT("init-domi");
+//     static constexpr const TCHAR* InitMaster = TEXT("init-master");
+//
+//     // Atlas and Domi may run in parallel, Master needs both
+//     static constexpr std::array<LifeCheck::FDagStep, 3> Steps = {{
+//         { InitAtlas },
+//         { InitDomi },
+//         { InitMaster, { InitAtlas, InitDomi } }
+//     }};
+// };
+
+/**
+ * Progress of one DAG checklist. Only the masks change after registration, so any thread can use it.
+ */
+struct FLifeDagChecklistState
+{
+	FName Name;
+	TArray<FName> Steps;
+	/** "Checklist <Name>: <Step>" per step, the names of the steps' trace scopes. */
+	TArray<FString> TraceNames;
+	TArray<uint64> PrerequisiteMasks;
+	uint64 AllStepsMask = 0;
+
+	std::atomic<uint64> StartedMask{0};
+	std::atomic<uint64> DoneMask{0};
+
+	void BeginStep(int32 StepIndex)
+	{
+		const uint64 Bit = 1ull << StepIndex;
+		const uint64 Missing = PrerequisiteMasks[StepIndex] & ~DoneMask.load(std::memory_order_acquire);
+		if (UNLIKELY(Missing != 0)) {
+			UE_LOG(LogLife, Fatal, TEXT("Checklist %s: cannot begin step %s - prerequisites not done [%s]"),
+				*Name.ToString(), *Steps[StepIndex].ToString(), *DescribeSteps(Missing));
+		}
+		if (UNLIKELY((StartedMask.fetch_or(Bit, std::memory_order_acq_rel) & Bit) != 0)) {
+			UE_LOG(LogLife, Fatal, TEXT("Checklist %s: step %s began twice"), *Name.ToString(), *Steps[StepIndex].ToString());
+		}
+	}
+
+	void CompleteStep(int32 StepIndex)
+	{
+		const uint64 Bit = 1ull << StepIndex;
+		const uint64 Previous = DoneMask.fetch_or(Bit, std::memory_order_acq_rel);
+
+		if (LifeCheck::IsVerboseEnabled()) {
+			UE_LOG(LogLife, Log, TEXT("Checklist %s completed step %s [%2d/%2d]"), *Name.ToString(), *Steps[StepIndex].ToString(),
+				FMath::CountBits(Previous | Bit), Steps.Num());
+			// Only the thread that completes the last step sees the transition
+			if ((Previous | Bit) == AllStepsMask && Previous != AllStepsMask) {
+				UE_LOG(LogLife, Log, TEXT("Checklist %s done"), *Name.ToString());
+			}
+		}
+	}
+
+	bool IsStepDone(int32 StepIndex) const
+	{
+		return (DoneMask.load(std::memory_order_acquire) & (1ull << StepIndex)) != 0;
+	}
+
+	bool IsDone() const
+	{
+		return DoneMask.load(std::memory_order_acquire) == AllStepsMask;
+	}
+
+	/** Not thread safe against steps in flight, reset between runs of the pipeline. */
+	void Reset()
+	{
+		StartedMask.store(0, std::memory_order_release);
+		DoneMask.store(0, std::memory_order_release);
+	}
+
+	/** Comma separated names of the steps in Mask, for the crash messages. */
+	FString DescribeSteps(uint64 Mask) const
+	{
+		FString Result;
+		for (int32 Index = 0; Index < Steps.Num(); ++Index) {
+			if ((Mask & (1ull << Index)) != 0) {
+				Result += Result.IsEmpty() ? Steps[Index].ToString() : TEXT(", ") + Steps[Index].ToString();
+			}
+		}
+		return Result;
+	}
+};
+
+/**
+ * Registry of DAG checklists. Registration and name lookups take a lock, they happen at startup and once per checklist
+ * type. Steps only touch their checklist's atomic masks.
+ */
+struct FLifeDagChecklistRegistry
+{
+	static FLifeDagChecklistRegistry& Get()
+	{
+		static FLifeDagChecklistRegistry Instance;
+		return Instance;
+	}
+
+	template<LifeCheck::HasDagChecklistDefinition Checklist>
+	void Register()
+	{
+		static_assert(std::size(Checklist::Steps) <= LifeCheck::MaxDagSteps, "DAG checklists hold up to 64 steps");
+		static_assert(LifeCheck::AreDagPrerequisitesOrdered<Checklist>(),
+			"Every prerequisite must be a step of the checklist listed before the step that needs it");
+		static constexpr auto Masks = LifeCheck::BuildDagPrerequisiteMasks<Checklist>();
+
+		FScopeLock Lock(&Mutex);
+
+		const FName ChecklistFName(Checklist::ChecklistName);
+		if (SlotByName.Contains(ChecklistFName)) {
+			return; // Already registered
+		}
+
+		// Boxed, states are handed out by pointer and hold atomics
+		TUniquePtr<FLifeDagChecklistState> State = MakeUnique<FLifeDagChecklistState>();
+		State->Name = ChecklistFName;
+		for (int32 Index = 0; Index < static_cast<int32>(Masks.size()); ++Index) {
+			State->Steps.Add(FName(Checklist::Steps[Index].Name));
+			State->TraceNames.Add(FString::Printf(TEXT("Checklist %s: %s"), Checklist::ChecklistName, Checklist::Steps[Index].Name));
+			State->PrerequisiteMasks.Add(Masks[Index]);
+			State->AllStepsMask |= 1ull << Index;
+		}
+
+		SlotByName.Add(ChecklistFName, States.Add(MoveTemp(State)));
+	}
+
+	/** State of a registered checklist, looked up once per checklist type. */
+	template<LifeCheck::HasDagChecklistDefinition Checklist>
+	static FLifeDagChecklistState& GetState()
+	{
+		static FLifeDagChecklistState* const State = &Get().FindStateChecked(FName(Checklist::ChecklistName));
+		return *State;
+	}
+
+	FLifeDagChecklistState& FindStateChecked(const FName& ChecklistName)
+	{
+		FScopeLock Lock(&Mutex);
+		const int32* Slot = SlotByName.Find(ChecklistName);
+		checkf(Slot, TEXT("Checklist %s not registered"), *ChecklistName.ToString());
+		return *States[*Slot];
+	}
+
+	void ResetChecklist(const FName& ChecklistName)
+	{
+		FindStateChecked(ChecklistName).Reset();
+	}
+
+	/** Reset all registered DAG checklists (intended for PIE session reset). */
+	void ResetAllForPie()
+	{
+		FScopeLock Lock(&Mutex);
+		for (const TUniquePtr<FLifeDagChecklistState>& State : States) {
+			State->Reset();
+		}
+	}
+
+private:
+	FCriticalSection Mutex;
+	TArray<TUniquePtr<FLifeDagChecklistState>> States;
+	TMap<FName, int32> SlotByName;
+};
+
+/**
+ * RAII scope of a DAG checklist step: checks the prerequisites are done when it begins, marks the step done when it ends.
+ */
+template<LifeCheck::HasDagChecklistDefinition Checklist, int32 StepIndex>
+struct TLifeDagChecklistScope
+{
+	static_assert(StepIndex != INDEX_NONE, "Step is not one of the checklist's Steps");
+
+	TLifeDagChecklistScope()
+		: State(FLifeDagChecklistRegistry::GetState<Checklist>())
+		, TraceScope(FLifeTraceScope::IsEnabled() ? *State.TraceNames[StepIndex] : nullptr)
+	{
+		SCOPE_CYCLE_COUNTER(STAT_LifeChecklistSteps);
+		INC_DWORD_STAT(STAT_LifeChecklistStepsRun);
+		State.BeginStep(StepIndex);
+	}
+
+	~TLifeDagChecklistScope()
+	{
+		SCOPE_CYCLE_COUNTER(STAT_LifeChecklistSteps);
+		State.CompleteStep(StepIndex);
+	}
+
+	FLifeDagChecklistState& State;
+	FLifeTraceScope TraceScope;
+};
+
+// Usage, from any thread or task:
+//   LG_SCOPED_DAG_CHECKLIST_STEP(FInitEnginesDagChecklist, InitAtlas);
+#define LG_SCOPED_DAG_CHECKLIST_STEP(Checklist, Step) \
+    TLifeDagChecklistScope<Checklist, LifeCheck::FindDagStepIndex<Checklist>(Checklist::Step)> LIFE_CHECK_CONCAT(DagChecklistScope_, __LINE__)
+
+#define LG_RESET_DAG_CHECKLIST(Checklist) \
+	FLifeDagChecklistRegistry::GetState<Checklist>().Reset();
+
+#define LG_ENSURE_DAG_CHECKLIST_DONE(Checklist) \
+    LG_CONTRACT_CHECK_LAZY( \
+        FLifeDagChecklistRegistry::GetState<Checklist>().IsDone(), \
+        []() { \
+            return FString::Printf(TEXT("Checklist '%s' not done (missing: %s)"), \
+                Checklist::ChecklistName, \
+                *FLifeDagChecklistRegistry::GetState<Checklist>().DescribeSteps( \
+                    FLifeDagChecklistRegistry::GetState<Checklist>().AllStepsMask & \
+                    ~FLifeDagChecklistRegistry::GetState<Checklist>().DoneMask.load())); \
+        })
@@ -1,7 +1,10 @@
 ﻿#pragma once
 
 #include "CoreMinimal.h"
+#include "Containers/Queue.h"
 #include "Misc/OutputDevice.h"
+#include "Misc/StringBuilder.h"
+#include <atomic>
 
 /**
  * Floodlight is the Domain Error version of Contracts. The rationale is that while contract errors are programmer
@@ -23,6 +26,9 @@
  *			impossible to ignore, and then there's a permanent overlay on top with the errors list.
  * - UE_LOG interception. We can configure intercepted log categories to send all logs with a certain verbosity level
  *			to Floodlight, automatically.
+ *
+ * Reports may come from any thread. Off the game thread they are pushed to a lock-free queue that the game thread
+ * drains (in Tick, DrawOverlay and its own reports), so only the game thread touches the errors, budget and overlay.
  */
 
 /**
@@ -42,13 +48,6 @@ struct FLifeDomainError
 {
 	FLifeDomainError() = default;
     
-	FLifeDomainError(const FString& InMessage, const FString& InContext, ELifeDomainErrorSeverity InSeverity)
-		: Message(InMessage)
-		, Context(InContext)
-		, Timestamp(FDateTime::Now())
-		, Severity(InSeverity)
-	{}
-    
 	FString GetSeverityString() const
 	{
 		switch (Severity)
@@ -71,11 +70,55 @@ struct FLifeDomainError
 		}
 	}
 	
-	FString Message;
-	FString Context;        // Function, file, line
-	FDateTime Timestamp;
-	ELifeDomainErrorSeverity Severity;
+	// Both point into the Floodlight text arena and may be truncated, see FConfig::MaxErrorTextLength
+	FStringView Message;
+	FStringView Context;    // Function, file, line
+	FDateTime Timestamp;    // Last seen
+	FDateTime FirstSeen;
+	ELifeDomainErrorSeverity Severity = ELifeDomainErrorSeverity::Warning;
 	int32 OccurrenceCount = 1;
+	
+	// Rate tracking in FPlatformTime::Seconds(). Reports are counted in windows of at least a second, Rate is the
+	// rate of the last closed window.
+	double RateWindowStart = 0.0;
+	int32 RateWindowCount = 0;
+	float Rate = 0.0f;
+	float PeakRate = 0.0f;
+	
+	// Counts one more report at Now, closing the rate window if it's a second old
+	void RecordOccurrence(double Now)
+	{
+		const double Elapsed = Now - RateWindowStart;
+		if (Elapsed >= 1.0)
+		{
+			Rate = static_cast<float>(RateWindowCount / Elapsed);
+			PeakRate = FMath::Max(PeakRate, Rate);
+			RateWindowStart = Now;
+			RateWindowCount = 0;
+		}
+		++RateWindowCount;
+	}
+	
+	// Reports per second around Now. Decays once reports stop, since the open window keeps growing.
+	float GetRate(double Now) const
+	{
+		const double Elapsed = Now - RateWindowStart;
+		return Elapsed >= 1.0 ? static_cast<float>(RateWindowCount / Elapsed) : FMath::Max(Rate, static_cast<float>(RateWindowCount));
+	}
+	
+	float GetPeakRate(double Now) const { return FMath::Max(PeakRate, GetRate(Now)); }
+	// Hash of (message, severity, call site), the key of the dedup index
+	uint64 Signature = 0;
+};
+
+/**
+ * Aggregate of the errors evicted from the active list to stay within the memory ceiling
+ */
+struct FLifeDomainErrorOverflow
+{
+	int32 NumErrors = 0;            // Distinct errors currently evicted
+	int32 NumWarnings = 0;          // ... of which warnings
+	int32 OccurrenceCount = 0;      // Reports of all of them together
 };
 
 /**
@@ -90,14 +133,29 @@ public:
     
 	// FOutputDevice interface
 	virtual void Serialize(const TCHAR* V, ELogVerbosity::Type Verbosity, const FName& Category) override;
+	// Serialize is lock-free and reports made off the game thread are queued, so no need to funnel logs through one thread
+	virtual bool CanBeUsedOnAnyThread() const override { return true; }
+	virtual bool CanBeUsedOnMultipleThreads() const override { return true; }
     
 private:
-	// Categories to intercept
-	TSet<FName> InterceptedCategories;
+	static constexpr int32 MaxInterceptedCategories = 64;
+	
+	// Comparison indices of the categories to intercept, 0 for free slots. Written on the game thread, read lock-free
+	// by every logging thread.
+	std::atomic<uint32> InterceptedCategories[MaxInterceptedCategories];
+	// One bit per hashed comparison index, rejects most categories with a single test
+	std::atomic<uint64> InterceptedFilter{0};
+	
+	bool AddInterceptedCategory(const FName& Category);
+	void RemoveInterceptedCategory(const FName& Category);
+	bool IsIntercepted(const FName& Category) const;
+	void RebuildInterceptedFilter();
     
 	void ProcessInterceptedLog(const FString& Message, ELogVerbosity::Type Verbosity, const FName& Category);
 };
 
+struct FLifeDomainCallSite;
+
 /**
  * Main Domain Error Floodlight System
  * Manages error budget, visual feedback, and error tracking
@@ -115,6 +173,9 @@ public:
         float FlashFrequency = 8.0f;    // Flash oscillation frequency
         bool bPauseOnError = false;     // Whether to pause game on errors
         bool bPlaySounds = true;        // Whether to play alert sounds
+        int32 MaxErrorMemoryKB = 256;   // Memory ceiling of the active error list, the oldest errors are evicted past it
+        int32 MaxErrorTextLength = 512; // Characters kept per error, message plus context
+        FString ExportPath;             // Streams errors to this NDJSON file (see LifeFloodlightExport.h), -FloodlightExport=<file> overrides
     };
     
     // Initialization
@@ -126,6 +187,18 @@ public:
     static void ReportError(const FString& Message, const FString& Context = TEXT(""));
     static void ReportCritical(const FString& Message, const FString& Context = TEXT(""));
     
+    // Call-site reporting, what the LG_DOMAIN_* macros use. The message is formatted into a stack buffer, and a
+    // repeat of an active error from the same site only bumps its count and the budget, without allocating.
+    static void ReportAtSite(FLifeDomainCallSite& Site, ELifeDomainErrorSeverity Severity, FStringView Message);
+    
+    template <typename FmtType, typename... Types>
+    static void ReportAtSitef(FLifeDomainCallSite& Site, ELifeDomainErrorSeverity Severity, const FmtType& Format, Types... Args)
+    {
+        TStringBuilder<512> Message;
+        Message.Appendf(Format, Args...);
+        ReportAtSite(Site, Severity, Message.ToView());
+    }
+    
     // Manual control
     static void ClearAllErrors();
     static void AcknowledgeError(int32 Index);
@@ -136,14 +209,26 @@ public:
 	static void Console_Acknowledge(const TArray<FString>& Args);
 	// Emits real domain warnings/errors (affect budget). Usage: Floodlight.EmitError warning|error [count] [message...]
 	static void Console_EmitError(const TArray<FString>& Args);
+	// Logs the errors with the highest report rate. Usage: Floodlight.Stats [count]
+	static void Console_Stats(const TArray<FString>& Args);
     
     // Getters
-    static int32 GetCurrentBudget() { return CurrentBudget; }
+    // Includes the reports of this frame that Tick hasn't applied yet
+    static int32 GetCurrentBudget() { return CurrentBudget + Batch.Budget; }
     static int32 GetMaxBudget() { return Config.MaxBudget; }
-    static const TArray<FLifeDomainError>& GetActiveErrors() { return ActiveErrors; }
-    static bool HasActiveErrors() { return ActiveErrors.Num() > 0; }
+    static const FConfig& GetConfig() { return Config; }
+    static int32 GetNumActiveErrors() { return NumErrors; }
+    // Active errors kept before the oldest is evicted, from FConfig::MaxErrorMemoryKB
+    static int32 GetErrorCapacity() { return ErrorRing.Num(); }
+    // Oldest first
+    static const FLifeDomainError& GetActiveError(int32 Index);
+    static bool HasActiveErrors() { return NumErrors > 0; }
+    static const FLifeDomainErrorOverflow& GetOverflow() { return Overflow; }
+    // Reports of an error signature so far, exact even if the error was evicted
+    static int32 GetOccurrenceCount(uint64 Signature);
     
-    // Tick (call from game viewport client or HUD)
+    // Tick (call from game viewport client or HUD). Applies the reports made off the game thread, then the batch of
+    // this frame's reports.
     static void Tick(float DeltaTime);
     
     // Drawing (call from HUD or debug canvas)
@@ -155,13 +240,90 @@ public:
     
 private:
     static FConfig Config;
-    static TArray<FLifeDomainError> ActiveErrors;
+    // Active errors, a fixed-capacity ring sized from the memory ceiling. Slot S owns the text arena range
+    // [S * MaxErrorTextLength, (S + 1) * MaxErrorTextLength).
+    static TArray<FLifeDomainError> ErrorRing;
+    static TArray<TCHAR> ErrorText;
+    static int32 FirstError;
+    static int32 NumErrors;
+    // Signature -> ErrorRing slot, so repeat reports don't scan the list
+    static TMap<uint64, int32> ErrorIndex;
+    // Signature -> occurrence count of the evicted errors, so their counts carry on if they come back
+    static TMap<uint64, int32> EvictedCounts;
+    static FLifeDomainErrorOverflow Overflow;
     static int32 CurrentBudget;
     static float FlashTimer;
     static bool bInitialized;
     static TUniquePtr<FLifeDomainErrorOutputDevice> OutputDevice;
     
+    // A report made off the game thread, waiting for the game thread to apply it
+    struct FPendingReport
+    {
+        FString Message;
+        FString Context;
+        uint64 ContextHash = 0;
+        ELifeDomainErrorSeverity Severity = ELifeDomainErrorSeverity::Warning;
+    };
+    static TQueue<FPendingReport, EQueueMode::Mpsc> PendingReports;
+    
+    // The feedback of the reports of one frame. Errors and counts are stored as reports come in, but the log, flash,
+    // sound, pause and budget are applied once per frame by ApplyReportBatch: one log line per new error, one flash
+    // and sound for the highest severity, one budget update. The budget limit is still tested on every report.
+    struct FBatchedError
+    {
+        uint64 Signature = 0;
+        // OccurrenceCount when the error was added, later reports of the frame only bump the live count
+        int32 FirstOccurrenceCount = 1;
+        ELifeDomainErrorSeverity Severity = ELifeDomainErrorSeverity::Warning;
+    };
+    struct FReportBatch
+    {
+        uint64 Frame = 0;
+        TArray<FBatchedError> NewErrors;
+        int32 Budget = 0;
+        TOptional<ELifeDomainErrorSeverity> HighestSeverity;
+    };
+    static FReportBatch Batch;
+    
+    // Pre-laid-out overlay, rebuilt only when the errors, the budget or the screen size change
+    struct FOverlayRow
+    {
+        FString Text;
+        FString Context;
+        FString Time;
+        FLinearColor Color;
+    };
+    struct FOverlayCache
+    {
+        FVector2D ScreenSize = FVector2D::ZeroVector;
+        TOptional<ELifeDomainErrorSeverity> EffectiveSeverity;
+        float BudgetPercent = 0.0f;
+        FLinearColor BudgetColor;
+        FString BudgetText;
+        float BudgetTextX = 0.0f;
+        float ListHeight = 0.0f;
+        TArray<FOverlayRow> Rows;
+        FString MoreText;
+    };
+    static FOverlayCache OverlayCache;
+    static bool bOverlayDirty;
+    static void RebuildOverlayCache(UCanvas* Canvas);
+    
+    static void DrainPendingReports();
+    // Game thread part of a report: dedup, budget, flash
+    static void ApplyReport(FStringView Message, FStringView Context, uint64 ContextHash, ELifeDomainErrorSeverity Severity);
     static void ReportInternal(const FString& Message, const FString& Context, ELifeDomainErrorSeverity Severity);
+    static void ReportInternal(FStringView Message, const FString& Context, uint64 ContextHash, ELifeDomainErrorSeverity Severity);
+    static uint64 ComputeSignature(FStringView Message, uint64 ContextHash, ELifeDomainErrorSeverity Severity);
+    static void RebuildErrorIndex();
+    static void AllocateErrorStorage();
+    static int32 GetErrorSlot(int32 Index) { return (FirstError + Index) % ErrorRing.Num(); }
+    // Writes an error and its text into a ring slot
+    static void StoreError(int32 Slot, const FLifeDomainError& Error, FStringView Message, FStringView Context);
+    static void EvictOldestError();
+    // Adds to the batch budget, applying the batch right away if it reaches the limit
+    static void BatchBudget(int32 Amount);
+    static void ApplyReportBatch();
     static void ConsumeBudget(int32 Amount);
     static void TriggerFlash(ELifeDomainErrorSeverity Severity);
     static void PlayAlertSound(ELifeDomainErrorSeverity Severity);
@@ -173,17 +335,44 @@ private:
 	static TOptional<ELifeDomainErrorSeverity> TestFlashSeverity;
 };
 
+/**
+ * Where a domain error is reported from. Every LG_DOMAIN_* expansion owns a static one, so the "%hs @ %s:%d" context
+ * and its hash are built once, the first time the site reports, instead of on every report.
+ */
+struct SKYLIFEGUARD_API FLifeDomainCallSite
+{
+	FLifeDomainCallSite(const ANSICHAR* InFunction, const TCHAR* InFile, int32 InLine);
+
+	FLifeDomainCallSite(const FLifeDomainCallSite&) = delete;
+	FLifeDomainCallSite& operator=(const FLifeDomainCallSite&) = delete;
+
+	const ANSICHAR* Function;
+	const TCHAR* File;
+	int32 Line;
+
+	// Pre-formatted context and its hash, the call-site part of the error signature
+	FString Context;
+	uint64 ContextHash;
+};
+
+/**
+ * The static call site of the enclosing macro expansion. __FUNCTION__ is passed in from outside the lambda so it names
+ * the user's function, not the lambda. Magic statics make the first construction thread safe.
+ */
+#define LG_DOMAIN_CALL_SITE() \
+	([](const ANSICHAR* LifeFunction) -> FLifeDomainCallSite& { \
+		static FLifeDomainCallSite LifeCallSite(LifeFunction, TEXT(__FILE__), __LINE__); \
+		return LifeCallSite; \
+	}(__FUNCTION__))
+
 #define LG_DOMAIN_WARNING(Format, ...) \
-	FLifeDomainErrorFloodlight::ReportWarning(FString::Printf(Format, ##__VA_ARGS__), \
-	FString::Printf(TEXT("%hs @ %s:%d"), __FUNCTION__, TEXT(__FILE__), __LINE__))
+	FLifeDomainErrorFloodlight::ReportAtSitef(LG_DOMAIN_CALL_SITE(), ELifeDomainErrorSeverity::Warning, Format, ##__VA_ARGS__)
 
 #define LG_DOMAIN_ERROR(Format, ...) \
-	FLifeDomainErrorFloodlight::ReportError(FString::Printf(Format, ##__VA_ARGS__), \
-	FString::Printf(TEXT("%hs @ %s:%d"), __FUNCTION__, TEXT(__FILE__), __LINE__))
+	FLifeDomainErrorFloodlight::ReportAtSitef(LG_DOMAIN_CALL_SITE(), ELifeDomainErrorSeverity::Error, Format, ##__VA_ARGS__)
 
 #define LG_DOMAIN_CRITICAL(Format, ...) \
-	FLifeDomainErrorFloodlight::ReportCritical(FString::Printf(Format, ##__VA_ARGS__), \
-	FString::Printf(TEXT("%hs @ %s:%d"), __FUNCTION__, TEXT(__FILE__), __LINE__))
+	FLifeDomainErrorFloodlight::ReportAtSitef(LG_DOMAIN_CALL_SITE(), ELifeDomainErrorSeverity::Critical, Format, ##__VA_ARGS__)
 
 
 /**
@@ -198,11 +387,8 @@ private:
  */
 #define LG_DOMAIN_CHK_FAILDO(Condition, Severity) \
 	if (bool bLifeCheckPassed = !!(Condition); bLifeCheckPassed) {} else \
-	if (([&](){ \
-		FLifeDomainErrorFloodlight::Report##Severity(TEXT("Check failed: ") TEXT(#Condition), \
-		FString::Printf(TEXT("%hs @ %s:%d"), __FUNCTION__, TEXT(__FILE__), __LINE__)); \
-		return true; \
-	})())
+	if (FLifeDomainErrorFloodlight::ReportAtSite(LG_DOMAIN_CALL_SITE(), ELifeDomainErrorSeverity::Severity, \
+		TEXT("Check failed: ") TEXT(#Condition)), true)
 
 /**
  * Checks a condition with a custom message. If it fails, reports a domain error and executes the following code block.
@@ -215,11 +401,8 @@ private:
  */
 #define LG_DOMAIN_CHECKF(Condition, Severity, Format, ...) \
 	if (bool bLifeCheckPassed = !!(Condition); bLifeCheckPassed) {} else \
-	if (([&](){ \
-		FLifeDomainErrorFloodlight::Report##Severity(FString::Printf(Format, ##__VA_ARGS__), \
-		FString::Printf(TEXT("%hs @ %s:%d"), __FUNCTION__, TEXT(__FILE__), __LINE__)); \
-		return true; \
-	})())
+	if (FLifeDomainErrorFloodlight::ReportAtSitef(LG_DOMAIN_CALL_SITE(), ELifeDomainErrorSeverity::Severity, \
+		Format, ##__VA_ARGS__), true)
 
 /**
  * Checks a condition. If it fails, reports a domain error and returns (void).
@@ -228,8 +411,8 @@ private:
 #define LG_DOMAIN_CHECK_RET_VOID(Condition, Severity) \
 	if (bool bLifeCheckPassed = !!(Condition); bLifeCheckPassed) {} else \
 	{ \
-		FLifeDomainErrorFloodlight::Report##Severity(TEXT("Check failed: ") TEXT(#Condition), \
-		FString::Printf(TEXT("%hs @ %s:%d"), __FUNCTION__, TEXT(__FILE__), __LINE__)); \
+		FLifeDomainErrorFloodlight::ReportAtSite(LG_DOMAIN_CALL_SITE(), ELifeDomainErrorSeverity::Severity, \
+			TEXT("Check failed: ") TEXT(#Condition)); \
 		return; \
 	}
 
@@ -240,8 +423,8 @@ private:
 #define LG_DOMAIN_CHECK_RET_VOID_MSG(Condition, Severity, Message, ...) \
 if (bool bLifeCheckPassed = !!(Condition); bLifeCheckPassed) {} else \
 	{ \
-		FLifeDomainErrorFloodlight::Report##Severity(FString::Printf(Message, ##__VA_ARGS__), \
-		FString::Printf(TEXT("%hs @ %s:%d"), __FUNCTION__, TEXT(__FILE__), __LINE__)); \
+		FLifeDomainErrorFloodlight::ReportAtSitef(LG_DOMAIN_CALL_SITE(), ELifeDomainErrorSeverity::Severity, \
+			Message, ##__VA_ARGS__); \
 		return; \
 	}
 
@@ -252,8 +435,8 @@ if (bool bLifeCheckPassed = !!(Condition); bLifeCheckPassed) {} else \
 #define LG_DOMAIN_CHECK_RET(Condition, Severity, ReturnValue) \
 	if (bool bLifeCheckPassed = !!(Condition); bLifeCheckPassed) {} else \
 	{ \
-		FLifeDomainErrorFloodlight::Report##Severity(TEXT("Check failed: ") TEXT(#Condition), \
-		FString::Printf(TEXT("%hs @ %s:%d"), __FUNCTION__, TEXT(__FILE__), __LINE__)); \
+		FLifeDomainErrorFloodlight::ReportAtSite(LG_DOMAIN_CALL_SITE(), ELifeDomainErrorSeverity::Severity, \
+			TEXT("Check failed: ") TEXT(#Condition)); \
 		return ReturnValue; \
 	}
 
@@ -264,8 +447,8 @@ if (bool bLifeCheckPassed = !!(Condition); bLifeCheckPassed) {} else \
 #define LG_DOMAIN_CHECK_RETF(Condition, Severity, ReturnValue, Format, ...) \
 	if (bool bLifeCheckPassed = !!(Condition); bLifeCheckPassed) {} else \
 	{ \
-		FLifeDomainErrorFloodlight::Report##Severity(FString::Printf(Format, ##__VA_ARGS__), \
-		FString::Printf(TEXT("%hs @ %s:%d"), __FUNCTION__, TEXT(__FILE__), __LINE__)); \
+		FLifeDomainErrorFloodlight::ReportAtSitef(LG_DOMAIN_CALL_SITE(), ELifeDomainErrorSeverity::Severity, \
+			Format, ##__VA_ARGS__); \
 		return ReturnValue; \
 	}
 
@@ -0,0 +1,79 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+
+struct FLifeDomainError;
+
+/**
+ * Streams Floodlight errors to an append-only newline-delimited JSON file, for CI and farm runs that want the errors
+ * of a run without parsing the log. Enabled by FLifeDomainErrorFloodlight::FConfig::ExportPath or the
+ * -FloodlightExport=<file> command line switch. One JSON object per line:
+ *
+ *   {"t":"run","time":"2024.01.31-12.00.00","cmdline":"..."}                              once per run
+ *   {"t":"new","sig":"9f3c...","sev":"WARNING","msg":"...","ctx":"...","time":"..."}     first report of a signature
+ *   {"t":"count","sig":"9f3c...","delta":42}                                              reports since the last flush
+ *
+ * The total count of a signature is 1 plus all its deltas. Lines are buffered on the game thread and written by a
+ * background task, and flushed before Floodlight crashes. The LifeFloodlightMerge commandlet aggregates the *.ndjson
+ * files of many runs.
+ */
+class SKYLIFEGUARD_API FLifeDomainErrorExporter
+{
+public:
+	/** Opens the file for append and writes the run line. Does nothing if Path is empty. */
+	static void Initialize(const FString& Path);
+	/** Flushes everything and closes the file. */
+	static void Shutdown();
+
+	static bool IsEnabled() { return bEnabled; }
+
+	/** First report of an error, or the first one since it was evicted or cleared. */
+	static void OnNewError(const FLifeDomainError& Error);
+	/** Repeat report of an active error. */
+	static void OnRepeat(uint64 Signature);
+
+	/** Emits the pending count deltas and hands the buffer to the writer once it's big or old enough. */
+	static void Tick();
+	/** Emits the pending count deltas and writes the buffer. Waits for the write if bWait, e.g. before crashing. */
+	static void Flush(bool bWait);
+
+private:
+	static void AppendLine(FStringView Line);
+	static void EmitCountDeltas();
+
+	static bool bEnabled;
+	static FString Path;
+	/** Signatures that already have a "new" line in this run. */
+	static TSet<uint64> ExportedSignatures;
+	/** Reports per signature since the last flush. */
+	static TMap<uint64, int32> PendingDeltas;
+	/** UTF-8 lines not handed to the writer yet. */
+	static TArray<uint8> Buffer;
+	static double LastFlushSeconds;
+};
+
+/** Everything known about one signature across merged export files. Text fields stay JSON-escaped as read. */
+struct FLifeMergedErrorSignature
+{
+	FString Severity;
+	FString Message;
+	FString Context;
+	FString FirstSeen;
+	int64 Count = 0;
+	int32 NumFiles = 0;
+};
+
+using FLifeMergedErrorSignatures = TMap<uint64, FLifeMergedErrorSignature>;
+
+/**
+ * Reading side of the export format, for the LifeFloodlightMerge commandlet. A file is parsed into its own map, then
+ * added to the running total, so files can be parsed in parallel.
+ */
+class SKYLIFEGUARD_API FLifeDomainErrorExportMerger
+{
+public:
+	/** Reads the signatures of one export file, with their total count in it. False if it can't be read. */
+	static bool ParseFile(const FString& File, FLifeMergedErrorSignatures& OutSignatures);
+	/** Adds the signatures of one parsed file to Total: counts and file counts are summed, the first text is kept. */
+	static void Merge(FLifeMergedErrorSignatures& Total, const FLifeMergedErrorSignatures& File);
+};
@@ -0,0 +1,64 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+#include "LifeContracts.h"
+#include "UObject/WeakObjectPtrTemplates.h"
+
+/*
+ * Deferred invariant checks. LG_CLASS_INVARIANTS_DEFERRED(Object) doesn't check the object, it queues a weak pointer to
+ * it and the call site of the macro. A core ticker drains the queue oldest first, within Lifeguard.Invariants.Deferred.BudgetMs
+ * per frame, so hundreds of actors spawned in one frame are checked over the next few frames instead of in a hitch.
+ *
+ * The checks are the same as LG_CLASS_INVARIANTS, and a failure appends the call site that queued the check to its
+ * message. Objects collected before their turn are dropped. Flush() runs everything queued at once, for tests and for
+ * code that needs the checks done before going on.
+ *
+ * Game thread only. Calls from other threads, and every call while Lifeguard.Invariants.Deferred is off, check
+ * immediately.
+ */
+
+namespace Debug
+{
+	class SKYLIFEGUARD_API FLifeDeferredInvariants
+	{
+	public:
+		/** Registers the ticker. */
+		static void Initialize();
+		/** Removes the ticker and drops what's queued. */
+		static void Shutdown();
+
+		static void Enqueue(const UObject* Object, const FLifeInvariantCallSite& Site);
+
+		/** Checks everything queued, including what the checks queue. */
+		static void Flush();
+
+		/**
+		 * Checks queued objects, oldest first, until BudgetSeconds have passed. At least one object is checked, so the
+		 * queue always moves.
+		 *
+		 * @return The number of queued entries processed, collected objects included.
+		 */
+		static int32 Drain(double BudgetSeconds);
+
+		static int32 GetNumPending() { return Queue.Num() - Head; }
+
+		/** Call site of the deferred check running now, null outside of one. */
+		static const FLifeInvariantCallSite* GetCurrentCallSite() { return CurrentCallSite; }
+
+	private:
+		static bool Tick(float DeltaTime);
+
+		struct FPendingCheck
+		{
+			TWeakObjectPtr<const UObject> Object;
+			FLifeInvariantCallSite Site;
+		};
+
+		/** Entries before Head are done. The array is compacted when the queue empties or Head passes half of it. */
+		static TArray<FPendingCheck> Queue;
+		static int32 Head;
+		static const FLifeInvariantCallSite* CurrentCallSite;
+		static FTSTicker::FDelegateHandle TickerHandle;
+	};
+}
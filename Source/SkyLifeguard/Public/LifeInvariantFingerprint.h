@@ -0,0 +1,60 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+
+/*
+ * Incremental invariant checks. With Lifeguard.Invariants.Incremental on, LG_CLASS_INVARIANTS and
+ * LG_CLASS_INVARIANTS_BATCH hash the bytes every fingerprinted invariant reads (the plan knows their offsets, plus the
+ * elements of TArray/TOptional containers) and skip those invariants if the hash didn't change since the object last
+ * passed. Invariants that depend on more than the object's own bytes (weak pointers, TSet/TMap, Contract*, custom
+ * functions) always run.
+ *
+ * Fingerprints are dropped after every garbage collection, on hot reload / blueprint reinstancing, and on Invalidate().
+ * Game thread only, calls from other threads are always fully checked.
+ */
+
+namespace Debug
+{
+	struct FLifeInvariantPlan;
+
+	/** Checks vs skips of the incremental mode. */
+	struct FLifeInvariantFingerprintStats
+	{
+		/** Fingerprint unchanged, fingerprinted invariants skipped. */
+		uint64 NumUnchanged = 0;
+		/** New object or changed fingerprint, fully checked. */
+		uint64 NumChanged = 0;
+	};
+
+	class SKYLIFEGUARD_API FLifeInvariantFingerprints
+	{
+	public:
+		static void Initialize();
+		static void Shutdown();
+
+		/** True if Lifeguard.Invariants.Incremental is on and this is the game thread. */
+		static bool IsEnabled();
+
+		/** Hashes the fingerprinted bytes of the object. */
+		static uint64 Compute(const UObject* Object, const FLifeInvariantPlan& Plan);
+
+		/** True if the object passed its last check with this fingerprint. Updates the stats. */
+		static bool IsUnchanged(const UObject* Object, uint64 Fingerprint);
+
+		/** Remembers the fingerprint of an object that just passed a full check. */
+		static void Store(const UObject* Object, uint64 Fingerprint);
+
+		/** Forgets the fingerprint of one object, or of every object if null, so they're fully checked next time. */
+		static void Invalidate(const UObject* Object = nullptr);
+
+		static FLifeInvariantFingerprintStats GetStats() { return Stats; }
+		static int32 GetNum() { return Fingerprints.Num(); }
+
+	private:
+		static TMap<const UObject*, uint64> Fingerprints;
+		static FLifeInvariantFingerprintStats Stats;
+		static FDelegateHandle PostGarbageCollectHandle;
+		static FDelegateHandle ReloadCompleteHandle;
+		static FDelegateHandle ObjectsReinstancedHandle;
+	};
+}
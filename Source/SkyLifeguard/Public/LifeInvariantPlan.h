@@ -0,0 +1,303 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "LifeContracts.h"
+#include "Stats/Stats.h"
+#include "UObject/WeakObjectPtrTemplates.h"
+
+/*
+ * Invariant plans are the compiled form of a class' meta=(Invariant) annotations. Everything that only depends on the
+ * class (which properties are annotated, where they live, what rule they follow, which UFunction backs a custom
+ * check) is read from reflection once, the first time we see the class, and stored as a flat array of entries.
+ * Checking an object is then a walk over that array, with no metadata lookups or string compares.
+ */
+
+namespace Debug
+{
+	/** Rule of a single invariant entry, decoded once from its meta=(Invariant=...) string. */
+	enum class ELifeInvariantOp : uint8
+	{
+		MemSafe,
+		MemSafeContainer,
+		ID,
+		Gte0,
+		Gt0,
+		Lte0,
+		Lt0,
+		Range,
+		Name,
+		True,
+		False,
+		Contract,
+		Function,
+	};
+
+	/** Concrete storage type of the property an entry reads. */
+	enum class ELifeInvariantKind : uint8
+	{
+		Unsupported,
+		Int8,
+		Int16,
+		Int32,
+		Int64,
+		UInt8,
+		UInt16,
+		UInt32,
+		UInt64,
+		Float,
+		Double,
+		Bool,
+		Name,
+		Object,
+		Class,
+		SoftObject,
+		SoftClass,
+		WeakObject,
+		Interface,
+		Array,
+		Set,
+		Map,
+		Optional,
+	};
+
+	/**
+	 * Parsed bounds of a Range[a,b] invariant. Brackets are inclusive, parentheses exclusive, and they can be mixed.
+	 */
+	template<typename T>
+	struct TLifeInvariantBounds
+	{
+		T Lower = 0;
+		T Upper = 0;
+		bool bLowerInclusive = true;
+		bool bUpperInclusive = true;
+
+		bool Contains(T Value) const
+		{
+			const bool bLowerOk = bLowerInclusive ? (Value >= Lower) : (Value > Lower);
+			const bool bUpperOk = bUpperInclusive ? (Value <= Upper) : (Value < Upper);
+			return bLowerOk && bUpperOk;
+		}
+	};
+
+	/**
+	 * Floating point ranges tolerate a small relative epsilon scaled by value/bounds, applied outward
+	 * (lower - eps, upper + eps) so we don't accidentally exclude valid values because of tiny FP errors.
+	 */
+	template<>
+	inline bool TLifeInvariantBounds<double>::Contains(double Value) const
+	{
+		const double Scale = FMath::Max(1.0, FMath::Max(FMath::Abs(Lower), FMath::Max(FMath::Abs(Upper), FMath::Abs(Value))));
+		const double Eps = FMath::Clamp(Scale * 1e-6, 1e-10, 1e-3);
+		const bool bLowerOk = bLowerInclusive ? (Value >= (Lower - Eps)) : (Value > (Lower - Eps));
+		const bool bUpperOk = bUpperInclusive ? (Value <= (Upper + Eps)) : (Value < (Upper + Eps));
+		return bLowerOk && bUpperOk;
+	}
+
+	/**
+	 * Range bounds of an entry, parsed once when the plan is built. Only the member matching the entry's property kind
+	 * is filled: signed integers compare in int64, unsigned integers in uint64 and floating point in double.
+	 */
+	struct FLifeInvariantRange
+	{
+		TLifeInvariantBounds<int64> Signed;
+		TLifeInvariantBounds<uint64> Unsigned;
+		TLifeInvariantBounds<double> Floating;
+	};
+
+	/**
+	 * Parses a Range rule (e.g. "Range[0, 1]", "Range (1, 2]") for a property of the given kind.
+	 *
+	 * @param Rule The full rule text, starting with "Range".
+	 * @param Kind Kind of the annotated property. Integer kinds require integer bounds.
+	 * @param OutRange Receives the parsed bounds.
+	 * @param OutError Receives a description of the problem if the spec is malformed.
+	 * @return True if the spec is well formed.
+	 */
+	SKYLIFEGUARD_API bool ParseRangeInvariant(const FString& Rule, ELifeInvariantKind Kind, FLifeInvariantRange& OutRange, FString& OutError);
+
+	struct FLifeInvariantEntry;
+
+	/**
+	 * Checks the value of one entry. Kernels are specialized per (rule, underlying type) and picked when the plan is
+	 * built (see LifeInvariantKernels.h), so they read the value straight from its address with no type discovery.
+	 *
+	 * @param Entry The plan entry, for rules that need bounds or the property.
+	 * @param Value Address of the value, i.e. (uint8*)Object + Entry.Offset.
+	 * @return True if the invariant holds.
+	 */
+	using FLifeInvariantKernel = bool (*)(const FLifeInvariantEntry& Entry, const void* Value);
+
+	/**
+	 * A single annotated property of a class.
+	 */
+	struct FLifeInvariantEntry
+	{
+		/** Byte offset of the value from the start of the object. */
+		int32 Offset = 0;
+		ELifeInvariantKind Kind = ELifeInvariantKind::Unsupported;
+		ELifeInvariantOp Op = ELifeInvariantOp::Function;
+		/** For containers: kind of the TArray/TSet/TOptional element or the TMap key. */
+		ELifeInvariantKind ElementKind = ELifeInvariantKind::Unsupported;
+		/** For maps: kind of the TMap value. */
+		ELifeInvariantKind MapValueKind = ELifeInvariantKind::Unsupported;
+		/** Value check for this entry. Null for rules that aren't plain value checks (Contract*, custom functions). */
+		FLifeInvariantKernel Kernel = nullptr;
+		/** For numeric rules on containers: check of a single element/value, to find the failing one for the report. */
+		FLifeInvariantKernel ElementKernel = nullptr;
+		/** True if the entry is part of an FLifeInvariantBatch, so the scalar walk can skip it. */
+		bool bBatched = false;
+		/**
+		 * True if the result only depends on bytes covered by the plan's fingerprint, so an unchanged fingerprint means
+		 * an unchanged result. False for weak pointers, sets, maps, Contract* and functions.
+		 */
+		bool bFingerprinted = false;
+		/** The annotated property. Only used to read containers/bools and to build failure messages. */
+		FProperty* Property = nullptr;
+		/** Resolved custom invariant function for Invariant=FunctionName entries. */
+		UFunction* Function = nullptr;
+		/** Native binding for Invariant=FunctionName entries (LG_REGISTER_NATIVE_INVARIANT). Preferred over Function. */
+		FLifeNativeInvariantFunc NativeFunction = nullptr;
+		/** Pre-parsed bounds for Invariant=Range entries. */
+		FLifeInvariantRange Range;
+		/** Original rule text, e.g. "Range[0, 1]". */
+		FString Rule;
+
+		/**
+		 * Kind of the values a numeric rule tests. Numeric rules apply element-wise to TArray and TSet elements and
+		 * to TMap values, everything else is tested as a whole.
+		 */
+		ELifeInvariantKind GetRuleValueKind() const
+		{
+			switch (Kind)
+			{
+			case ELifeInvariantKind::Array:
+			case ELifeInvariantKind::Set: return ElementKind;
+			case ELifeInvariantKind::Map: return MapValueKind;
+			default:                      return Kind;
+			}
+		}
+	};
+
+	/**
+	 * A group of same-type numeric entries under the same rule (and the same bounds for Range), checked 4 at a time
+	 * with vector compares. When a batch fails, the scalar kernels of its entries pin down which property failed.
+	 */
+	struct FLifeInvariantBatch
+	{
+		/** Gte0, Gt0, Lte0, Lt0 or Range. */
+		ELifeInvariantOp Op = ELifeInvariantOp::Gte0;
+		/** Int32 or Float. */
+		ELifeInvariantKind Kind = ELifeInvariantKind::Int32;
+		/** Range bounds narrowed to the batch type. Float bounds are rounded inward, so a lane that passes the vector
+		 * test always passes the scalar one. */
+		int32 LowerInt = 0;
+		int32 UpperInt = 0;
+		float LowerFloat = 0.0f;
+		float UpperFloat = 0.0f;
+		bool bLowerInclusive = true;
+		bool bUpperInclusive = true;
+		/** Value offsets, padded to a multiple of 4 by repeating the last one. */
+		TArray<int32> Offsets;
+		/** Indices into FLifeInvariantPlan::Entries of the batched entries. */
+		TArray<int32> EntryIndices;
+	};
+
+	/** A class level custom invariant: an invariant UFUNCTION, a registered native function, or both. */
+	struct FLifeInvariantFunction
+	{
+		/** Function name, for failure messages. */
+		FName Name;
+		/** Direct call, if registered with LG_REGISTER_NATIVE_INVARIANT. */
+		FLifeNativeInvariantFunc Native = nullptr;
+		/** Reflected function, called through ProcessEvent when there's no native binding. */
+		UFunction* Function = nullptr;
+	};
+
+	/** A run of object bytes that is hashed into the fingerprint. Adjacent properties are merged into one range. */
+	struct FLifeInvariantFingerprintRange
+	{
+		int32 Offset = 0;
+		int32 Size = 0;
+	};
+
+	/** A TArray whose elements are hashed into the fingerprint, on top of its header. */
+	struct FLifeInvariantFingerprintArray
+	{
+		int32 Offset = 0;
+		int32 ElementSize = 0;
+	};
+
+	/**
+	 * Everything needed to check the invariants of all objects of one class.
+	 */
+	struct FLifeInvariantPlan
+	{
+		/** Class the plan was built for. Used to detect plans outliving their class (e.g. GC'd blueprint classes). */
+		TWeakObjectPtr<const UClass> Class;
+		/** Annotated properties, in TFieldIterator order. */
+		TArray<FLifeInvariantEntry> Entries;
+		/** Vectorized groups of numeric entries. Their entries are flagged bBatched. */
+		TArray<FLifeInvariantBatch> Batches;
+		/** UFUNCTIONs with meta=(Invariant) in TFieldIterator order, then unreferenced native invariants. */
+		TArray<FLifeInvariantFunction> Functions;
+		/**
+		 * True if every check is a plain read of the object's own memory: no Contract* recursion (which needs other
+		 * plans), no custom functions (which go through ProcessEvent) and a kernel for every entry. Only those plans may
+		 * run off the game thread.
+		 */
+		bool bPureFieldReads = false;
+		/** True if any entry is Invariant=Contract*, so checking an object may walk into others. */
+		bool bHasContracts = false;
+		/** True if the plan was built from the precompiled invariant table rather than from metadata. */
+		bool bFromTable = false;
+		/**
+		 * Offsets of the hard object pointers under Invariant=MemSafe when the plan was built in strict mode
+		 * (Lifeguard.Invariants.StrictMemSafe). Their GUObjectArray items are prefetched before the checks.
+		 */
+		TArray<int32> StrictPointerOffsets;
+
+		/** Bytes that make up the incremental mode fingerprint (see LifeInvariantFingerprint.h). */
+		TArray<FLifeInvariantFingerprintRange> FingerprintRanges;
+		TArray<FLifeInvariantFingerprintArray> FingerprintArrays;
+		/** True if every entry is fingerprinted and there are no functions, so an unchanged object can be skipped whole. */
+		bool bFullyFingerprinted = false;
+
+		/** Trace scope name of the class, set when the plan was built with Lifeguard.Stats.PerClass on. */
+		FString TraceName;
+#if STATS
+		/** Cycle stat of the class in STATGROUP_Lifeguard, set along with TraceName. */
+		TStatId StatId;
+#endif
+
+		bool HasFingerprint() const { return !FingerprintRanges.IsEmpty(); }
+		bool IsEmpty() const { return Entries.IsEmpty() && Functions.IsEmpty(); }
+	};
+
+	/**
+	 * Per-UClass cache of invariant plans. Plans are built lazily on the first check of a class and invalidated when
+	 * class layouts may have changed: hot reload / Live Coding and blueprint recompiles (objects reinstanced).
+	 *
+	 * Game thread only.
+	 */
+	class SKYLIFEGUARD_API FLifeInvariantPlanCache
+	{
+	public:
+		static void Initialize();
+		static void Shutdown();
+
+		/** Returns the plan for the class, building it if needed. The reference is valid until the next Invalidate. */
+		static const FLifeInvariantPlan& GetPlan(const UClass* Class);
+
+		/** Drops every cached plan. They will be rebuilt on their next check. */
+		static void Invalidate();
+
+		static int32 GetNumPlans() { return Plans.Num(); }
+
+	private:
+		static TMap<const UClass*, TUniquePtr<FLifeInvariantPlan>> Plans;
+		static FDelegateHandle ReloadCompleteHandle;
+		static FDelegateHandle ObjectsReinstancedHandle;
+
+		static TUniquePtr<FLifeInvariantPlan> BuildPlan(const UClass* Class);
+	};
+}
@@ -0,0 +1,93 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/WeakObjectPtrTemplates.h"
+
+/*
+ * Sampled invariant checking. With Lifeguard.Invariants.Sampling on, LG_CLASS_INVARIANTS and LG_CLASS_INVARIANTS_BATCH
+ * only run a share of their checks each frame, limited by a sample rate, a time budget, or both. Selection is round-robin
+ * per class, so as long as the same objects are checked in the same order every frame, each of them is still checked
+ * within a bounded number of frames.
+ *
+ * - Sample rate R: the calls of a class are checked one in round(1/R), with the phase moving by one each frame.
+ * - Budget B: once B ms were spent in a frame (globally or for the class), the rest of the calls are skipped. The next
+ *   frame resumes at the first call that was skipped, and that call is always checked, even if it alone costs more
+ *   than B.
+ *
+ * Contract* recursion and the Lifeguard.CheckAllInvariants sweep are never sampled. Game thread only, calls from other
+ * threads are always checked.
+ */
+
+namespace Debug
+{
+	/** Executed vs skipped checks, to see what coverage sampling gives. */
+	struct FLifeInvariantSamplingStats
+	{
+		uint64 NumExecuted = 0;
+		uint64 NumSkipped = 0;
+	};
+
+	/** Per-class round-robin state and overrides. */
+	struct FLifeInvariantSamplingState
+	{
+		TWeakObjectPtr<const UClass> Class;
+
+		/** Overrides, negative means "use the global CVar". */
+		float SampleRate = -1.0f;
+		float BudgetMs = -1.0f;
+
+		/** Frame the counters below belong to. */
+		uint64 Frame = 0;
+		/** Calls seen this frame, i.e. the round-robin position of the next call. */
+		int32 CallIndex = 0;
+		/** Calls before this index were checked last frame, before the budget ran out. */
+		int32 ResumeIndex = 0;
+		/** Call index at which the budget ran out this frame, INDEX_NONE if it didn't. */
+		int32 ExhaustedIndex = INDEX_NONE;
+		/** Whether a call was admitted this frame. The first one is admitted whatever the budget says. */
+		bool bAdmittedThisFrame = false;
+		/** Cycles spent (or reserved) this frame. */
+		int64 SpentCycles = 0;
+		/** Running average of the cost of one check, used to reserve budget before a check runs. */
+		int64 EstimatedCycles = 0;
+
+		FLifeInvariantSamplingStats Stats;
+	};
+
+	class SKYLIFEGUARD_API FLifeInvariantSampler
+	{
+	public:
+		/** True if Lifeguard.Invariants.Sampling is on and this is the game thread. */
+		static bool IsEnabled();
+
+		/**
+		 * Decides whether the next check of an object of Class runs. Reserves the expected cost of the check against the
+		 * budgets, Record() settles it.
+		 *
+		 * @return The class state to pass to Record(), or nullptr if the check should be skipped.
+		 */
+		static FLifeInvariantSamplingState* Admit(const UClass* Class);
+
+		/** Settles the cost of NumChecks admitted checks of the same class. */
+		static void Record(FLifeInvariantSamplingState& State, uint64 Cycles, int32 NumChecks);
+
+		/** Overrides the sample rate and budget of a class. Pass negative values to go back to the global CVars. */
+		static void SetClassSampling(const UClass* Class, float SampleRate, float BudgetMs);
+
+		static FLifeInvariantSamplingStats GetStats() { return Stats; }
+		static FLifeInvariantSamplingStats GetClassStats(const UClass* Class);
+		static void ResetStats();
+		/** Logs the overall and per-class stats (Lifeguard.Invariants.Sampling.Stats). */
+		static void LogStats();
+
+	private:
+		static FLifeInvariantSamplingState& GetState(const UClass* Class);
+		static void BeginFrame();
+
+		/** Boxed so handed out states stay put when the map grows. */
+		static TMap<const UClass*, TUniquePtr<FLifeInvariantSamplingState>> States;
+		static FLifeInvariantSamplingStats Stats;
+		static uint64 Frame;
+		static int64 SpentCycles;
+	};
+}
@@ -0,0 +1,126 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "LifeInvariantPlan.h"
+
+class IMappedFileHandle;
+class IMappedFileRegion;
+
+/*
+ * Precompiled invariant table. The LifeInvariantTable commandlet builds the plan of every loaded class with
+ * meta=(Invariant) annotations and writes what the plans are made of (class path, property names and offsets, rules,
+ * opcodes and parsed Range bounds, invariant UFUNCTION names) to <Plugin>/Content/Lifeguard/InvariantTable.bin.
+ *
+ * The runtime memory-maps the file at module startup, and the plans of the classes in it are built from the table
+ * instead of from metadata: no metadata lookups and no rule parsing, and invariants keep working in builds without
+ * WITH_METADATA, where metadata doesn't exist. A class whose table record no longer matches the binary (a property
+ * was renamed, moved or changed type) falls back to metadata, or has no invariants if there is none. Where metadata
+ * exists, a record must also match the current annotations, so edits made since the table was written win.
+ *
+ * The file is a header followed by flat POD arrays (classes sorted by path hash, entries, functions) and a blob of
+ * null-terminated UTF-8 strings, so it's used in place with no loading step.
+ */
+
+namespace Debug
+{
+	namespace InvariantTable
+	{
+		static constexpr uint32 Magic = 0x5449474C; // "LGIT"
+		static constexpr uint32 Version = 2;
+
+		struct FHeader
+		{
+			uint32 Magic = 0;
+			uint32 Version = 0;
+			int32 NumClasses = 0;
+			int32 NumEntries = 0;
+			int32 NumFunctions = 0;
+			int32 NumStringBytes = 0;
+		};
+
+		struct FClass
+		{
+			/** CityHash64 of the UTF-8 class path, the sort key. */
+			uint64 PathHash = 0;
+			/** Strings are byte offsets into the string blob. */
+			int32 Path = 0;
+			int32 FirstEntry = 0;
+			int32 NumEntries = 0;
+			int32 FirstFunction = 0;
+			int32 NumFunctions = 0;
+			int32 Padding = 0;
+		};
+
+		/** An annotated property, inherited ones included. */
+		struct FEntry
+		{
+			/** Parsed bounds, for Range rules. */
+			FLifeInvariantRange Range;
+			int32 PropertyName = 0;
+			/** Offset the property had when the table was written, checked against the running binary. */
+			int32 Offset = 0;
+			int32 Rule = 0;
+			ELifeInvariantOp Op = ELifeInvariantOp::Function;
+			/** Types the property had when the table was written, so a type change at the same offset is caught. */
+			ELifeInvariantKind Kind = ELifeInvariantKind::Unsupported;
+			ELifeInvariantKind ElementKind = ELifeInvariantKind::Unsupported;
+			ELifeInvariantKind MapValueKind = ELifeInvariantKind::Unsupported;
+		};
+
+		/** A UFUNCTION with meta=(Invariant). */
+		struct FFunction
+		{
+			int32 Name = 0;
+		};
+
+		static_assert(std::is_trivially_copyable_v<FEntry>, "Table records are used in place");
+		static_assert(sizeof(FHeader) % 8 == 0 && sizeof(FClass) % 8 == 0 && sizeof(FEntry) % 8 == 0, "Table sections must stay 8 byte aligned");
+	}
+
+	class SKYLIFEGUARD_API FLifeInvariantTable
+	{
+	public:
+		/**
+		 * Maps the table if there is one, replacing the current one. Missing or mismatching tables are not an error,
+		 * plans then use metadata. Plans already built are kept, see FLifeInvariantPlanCache::Invalidate.
+		 */
+		static void Initialize(const FString& Path = GetDefaultPath());
+		static void Shutdown();
+
+		static bool IsLoaded() { return Header != nullptr; }
+
+		/** <Plugin>/Content/Lifeguard/InvariantTable.bin */
+		static FString GetDefaultPath();
+
+		/** The record of the class, or null if the table doesn't have it. */
+		static const InvariantTable::FClass* FindClass(const UClass* Class);
+
+		static TConstArrayView<InvariantTable::FEntry> GetEntries(const InvariantTable::FClass& Record);
+		static TConstArrayView<InvariantTable::FFunction> GetFunctions(const InvariantTable::FClass& Record);
+		static FString GetString(int32 Offset);
+
+#if WITH_METADATA
+		/**
+		 * Builds the plans of every loaded class from metadata and writes the table, see the LifeInvariantTable
+		 * commandlet. Unloads the current table first, so no plan is built from it.
+		 *
+		 * @return The number of classes written, or INDEX_NONE if the file can't be written.
+		 */
+		static int32 Write(const FString& Path);
+#endif
+
+	private:
+		static bool Bind(const uint8* Data, int64 Size);
+
+		static IMappedFileHandle* MappedFile;
+		static IMappedFileRegion* MappedRegion;
+		/** Fallback when the file can't be mapped, e.g. inside a pak. */
+		static TArray<uint8> LoadedData;
+
+		static const InvariantTable::FHeader* Header;
+		static const InvariantTable::FClass* Classes;
+		static const InvariantTable::FEntry* Entries;
+		static const InvariantTable::FFunction* Functions;
+		static const ANSICHAR* Strings;
+	};
+}
@@ -0,0 +1,86 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "Stats/Stats.h"
+#include "Trace/Trace.h"
+
+/*
+ * Profiling of Lifeguard itself. Every hot path has a cycle stat and a call count in STATGROUP_Lifeguard (`stat
+ * Lifeguard`), and a CPU trace scope on the Lifeguard trace channel, so Insights captures show them with
+ * `-trace=default,lifeguard` or `Trace.Enable Lifeguard`. Both are in every non-shipping build.
+ *
+ * Captures of the Lifeguard channel also name checklist steps ("Checklist LoadWorld: load-world-json"). With
+ * Lifeguard.Stats.PerClass on, every class with invariants gets its own cycle stat and trace scope as well, so a
+ * capture shows which classes cost what.
+ */
+
+DECLARE_STATS_GROUP(TEXT("Lifeguard"), STATGROUP_Lifeguard, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Class invariants"), STAT_LifeClassInvariants, STATGROUP_Lifeguard, SKYLIFEGUARD_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Class invariants batch"), STAT_LifeClassInvariantsBatch, STATGROUP_Lifeguard, SKYLIFEGUARD_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Check all invariants"), STAT_LifeCheckAllInvariants, STATGROUP_Lifeguard, SKYLIFEGUARD_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Deferred invariants"), STAT_LifeDeferredInvariants, STATGROUP_Lifeguard, SKYLIFEGUARD_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Checklist steps"), STAT_LifeChecklistSteps, STATGROUP_Lifeguard, SKYLIFEGUARD_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Floodlight report"), STAT_LifeFloodlightReport, STATGROUP_Lifeguard, SKYLIFEGUARD_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Floodlight tick"), STAT_LifeFloodlightTick, STATGROUP_Lifeguard, SKYLIFEGUARD_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("Floodlight overlay"), STAT_LifeFloodlightOverlay, STATGROUP_Lifeguard, SKYLIFEGUARD_API);
+
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Objects checked"), STAT_LifeObjectsChecked, STATGROUP_Lifeguard, SKYLIFEGUARD_API);
+DECLARE_DWORD_ACCUMULATOR_STAT_EXTERN(TEXT("Deferred checks pending"), STAT_LifeDeferredPending, STATGROUP_Lifeguard, SKYLIFEGUARD_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Checklist steps run"), STAT_LifeChecklistStepsRun, STATGROUP_Lifeguard, SKYLIFEGUARD_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Floodlight reports"), STAT_LifeFloodlightReports, STATGROUP_Lifeguard, SKYLIFEGUARD_API);
+
+UE_TRACE_CHANNEL_EXTERN(LifeguardChannel, SKYLIFEGUARD_API);
+
+/** Cycle stat plus a trace scope of the same name on the Lifeguard channel. */
+#define LG_SCOPE_CYCLE_COUNTER(Stat) \
+	SCOPE_CYCLE_COUNTER(Stat); \
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(Stat, LifeguardChannel)
+
+namespace Debug
+{
+	/** Lifeguard.Stats.PerClass, plans of classes with invariants then carry their own stat and trace name. */
+	SKYLIFEGUARD_API bool IsPerClassStatsEnabled();
+}
+
+/**
+ * Trace scope with a name known at runtime, on the Lifeguard channel. Names are built ahead of time (per class, per
+ * checklist step), so when no capture records the channel this is one channel test.
+ */
+struct FLifeTraceScope
+{
+	static bool IsEnabled()
+	{
+#if CPUPROFILERTRACE_ENABLED
+		return UE_TRACE_CHANNELEXPR_IS_ENABLED(CpuChannel | LifeguardChannel);
+#else
+		return false;
+#endif
+	}
+
+	/** Null names open no scope. */
+	explicit FLifeTraceScope(const TCHAR* Name)
+	{
+#if CPUPROFILERTRACE_ENABLED
+		if (Name && IsEnabled()) {
+			FCpuProfilerTrace::OutputBeginDynamicEvent(Name);
+			bActive = true;
+		}
+#endif
+	}
+
+	~FLifeTraceScope()
+	{
+#if CPUPROFILERTRACE_ENABLED
+		if (bActive) {
+			FCpuProfilerTrace::OutputEndEvent();
+		}
+#endif
+	}
+
+	UE_NONCOPYABLE(FLifeTraceScope);
+
+private:
+	bool bActive = false;
+};
@@ -0,0 +1,452 @@
+﻿#pragma once
+
+#include <concepts>
+#include <functional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "CoreMinimal.h"
+#include "LifeContracts.h"
+#include "UObject/Object.h"
+
+/*
+ * Invariants of plain C++ structs: Mass fragments, ECS components, USTRUCTs on hot paths, anything that isn't a
+ * UObject. Instead of meta=(Invariant) and reflection, the struct lists its invariants in a constexpr table of
+ * (member pointer, rule) pairs, using the same rule vocabulary as LG_CLASS_INVARIANTS. Every check is a template
+ * instantiated for the member's type, so checking a struct is straight-line code with no lookups.
+ *
+ *	struct FHealthFragment
+ *	{
+ *		int32 Health = 100;
+ *		float Armor = 0.0f;
+ *		int32 OwnerId = 0;
+ *		TArray<float> Resistances;
+ *
+ *		constexpr bool IsArmorCapped() const { return Armor <= Health; }
+ *
+ *		static constexpr auto Invariants = LifeInv::Make(
+ *			LG_INV_MEMBER(FHealthFragment, Health), LifeInv::Range<0, 100>{},
+ *			LG_INV_MEMBER(FHealthFragment, Armor), LifeInv::Gte0{},
+ *			&FHealthFragment::OwnerId, LifeInv::ID{},
+ *			&FHealthFragment::Resistances, LifeInv::Range<0.0f, 1.0f>{},
+ *			LifeInv::Function<&FHealthFragment::IsArmorCapped>{});
+ *	};
+ *
+ *	LG_STRUCT_INVARIANTS(Fragment);      // one value
+ *	LG_STRUCT_INVARIANTS_BULK(Fragments); // a TArray or TArrayView, each invariant runs across all values in turn
+ *
+ * LG_INV_MEMBER names the member in failure messages, bare member pointers are reported by their index in the table.
+ * Types that can't hold the table (engine or third party structs) specialize LifeInv::TStructInvariants instead.
+ *
+ * Numeric rules apply element-wise to TArray members, like they do for UPROPERTYs. Range takes its bounds as template
+ * arguments, so they are checked at compile time (Min <= Max) and compiled into the compare. Integer and floating
+ * bounds both work, pass false for bMinInclusive/bMaxInclusive to exclude a bound.
+ *
+ * For literal types, LifeInv::Test works in constant expressions, which proves default values valid at compile time:
+ *
+ *	static_assert(LifeInv::Test(FLiteralFragment{}, FLiteralFragment::Invariants));
+ */
+
+namespace LifeInv
+{
+	/** Integer IDs whose value cannot be INDEX_NONE. */
+	struct ID
+	{
+		static constexpr bool bElementWise = true;
+		template<typename T> static constexpr bool Test(const T& Value) { return Value != INDEX_NONE; }
+		static FString Describe() { return TEXT("ID"); }
+	};
+
+	/** Numeric >= 0 */
+	struct Gte0
+	{
+		static constexpr bool bElementWise = true;
+		template<typename T> static constexpr bool Test(const T& Value) { return Value >= 0; }
+		static FString Describe() { return TEXT("Gte0"); }
+	};
+
+	/** Numeric > 0 */
+	struct Gt0
+	{
+		static constexpr bool bElementWise = true;
+		template<typename T> static constexpr bool Test(const T& Value) { return Value > 0; }
+		static FString Describe() { return TEXT("Gt0"); }
+	};
+
+	/** Numeric <= 0 */
+	struct Lte0
+	{
+		static constexpr bool bElementWise = true;
+		template<typename T> static constexpr bool Test(const T& Value) { return Value <= 0; }
+		static FString Describe() { return TEXT("Lte0"); }
+	};
+
+	/** Numeric < 0 */
+	struct Lt0
+	{
+		static constexpr bool bElementWise = true;
+		template<typename T> static constexpr bool Test(const T& Value) { return Value < 0; }
+		static FString Describe() { return TEXT("Lt0"); }
+	};
+
+	/** Numeric in [Min, Max]. NaN is never in range. */
+	template<auto Min, auto Max, bool bMinInclusive = true, bool bMaxInclusive = true>
+	struct Range
+	{
+		static_assert(Min <= Max, "Range bounds are reversed");
+
+		static constexpr bool bElementWise = true;
+		template<typename T> static constexpr bool Test(const T& Value)
+		{
+			return (bMinInclusive ? Value >= Min : Value > Min) && (bMaxInclusive ? Value <= Max : Value < Max);
+		}
+		static FString Describe()
+		{
+			return FString::Printf(TEXT("Range%s%s, %s%s"), bMinInclusive ? TEXT("[") : TEXT("("), *LexToString(Min),
+				*LexToString(Max), bMaxInclusive ? TEXT("]") : TEXT(")"));
+		}
+	};
+
+	/** FNames that cannot be NAME_None. */
+	struct Name
+	{
+		static constexpr bool bElementWise = true;
+		static bool Test(const FName& Value) { return !Value.IsNone(); }
+		static FString Describe() { return TEXT("Name"); }
+	};
+
+	/** Must be true (bool) */
+	struct True
+	{
+		static constexpr bool bElementWise = false;
+		static constexpr bool Test(bool Value) { return Value; }
+		static FString Describe() { return TEXT("True"); }
+	};
+
+	/** Must be false (bool) */
+	struct False
+	{
+		static constexpr bool bElementWise = false;
+		static constexpr bool Test(bool Value) { return !Value; }
+		static FString Describe() { return TEXT("False"); }
+	};
+
+	/**
+	 * Pointers of all kinds. UObject pointers (raw, TObjectPtr, TWeakObjectPtr) must point to a valid object, other
+	 * pointers must not be null, and smart pointers (TSharedPtr, ...) must be valid.
+	 */
+	struct MemSafe
+	{
+		static constexpr bool bElementWise = false;
+		template<typename T> static bool Test(const T& Value)
+		{
+			if constexpr (std::is_pointer_v<T>) {
+				if constexpr (std::is_convertible_v<T, const UObject*>) {
+					return IsValid(Value);
+				} else {
+					return Value != nullptr;
+				}
+			} else if constexpr (requires { { Value.Get() } -> std::convertible_to<const UObject*>; }) {
+				return IsValid(Value.Get());
+			} else {
+				return Value.IsValid();
+			}
+		}
+		static FString Describe() { return TEXT("MemSafe"); }
+	};
+
+	/** Containers (TArray, TSet, TOptional) whose pointer values must all pass MemSafe. */
+	struct MemSafeContainer
+	{
+		static constexpr bool bElementWise = false;
+		template<typename T> static bool Test(const T& Value)
+		{
+			if constexpr (requires { Value.IsSet(); Value.GetValue(); }) {
+				return !Value.IsSet() || MemSafe::Test(Value.GetValue());
+			} else {
+				for (const auto& Element : Value) {
+					if (!MemSafe::Test(Element)) {
+						return false;
+					}
+				}
+				return true;
+			}
+		}
+		static FString Describe() { return TEXT("MemSafeContainer"); }
+	};
+
+	/**
+	 * Custom check of the whole struct: a `bool Function() const` member function, or a free `bool Function(const T&)`.
+	 * Appears alone in the table, without a member before it.
+	 */
+	template<auto InFunction>
+	struct Function
+	{
+		static constexpr auto Callable = InFunction;
+	};
+
+	template<typename TRule>
+	concept IsRule = requires {
+		{ TRule::Describe() } -> std::convertible_to<FString>;
+		{ TRule::bElementWise } -> std::convertible_to<bool>;
+	};
+
+	/** A member pointer with its name, for failure messages. See LG_INV_MEMBER. */
+	template<typename TStruct, typename TValue>
+	struct TNamedMember
+	{
+		TValue TStruct::* Member;
+		const TCHAR* Name;
+	};
+
+	template<typename TStruct, typename TValue>
+	constexpr TNamedMember<TStruct, TValue> Member(TValue TStruct::* InMember, const TCHAR* InName)
+	{
+		return { InMember, InName };
+	}
+
+	/** One (member, rule) pair of a table. */
+	template<typename TStruct, typename TValue, typename TRule>
+	struct TMemberInvariant
+	{
+		using FRule = TRule;
+
+		TValue TStruct::* Member;
+		/** Null for bare member pointers. */
+		const TCHAR* Name;
+	};
+
+	/** The table of types that can't declare a static Invariants member. Specialize it with one. */
+	template<typename TStruct>
+	struct TStructInvariants;
+
+	template<typename TStruct>
+	concept HasStructInvariants =
+		requires { TStruct::Invariants; } ||
+		requires { TStructInvariants<TStruct>::Invariants; };
+
+	namespace Private
+	{
+		constexpr std::tuple<> Collect()
+		{
+			return {};
+		}
+
+		template<typename TStruct, typename TValue, typename TRule, typename... TRest>
+		constexpr auto Collect(TValue TStruct::* InMember, TRule, TRest... Rest);
+
+		template<typename TStruct, typename TValue, typename TRule, typename... TRest>
+		constexpr auto Collect(TNamedMember<TStruct, TValue> InMember, TRule, TRest... Rest);
+
+		template<auto InFunction, typename... TRest>
+		constexpr auto Collect(Function<InFunction> InCheck, TRest... Rest);
+
+		template<typename TStruct, typename TValue, typename TRule, typename... TRest>
+		constexpr auto Collect(TValue TStruct::* InMember, TRule, TRest... Rest)
+		{
+			static_assert(IsRule<TRule>, "Every member must be followed by a LifeInv rule");
+			return std::tuple_cat(std::make_tuple(TMemberInvariant<TStruct, TValue, TRule>{ InMember, nullptr }), Collect(Rest...));
+		}
+
+		template<typename TStruct, typename TValue, typename TRule, typename... TRest>
+		constexpr auto Collect(TNamedMember<TStruct, TValue> InMember, TRule, TRest... Rest)
+		{
+			static_assert(IsRule<TRule>, "Every member must be followed by a LifeInv rule");
+			return std::tuple_cat(std::make_tuple(TMemberInvariant<TStruct, TValue, TRule>{ InMember.Member, InMember.Name }), Collect(Rest...));
+		}
+
+		template<auto InFunction, typename... TRest>
+		constexpr auto Collect(Function<InFunction> InCheck, TRest... Rest)
+		{
+			return std::tuple_cat(std::make_tuple(InCheck), Collect(Rest...));
+		}
+
+		/** Numeric rules run on every TArray element. */
+		template<typename TRule, typename TValue>
+		constexpr bool TestValue(const TValue& Value)
+		{
+			if constexpr (TRule::bElementWise && TIsTArray<TValue>::Value) {
+				for (const auto& Element : Value) {
+					if (!TRule::Test(Element)) {
+						return false;
+					}
+				}
+				return true;
+			} else {
+				return TRule::Test(Value);
+			}
+		}
+
+		template<typename TStruct, typename TValue, typename TRule>
+		constexpr bool TestInvariant(const TStruct& Value, const TMemberInvariant<TStruct, TValue, TRule>& Invariant)
+		{
+			return TestValue<TRule>(Value.*Invariant.Member);
+		}
+
+		template<typename TStruct, auto InFunction>
+		constexpr bool TestInvariant(const TStruct& Value, const Function<InFunction>&)
+		{
+			return std::invoke(InFunction, Value);
+		}
+
+		template<typename TValue>
+		FString DescribeValue(const TValue& Value)
+		{
+			if constexpr (std::is_same_v<TValue, FName>) {
+				return Value.ToString();
+			} else if constexpr (std::is_pointer_v<TValue>) {
+				return FString::Printf(TEXT("%p"), static_cast<const void*>(Value));
+			} else if constexpr (requires { LexToString(Value); }) {
+				return LexToString(Value);
+			} else {
+				return TEXT("<value>");
+			}
+		}
+
+		/** "Health Range[0, 100]: 150", or "Resistances[3] Range[0, 1]: 1.5" for an element. */
+		template<typename TStruct, typename TValue, typename TRule>
+		FString DescribeFailure(const TStruct& Value, const TMemberInvariant<TStruct, TValue, TRule>& Invariant, int32 InvariantIndex)
+		{
+			const FString MemberName = Invariant.Name ? FString(Invariant.Name) : FString::Printf(TEXT("member #%d"), InvariantIndex);
+			const TValue& MemberValue = Value.*Invariant.Member;
+			if constexpr (TRule::bElementWise && TIsTArray<TValue>::Value) {
+				for (int32 ElementIndex = 0; ElementIndex < MemberValue.Num(); ++ElementIndex) {
+					if (!TRule::Test(MemberValue[ElementIndex])) {
+						return FString::Printf(TEXT("%s[%d] %s: %s"), *MemberName, ElementIndex, *TRule::Describe(), *DescribeValue(MemberValue[ElementIndex]));
+					}
+				}
+				return FString::Printf(TEXT("%s %s"), *MemberName, *TRule::Describe());
+			} else {
+				return FString::Printf(TEXT("%s %s: %s"), *MemberName, *TRule::Describe(), *DescribeValue(MemberValue));
+			}
+		}
+
+		template<typename TStruct, auto InFunction>
+		FString DescribeFailure(const TStruct&, const Function<InFunction>&, int32 InvariantIndex)
+		{
+			return FString::Printf(TEXT("custom check #%d failed"), InvariantIndex);
+		}
+
+		/** Out of line, so the checks stay small. ValueIndex is the position in a bulk check, INDEX_NONE otherwise. */
+		template<typename TStruct, typename TInvariant>
+		FORCENOINLINE void ReportFailure(const TStruct& Value, const TInvariant& Invariant, int32 InvariantIndex,
+			const TCHAR* Expression, int32 ValueIndex, const Debug::FLifeInvariantCallSite& Site)
+		{
+			const FString Where = ValueIndex != INDEX_NONE ? FString::Printf(TEXT("%s[%d]"), Expression, ValueIndex) : FString(Expression);
+			checkf(false, TEXT("Struct invariant violation on %s: %s @ [%hs:%d]"),
+				*Where, *DescribeFailure(Value, Invariant, InvariantIndex), Site.Function, Site.Line);
+		}
+
+		template<typename TStruct, typename TInvariants, size_t... Indices>
+		void CheckEach(const TStruct& Value, const TInvariants& Invariants, const TCHAR* Expression,
+			const Debug::FLifeInvariantCallSite& Site, std::index_sequence<Indices...>)
+		{
+			([&] {
+				if (UNLIKELY(!TestInvariant(Value, std::get<Indices>(Invariants)))) {
+					ReportFailure(Value, std::get<Indices>(Invariants), Indices, Expression, INDEX_NONE, Site);
+				}
+			}(), ...);
+		}
+
+		/**
+		 * Runs one invariant across all values. The pass is a branchless AND over the values, which the compiler can
+		 * vectorize for numeric members; values are only revisited to find the culprit when it fails.
+		 */
+		template<typename TStruct, typename TInvariant>
+		void CheckColumn(TArrayView<const TStruct> Values, const TInvariant& Invariant, int32 InvariantIndex,
+			const TCHAR* Expression, const Debug::FLifeInvariantCallSite& Site)
+		{
+			bool bAllPass = true;
+			for (const TStruct& Value : Values) {
+				bAllPass &= TestInvariant(Value, Invariant);
+			}
+			if (UNLIKELY(!bAllPass)) {
+				for (int32 ValueIndex = 0; ValueIndex < Values.Num(); ++ValueIndex) {
+					if (!TestInvariant(Values[ValueIndex], Invariant)) {
+						ReportFailure(Values[ValueIndex], Invariant, InvariantIndex, Expression, ValueIndex, Site);
+					}
+				}
+			}
+		}
+
+		template<typename TStruct, typename TInvariants, size_t... Indices>
+		void CheckColumns(TArrayView<const TStruct> Values, const TInvariants& Invariants, const TCHAR* Expression,
+			const Debug::FLifeInvariantCallSite& Site, std::index_sequence<Indices...>)
+		{
+			(CheckColumn(Values, std::get<Indices>(Invariants), Indices, Expression, Site), ...);
+		}
+	}
+
+	/**
+	 * Builds an invariant table from (member, rule) pairs and Function checks, see the top of the file.
+	 */
+	template<typename... TArgs>
+	constexpr auto Make(TArgs... Args)
+	{
+		return Private::Collect(Args...);
+	}
+
+	/** The table of a struct, its static Invariants member or its TStructInvariants specialization. */
+	template<HasStructInvariants TStruct>
+	constexpr const auto& GetInvariants()
+	{
+		if constexpr (requires { TStruct::Invariants; }) {
+			return TStruct::Invariants;
+		} else {
+			return TStructInvariants<TStruct>::Invariants;
+		}
+	}
+
+	/** True if the value passes every invariant of the table. Usable in constant expressions for literal types. */
+	template<typename TStruct, typename TInvariants>
+	constexpr bool Test(const TStruct& Value, const TInvariants& Invariants)
+	{
+		return std::apply([&Value](const auto&... Invariant) {
+			return (Private::TestInvariant(Value, Invariant) && ...);
+		}, Invariants);
+	}
+
+	/** Checks one value, crashing on the first failed invariant like LG_CLASS_INVARIANTS. */
+	template<HasStructInvariants TStruct>
+	void Check(const TStruct& Value, const TCHAR* Expression, const Debug::FLifeInvariantCallSite& Site)
+	{
+		constexpr const auto& Invariants = GetInvariants<TStruct>();
+		Private::CheckEach(Value, Invariants, Expression, Site,
+			std::make_index_sequence<std::tuple_size_v<std::remove_cvref_t<decltype(Invariants)>>>{});
+	}
+
+	/** Checks many values, one invariant at a time across all of them. */
+	template<typename TStruct> requires HasStructInvariants<std::remove_const_t<TStruct>>
+	void CheckAll(TArrayView<TStruct> Values, const TCHAR* Expression, const Debug::FLifeInvariantCallSite& Site)
+	{
+		using FStruct = std::remove_const_t<TStruct>;
+		constexpr const auto& Invariants = GetInvariants<FStruct>();
+		Private::CheckColumns(TArrayView<const FStruct>(Values), Invariants, Expression, Site,
+			std::make_index_sequence<std::tuple_size_v<std::remove_cvref_t<decltype(Invariants)>>>{});
+	}
+}
+
+/** A member pointer that's named in failure messages, e.g. LG_INV_MEMBER(FHealthFragment, Health). */
+#define LG_INV_MEMBER(Struct, InMember) LifeInv::Member(&Struct::InMember, TEXT(#InMember))
+
+#if DO_CHECK
+/**
+ * Checks the invariants of a struct value, see LifeStructInvariants.h.
+ *
+ * @param Value - A value of a struct with an invariant table.
+ */
+#define LG_STRUCT_INVARIANTS(Value) \
+	LifeInv::Check(Value, TEXT(#Value), Debug::FLifeInvariantCallSite{ __FUNCTION__, __FILE__, __LINE__ });
+
+/**
+ * Checks the invariants of many struct values, each invariant across all of them before the next one.
+ *
+ * @param Values - A TArray or TArrayView of a struct with an invariant table.
+ */
+#define LG_STRUCT_INVARIANTS_BULK(Values) \
+	LifeInv::CheckAll(MakeArrayView(Values), TEXT(#Values), Debug::FLifeInvariantCallSite{ __FUNCTION__, __FILE__, __LINE__ });
+#else
+#define LG_STRUCT_INVARIANTS(Value)
+#define LG_STRUCT_INVARIANTS_BULK(Values)
+#endif
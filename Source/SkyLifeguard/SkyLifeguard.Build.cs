@@ -1,5 +1,6 @@
 ﻿// Copyright Epic Games, Inc. All Rights Reserved.
 
+using System.IO;
 using UnrealBuildTool;
 
 public class SkyLifeguard : ModuleRules
@@ -37,6 +38,7 @@ public class SkyLifeguard : ModuleRules
 			{
 				"CoreUObject",
 				"Engine",
+				"Projects",
 				"Slate",
 				"SlateCore",
 				// ... add private dependencies that you statically link with here ...	
@@ -50,5 +52,12 @@ public class SkyLifeguard : ModuleRules
 				// ... add any modules that your module loads dynamically here ...
 			}
 			);
+
+		// Precompiled invariant table, written by the LifeInvariantTable commandlet
+		string InvariantTable = Path.Combine(PluginDirectory, "Content", "Lifeguard", "InvariantTable.bin");
+		if (File.Exists(InvariantTable))
+		{
+			RuntimeDependencies.Add(InvariantTable, StagedFileType.UFS);
+		}
 	}
 }
@@ -0,0 +1,78 @@
+﻿#include "Helpers/Life_Helper_AllocationCounter.h"
+
+#include "HAL/PlatformTLS.h"
+
+FLifeScopedAllocationCounter::FLifeScopedAllocationCounter()
+	: Inner(GMalloc)
+	, OwnerThreadId(FPlatformTLS::GetCurrentThreadId())
+{
+	check(Inner);
+	GMalloc = this;
+}
+
+FLifeScopedAllocationCounter::~FLifeScopedAllocationCounter()
+{
+	check(GMalloc == this);
+	GMalloc = Inner;
+}
+
+void FLifeScopedAllocationCounter::CountAllocation()
+{
+	if (FPlatformTLS::GetCurrentThreadId() == OwnerThreadId) {
+		++NumAllocations;
+	}
+}
+
+void* FLifeScopedAllocationCounter::Malloc(SIZE_T Count, uint32 Alignment)
+{
+	CountAllocation();
+	return Inner->Malloc(Count, Alignment);
+}
+
+void* FLifeScopedAllocationCounter::TryMalloc(SIZE_T Count, uint32 Alignment)
+{
+	CountAllocation();
+	return Inner->TryMalloc(Count, Alignment);
+}
+
+void* FLifeScopedAllocationCounter::Realloc(void* Original, SIZE_T Count, uint32 Alignment)
+{
+	// Shrinking to zero is a free, anything else may hit the allocator
+	if (Count > 0) {
+		CountAllocation();
+	}
+	return Inner->Realloc(Original, Count, Alignment);
+}
+
+void* FLifeScopedAllocationCounter::TryRealloc(void* Original, SIZE_T Count, uint32 Alignment)
+{
+	if (Count > 0) {
+		CountAllocation();
+	}
+	return Inner->TryRealloc(Original, Count, Alignment);
+}
+
+void FLifeScopedAllocationCounter::Free(void* Original)
+{
+	Inner->Free(Original);
+}
+
+SIZE_T FLifeScopedAllocationCounter::QuantizeSize(SIZE_T Count, uint32 Alignment)
+{
+	return Inner->QuantizeSize(Count, Alignment);
+}
+
+bool FLifeScopedAllocationCounter::GetAllocationSize(void* Original, SIZE_T& SizeOut)
+{
+	return Inner->GetAllocationSize(Original, SizeOut);
+}
+
+void FLifeScopedAllocationCounter::Trim(bool bTrimThreadCaches)
+{
+	Inner->Trim(bTrimThreadCaches);
+}
+
+bool FLifeScopedAllocationCounter::IsInternallyThreadSafe() const
+{
+	return Inner->IsInternallyThreadSafe();
+}
@@ -0,0 +1,73 @@
+﻿#include "Helpers/Life_Helper_Benchmark.h"
+
+#include "HAL/FileManager.h"
+#include "Interfaces/IPluginManager.h"
+#include "Misc/App.h"
+#include "Misc/CommandLine.h"
+#include "Misc/EngineVersion.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+/** Benchmark names and versions are plain text, quotes and backslashes are all that needs escaping. */
+static FString EscapeJson(const FString& Text)
+{
+	return Text.Replace(TEXT("\\"), TEXT("\\\\")).Replace(TEXT("\""), TEXT("\\\""));
+}
+
+FString FLifeBenchmarkResult::ToString() const
+{
+	return FString::Printf(TEXT("%s: min %.1f ns, median %.1f ns, p99 %.1f ns, mean %.1f ns (%d samples of %d ops)"),
+		*Name, MinNs, MedianNs, P99Ns, MeanNs, NumSamples, OpsPerSample);
+}
+
+FString FLifeBenchmarkResult::ToJson() const
+{
+	// The run stamp groups the results of one process
+	static const FString RunStamp = FDateTime::Now().ToString();
+
+	const TSharedPtr<IPlugin> Plugin = IPluginManager::Get().FindPlugin(TEXT("SkyLifeguard"));
+	const FString PluginVersion = Plugin.IsValid() ? Plugin->GetDescriptor().VersionName : FString();
+
+	return FString::Printf(TEXT("{\"t\":\"bench\",\"run\":\"%s\",\"name\":\"%s\",\"plugin\":\"%s\",\"engine\":\"%s\",\"config\":\"%s\",")
+		TEXT("\"samples\":%d,\"ops\":%d,\"min_ns\":%.2f,\"median_ns\":%.2f,\"p99_ns\":%.2f,\"mean_ns\":%.2f}"),
+		*RunStamp, *EscapeJson(Name), *EscapeJson(PluginVersion), *EscapeJson(FEngineVersion::Current().ToString()),
+		LexToString(FApp::GetBuildConfiguration()), NumSamples, OpsPerSample, MinNs, MedianNs, P99Ns, MeanNs);
+}
+
+FLifeBenchmarkResult FLifeBenchmark::Summarize(const FString& Name, int32 OpsPerSample, TArray<double>& SampleNs)
+{
+	check(!SampleNs.IsEmpty());
+	SampleNs.Sort();
+
+	double Total = 0.0;
+	for (const double Ns : SampleNs) {
+		Total += Ns;
+	}
+
+	// Nearest-rank percentiles
+	const int32 P99Index = FMath::Clamp(FMath::CeilToInt(SampleNs.Num() * 0.99) - 1, 0, SampleNs.Num() - 1);
+
+	FLifeBenchmarkResult Result;
+	Result.Name = Name;
+	Result.NumSamples = SampleNs.Num();
+	Result.OpsPerSample = OpsPerSample;
+	Result.MinNs = SampleNs[0];
+	Result.MedianNs = SampleNs[SampleNs.Num() / 2];
+	Result.P99Ns = SampleNs[P99Index];
+	Result.MeanNs = Total / SampleNs.Num();
+	return Result;
+}
+
+void FLifeBenchmark::Record(const FLifeBenchmarkResult& Result)
+{
+	const FString Line = Result.ToJson() + TEXT("\n");
+	FFileHelper::SaveStringToFile(Line, *GetResultsPath(), FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM,
+		&IFileManager::Get(), FILEWRITE_Append);
+}
+
+FString FLifeBenchmark::GetResultsPath()
+{
+	FString Path = FPaths::ProjectSavedDir() / TEXT("Lifeguard/Benchmarks.ndjson");
+	FParse::Value(FCommandLine::Get(), TEXT("LifeguardBenchmarks="), Path);
+	return Path;
+}
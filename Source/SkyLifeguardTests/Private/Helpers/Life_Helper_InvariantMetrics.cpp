@@ -1,2 +1,6 @@
 ﻿#include "Helpers/Life_Helper_InvariantMetrics.h"
 
+#include "LifeContracts.h"
+
+LG_REGISTER_NATIVE_INVARIANT(ULifeTestInvariantNativeFuncObj, IsHealthValid)
+LG_REGISTER_NATIVE_INVARIANT(ULifeTestInvariantNativeFuncObj, IsHealthInBounds)
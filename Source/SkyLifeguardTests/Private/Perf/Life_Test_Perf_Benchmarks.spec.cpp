@@ -0,0 +1,744 @@
+﻿#include "LifeChecklist.h"
+#include "LifeContracts.h"
+#include "LifeDagChecklist.h"
+#include "LifeFloodlight.h"
+#include "LifeFloodlightExport.h"
+#include "Helpers/Life_Helper_AllocationCounter.h"
+#include "Helpers/Life_Helper_Benchmark.h"
+#include "Helpers/Life_Helper_BenchmarkObjects.h"
+#include "Helpers/Life_Helper_InvariantMetrics.h"
+#include "Async/Async.h"
+#include "HAL/FileManager.h"
+#include "Misc/CommandLine.h"
+#include "Tasks/Task.h"
+
+BEGIN_DEFINE_SPEC(FLife_Test_Perf_Benchmarks_Spec, "SkyLifeguard.Perf.Benchmarks", EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
+
+	/** Objects made by the current test, unrooted after it. */
+	TArray<UObject*> Rooted;
+	FLifeDomainErrorFloodlight::FConfig SavedFloodlightConfig;
+	bool bSavedVerboseChecklists = true;
+
+	template<typename T>
+	T* MakeRooted()
+	{
+		T* Obj = NewObject<T>();
+		Obj->AddToRoot(); // Prevent GC
+		Rooted.Add(Obj);
+		return Obj;
+	}
+
+	/**
+	 * Restarts Floodlight with the current configuration but another error ring size and text length, exporting to
+	 * ExportPath if it's set.
+	 */
+	void ReinitializeFloodlight(int32 MaxErrorMemoryKB, int32 MaxErrorTextLength, const FString& ExportPath = FString())
+	{
+		FLifeDomainErrorFloodlight::FConfig Config = FLifeDomainErrorFloodlight::GetConfig();
+		Config.MaxErrorMemoryKB = MaxErrorMemoryKB;
+		Config.MaxErrorTextLength = MaxErrorTextLength;
+		Config.ExportPath = ExportPath;
+		FLifeDomainErrorFloodlight::Shutdown();
+		FLifeDomainErrorFloodlight::Initialize(Config);
+	}
+
+	/** Logs the result and appends it to the results file. */
+	void Report(const FLifeBenchmarkResult& Result)
+	{
+		AddInfo(Result.ToString());
+		FLifeBenchmark::Record(Result);
+	}
+
+END_DEFINE_SPEC(FLife_Test_Perf_Benchmarks_Spec)
+
+DEFINE_LOG_CATEGORY_STATIC(LogLifeTestIntercepted, Log, All);
+DEFINE_LOG_CATEGORY_STATIC(LogLifeTestIgnored, Log, All);
+
+
+namespace
+{
+	struct FBenchChecklist
+	{
+		static constexpr const TCHAR* ChecklistName = TEXT("LifeguardBenchmark");
+
+		static constexpr const TCHAR* First  = TEXT("first");
+		static constexpr const TCHAR* Second = TEXT("second");
+
+		static constexpr std::array<const TCHAR*, 2> Steps = { First, Second };
+	};
+
+	struct FBenchDagChecklist
+	{
+		static constexpr const TCHAR* ChecklistName = TEXT("LifeguardBenchmarkDag");
+
+		static constexpr const TCHAR* Atlas  = TEXT("atlas");
+		static constexpr const TCHAR* Domi   = TEXT("domi");
+		static constexpr const TCHAR* Master = TEXT("master");
+
+		static constexpr std::array<LifeCheck::FDagStep, 3> Steps = {{
+			{ Atlas },
+			{ Domi },
+			{ Master, { Atlas, Domi } }
+		}};
+	};
+
+	/** Enough operations per sample that a sample is well above the timer resolution. */
+	int32 OpsForElements(int32 NumElements)
+	{
+		return FMath::Max(1, 10000 / NumElements);
+	}
+
+	/** Points every hard object pointer of Obj, and 8 elements of every pointer array, at Obj itself. */
+	void FillPointers(UObject* Obj)
+	{
+		for (TFieldIterator<FObjectProperty> It(Obj->GetClass()); It; ++It) {
+			It->SetObjectPropertyValue_InContainer(Obj, Obj);
+		}
+		for (TFieldIterator<FArrayProperty> It(Obj->GetClass()); It; ++It) {
+			if (const FObjectProperty* Inner = CastField<FObjectProperty>(It->Inner)) {
+				FScriptArrayHelper_InContainer Array(*It, Obj);
+				Array.AddValues(8);
+				for (int32 Index = 0; Index < Array.Num(); ++Index) {
+					Inner->SetObjectPropertyValue(Array.GetRawPtr(Index), Obj);
+				}
+			}
+		}
+	}
+}
+
+void FLife_Test_Perf_Benchmarks_Spec::Define()
+{
+	AfterEach([this]() {
+		for (UObject* Obj : Rooted) {
+			Obj->RemoveFromRoot();
+		}
+		Rooted.Reset();
+	});
+
+	Describe("Invariants", [this]() {
+        It("Each rule in isolation, 8 properties", [this]()
+        {
+            const TPair<const TCHAR*, UClass*> Rules[] = {
+                { TEXT("MemSafe"), ULifeTestBenchMemSafeObj::StaticClass() },
+                { TEXT("MemSafeContainer"), ULifeTestBenchMemSafeContainerObj::StaticClass() },
+                { TEXT("ID"), ULifeTestBenchIDObj::StaticClass() },
+                { TEXT("Gte0"), ULifeTestBenchGte0Obj::StaticClass() },
+                { TEXT("Gt0"), ULifeTestBenchGt0Obj::StaticClass() },
+                { TEXT("Lte0"), ULifeTestBenchLte0Obj::StaticClass() },
+                { TEXT("Lt0"), ULifeTestBenchLt0Obj::StaticClass() },
+                { TEXT("Range"), ULifeTestBenchRangeObj::StaticClass() },
+                { TEXT("Name"), ULifeTestBenchNameObj::StaticClass() },
+                { TEXT("True"), ULifeTestBenchTrueObj::StaticClass() },
+                { TEXT("False"), ULifeTestBenchFalseObj::StaticClass() },
+            };
+
+            for (const TPair<const TCHAR*, UClass*>& Rule : Rules)
+            {
+                UObject* Obj = NewObject<UObject>(GetTransientPackage(), Rule.Value);
+                Obj->AddToRoot();
+                Rooted.Add(Obj);
+                FillPointers(Obj);
+
+                Report(FLifeBenchmark::Run(FString::Printf(TEXT("Invariants rule %s x8"), Rule.Key), 1000, [Obj]() {
+                    LG_CLASS_INVARIANTS(Obj);
+                }));
+            }
+        });
+
+        It("Custom invariant functions", [this]()
+        {
+            ULifeTestInvariantReflectedFuncObj* Reflected = MakeRooted<ULifeTestInvariantReflectedFuncObj>();
+            Report(FLifeBenchmark::Run(TEXT("Invariants UFUNCTION x2 (ProcessEvent)"), 1000, [Reflected]() {
+                LG_CLASS_INVARIANTS(Reflected);
+            }));
+
+            ULifeTestInvariantNativeFuncObj* Native = MakeRooted<ULifeTestInvariantNativeFuncObj>();
+            Report(FLifeBenchmark::Run(TEXT("Invariants native function x2"), 1000, [Native]() {
+                LG_CLASS_INVARIANTS(Native);
+            }));
+        });
+
+        It("Containers of 10, 1k and 100k elements", [this]()
+        {
+            for (const int32 NumElements : { 10, 1000, 100000 })
+            {
+                const int32 Ops = OpsForElements(NumElements);
+
+                ULifeTestBenchContainerObj* Floats = MakeRooted<ULifeTestBenchContainerObj>();
+                Floats->Floats.Init(0.5f, NumElements);
+                Report(FLifeBenchmark::Run(FString::Printf(TEXT("Invariants TArray<float> Range x%d"), NumElements), Ops, [Floats]() {
+                    LG_CLASS_INVARIANTS(Floats);
+                }));
+
+                ULifeTestBenchContainerObj* Ints = MakeRooted<ULifeTestBenchContainerObj>();
+                Ints->Ints.Init(1, NumElements);
+                Report(FLifeBenchmark::Run(FString::Printf(TEXT("Invariants TArray<int32> Gte0 x%d"), NumElements), Ops, [Ints]() {
+                    LG_CLASS_INVARIANTS(Ints);
+                }));
+
+                ULifeTestBenchContainerObj* Ids = MakeRooted<ULifeTestBenchContainerObj>();
+                ULifeTestBenchContainerObj* Weights = MakeRooted<ULifeTestBenchContainerObj>();
+                ULifeTestBenchContainerObj* Objects = MakeRooted<ULifeTestBenchContainerObj>();
+                Ids->Ids.Reserve(NumElements);
+                Weights->Weights.Reserve(NumElements);
+                for (int32 Index = 0; Index < NumElements; ++Index)
+                {
+                    Ids->Ids.Add(Index);
+                    Weights->Weights.Add(Index, 0.5f);
+                }
+                Objects->Objects.Init(Objects, NumElements);
+
+                Report(FLifeBenchmark::Run(FString::Printf(TEXT("Invariants TSet<int32> ID x%d"), NumElements), Ops, [Ids]() {
+                    LG_CLASS_INVARIANTS(Ids);
+                }));
+                Report(FLifeBenchmark::Run(FString::Printf(TEXT("Invariants TMap<int32, float> Range x%d"), NumElements), Ops, [Weights]() {
+                    LG_CLASS_INVARIANTS(Weights);
+                }));
+                Report(FLifeBenchmark::Run(FString::Printf(TEXT("Invariants TArray<UObject*> MemSafeContainer x%d"), NumElements), Ops, [Objects]() {
+                    LG_CLASS_INVARIANTS(Objects);
+                }));
+            }
+        });
+
+        It("Contract* chains of depth 1, 4, 16 and 64", [this]()
+        {
+            for (const int32 Depth : { 1, 4, 16, 64 })
+            {
+                UObject* Next = MakeRooted<ULifeTestBenchGte0Obj>();
+                for (int32 Link = Depth - 1; Link >= 0; --Link)
+                {
+                    ULifeTestBenchContractNodeObj* Node = MakeRooted<ULifeTestBenchContractNodeObj>();
+                    Node->Next = Next;
+                    Node->Depth = Link;
+                    Next = Node;
+                }
+
+                Report(FLifeBenchmark::Run(FString::Printf(TEXT("Invariants Contract* depth %d"), Depth), FMath::Max(1, 1000 / Depth), [Next]() {
+                    LG_CLASS_INVARIANTS(Next);
+                }));
+            }
+        });
+	});
+
+	Describe("Floodlight", [this]() {
+        // A budget that can't run out, and no sounds. The module's configuration is restored afterwards.
+        BeforeEach([this]()
+        {
+            SavedFloodlightConfig = FLifeDomainErrorFloodlight::GetConfig();
+            FLifeDomainErrorFloodlight::FConfig Config = SavedFloodlightConfig;
+            Config.MaxBudget = MAX_int32;
+            Config.bPlaySounds = false;
+            FLifeDomainErrorFloodlight::Shutdown();
+            FLifeDomainErrorFloodlight::Initialize(Config);
+
+            // New errors are logged as errors, duplicates aren't
+            AddExpectedError(TEXT("[DOMAIN WARNING]"), EAutomationExpectedErrorFlags::Contains, 0, false);
+        });
+
+        AfterEach([this]()
+        {
+            FLifeDomainErrorFloodlight::Shutdown();
+            FLifeDomainErrorFloodlight::Initialize(SavedFloodlightConfig);
+        });
+
+        It("Report throughput with duplicates", [this]()
+        {
+            TArray<FString> Messages;
+            for (int32 Index = 0; Index < 16; ++Index)
+            {
+                Messages.Add(FString::Printf(TEXT("Benchmark error %d"), Index));
+            }
+            const FString Context = TEXT("Life_Test_Perf_Benchmarks");
+
+            Report(FLifeBenchmark::Run(TEXT("Floodlight ReportWarning, 1 error"), 1000, [&Messages, &Context]() {
+                FLifeDomainErrorFloodlight::ReportWarning(Messages[0], Context);
+            }));
+
+            int32 Next = 0;
+            Report(FLifeBenchmark::Run(TEXT("Floodlight ReportWarning, 16 errors"), 1000, [&Messages, &Context, &Next]() {
+                FLifeDomainErrorFloodlight::ReportWarning(Messages[Next++ & 15], Context);
+            }));
+
+            Report(FLifeBenchmark::Run(TEXT("Floodlight LG_DOMAIN_WARNING, 16 errors"), 1000, [&Next]() {
+                LG_DOMAIN_WARNING(TEXT("Benchmark error %d"), Next++ & 15);
+            }));
+
+            TestEqual(TEXT("Duplicates don't add errors"), FLifeDomainErrorFloodlight::GetNumActiveErrors(), 1 + 16 + 16 - 1);
+        });
+
+        It("Coalesces the reports of a frame", [this]()
+        {
+            // One line for the error and its 99 repeats in the first batch, later batches are only repeats
+            AddExpectedError(TEXT("(x100 this frame)"), EAutomationExpectedErrorFlags::Contains, 1);
+
+            const FString Message = TEXT("Coalesced benchmark error");
+            const FString Context = TEXT("Life_Test_Perf_Benchmarks");
+            const int32 WarningCost = FLifeDomainErrorFloodlight::GetConfig().WarningCost;
+            Report(FLifeBenchmark::Run(TEXT("Floodlight ReportWarning batch of 100, applied by Tick"), 1, [&Message, &Context]() {
+                for (int32 i = 0; i < 100; ++i)
+                {
+                    FLifeDomainErrorFloodlight::ReportWarning(Message, Context);
+                }
+                FLifeDomainErrorFloodlight::Tick(0.0f);
+            }));
+
+            const int32 NumReports = (FLifeBenchmark::DefaultSamples + FLifeBenchmark::DefaultWarmupSamples) * 100;
+            TestEqual(TEXT("Budget of every report"), FLifeDomainErrorFloodlight::GetCurrentBudget(), NumReports * WarningCost);
+
+            // The budget counts reports as they come in, before Tick applies them
+            FLifeDomainErrorFloodlight::ReportWarning(Message, Context);
+            TestEqual(TEXT("Budget before Tick"), FLifeDomainErrorFloodlight::GetCurrentBudget(), (NumReports + 1) * WarningCost);
+            FLifeDomainErrorFloodlight::Tick(0.0f);
+            TestEqual(TEXT("Budget after Tick"), FLifeDomainErrorFloodlight::GetCurrentBudget(), (NumReports + 1) * WarningCost);
+            TestEqual(TEXT("Occurrences"), FLifeDomainErrorFloodlight::GetActiveError(0).OccurrenceCount, NumReports + 1);
+        });
+
+        It("Evicts the oldest error and brings its count back", [this]()
+        {
+            // Errors evicted before their batch is applied are logged as a count
+            AddExpectedError(TEXT("more new errors this frame"), EAutomationExpectedErrorFlags::Contains, 0);
+
+            ReinitializeFloodlight(1, 16);
+            const int32 Capacity = FLifeDomainErrorFloodlight::GetErrorCapacity();
+            if (!TestTrue(TEXT("The ring holds a few errors"), Capacity >= 2)) {
+                return;
+            }
+
+            const FString Context = TEXT("Ctx");
+            FLifeDomainErrorFloodlight::ReportWarning(TEXT("Error 0"), Context);
+            FLifeDomainErrorFloodlight::ReportWarning(TEXT("Error 0"), Context);
+            for (int32 Index = 1; Index <= Capacity; ++Index)
+            {
+                FLifeDomainErrorFloodlight::ReportWarning(FString::Printf(TEXT("Error %d"), Index), Context);
+            }
+
+            const FLifeDomainErrorOverflow& Overflow = FLifeDomainErrorFloodlight::GetOverflow();
+            TestEqual(TEXT("Active errors"), FLifeDomainErrorFloodlight::GetNumActiveErrors(), Capacity);
+            TestEqual(TEXT("Oldest active error"), FString(FLifeDomainErrorFloodlight::GetActiveError(0).Message), FString(TEXT("Error 1")));
+            TestEqual(TEXT("Newest active error"), FString(FLifeDomainErrorFloodlight::GetActiveError(Capacity - 1).Message), FString::Printf(TEXT("Error %d"), Capacity));
+            TestEqual(TEXT("Evicted errors"), Overflow.NumErrors, 1);
+            TestEqual(TEXT("Evicted warnings"), Overflow.NumWarnings, 1);
+            TestEqual(TEXT("Evicted reports"), Overflow.OccurrenceCount, 2);
+
+            // Comes back with both earlier reports, and pushes Error 1 out
+            const uint64 EvictedSignature = FLifeDomainErrorFloodlight::GetActiveError(0).Signature;
+            FLifeDomainErrorFloodlight::ReportWarning(TEXT("Error 0"), Context);
+            const FLifeDomainError& Returned = FLifeDomainErrorFloodlight::GetActiveError(Capacity - 1);
+            TestEqual(TEXT("Returned error"), FString(Returned.Message), FString(TEXT("Error 0")));
+            TestEqual(TEXT("Returned error count"), Returned.OccurrenceCount, 3);
+            TestEqual(TEXT("Oldest active error after the return"), FString(FLifeDomainErrorFloodlight::GetActiveError(0).Message), FString(TEXT("Error 2")));
+            TestEqual(TEXT("Evicted errors after the return"), Overflow.NumErrors, 1);
+            TestEqual(TEXT("Evicted reports after the return"), Overflow.OccurrenceCount, 1);
+            TestEqual(TEXT("Count of the evicted error"), FLifeDomainErrorFloodlight::GetOccurrenceCount(EvictedSignature), 1);
+        });
+
+        It("Deduplicates errors whose text was truncated", [this]()
+        {
+            ReinitializeFloodlight(256, 16);
+
+            // The context takes 3 of the 16 characters, the message the rest
+            const FString Context = TEXT("Ctx");
+            const FString Message = TEXT("A long message that is cut");
+            FLifeDomainErrorFloodlight::ReportWarning(Message, Context);
+            FLifeDomainErrorFloodlight::ReportWarning(Message, Context);
+            // Same stored prefix, but a different signature
+            FLifeDomainErrorFloodlight::ReportWarning(TEXT("A long message that differs"), Context);
+
+            if (TestEqual(TEXT("Active errors"), FLifeDomainErrorFloodlight::GetNumActiveErrors(), 2)) {
+                const FLifeDomainError& Truncated = FLifeDomainErrorFloodlight::GetActiveError(0);
+                TestEqual(TEXT("Stored message"), FString(Truncated.Message), Message.Left(16 - Context.Len()));
+                TestEqual(TEXT("Stored context"), FString(Truncated.Context), Context);
+                TestEqual(TEXT("Repeats of the truncated error"), Truncated.OccurrenceCount, 2);
+                TestEqual(TEXT("Reports of the other error"), FLifeDomainErrorFloodlight::GetActiveError(1).OccurrenceCount, 1);
+            }
+        });
+
+        It("Finds the remaining errors after an acknowledge", [this]()
+        {
+            AddExpectedError(TEXT("more new errors this frame"), EAutomationExpectedErrorFlags::Contains, 0);
+
+            const FString Context = TEXT("Ctx");
+            FLifeDomainErrorFloodlight::ReportWarning(TEXT("Error A"), Context);
+            FLifeDomainErrorFloodlight::ReportWarning(TEXT("Error B"), Context);
+            FLifeDomainErrorFloodlight::ReportWarning(TEXT("Error C"), Context);
+            FLifeDomainErrorFloodlight::AcknowledgeError(0);
+
+            // B and C moved one slot, repeats must still find them
+            FLifeDomainErrorFloodlight::ReportWarning(TEXT("Error B"), Context);
+            FLifeDomainErrorFloodlight::ReportWarning(TEXT("Error C"), Context);
+            FLifeDomainErrorFloodlight::ReportWarning(TEXT("Error C"), Context);
+            if (TestEqual(TEXT("Active errors"), FLifeDomainErrorFloodlight::GetNumActiveErrors(), 2)) {
+                TestEqual(TEXT("First error"), FString(FLifeDomainErrorFloodlight::GetActiveError(0).Message), FString(TEXT("Error B")));
+                TestEqual(TEXT("Repeats of B"), FLifeDomainErrorFloodlight::GetActiveError(0).OccurrenceCount, 2);
+                TestEqual(TEXT("Repeats of C"), FLifeDomainErrorFloodlight::GetActiveError(1).OccurrenceCount, 3);
+            }
+
+            // An acknowledged error starts over
+            FLifeDomainErrorFloodlight::ReportWarning(TEXT("Error A"), Context);
+            if (TestEqual(TEXT("Active errors after A returns"), FLifeDomainErrorFloodlight::GetNumActiveErrors(), 3)) {
+                TestEqual(TEXT("Reports of A"), FLifeDomainErrorFloodlight::GetActiveError(2).OccurrenceCount, 1);
+            }
+        });
+
+        It("Applies reports from other threads on Tick", [this]()
+        {
+            const int32 NumThreads = 4;
+            const int32 NumReports = 100;
+            const int32 BudgetBefore = FLifeDomainErrorFloodlight::GetCurrentBudget();
+
+            TArray<TFuture<void>> Futures;
+            for (int32 Thread = 0; Thread < NumThreads; ++Thread)
+            {
+                Futures.Add(Async(EAsyncExecution::Thread, [Thread, NumReports]()
+                {
+                    const FString Message = FString::Printf(TEXT("Worker error %d"), Thread);
+                    for (int32 i = 0; i < NumReports; ++i)
+                    {
+                        FLifeDomainErrorFloodlight::ReportWarning(Message, TEXT("Worker"));
+                    }
+                }));
+            }
+            for (TFuture<void>& Future : Futures)
+            {
+                Future.Wait();
+            }
+
+            TestEqual(TEXT("Queued reports wait for the game thread"), FLifeDomainErrorFloodlight::GetNumActiveErrors(), 0);
+            FLifeDomainErrorFloodlight::Tick(0.0f);
+
+            int32 NumOccurrences = 0;
+            for (int32 Index = 0; Index < FLifeDomainErrorFloodlight::GetNumActiveErrors(); ++Index)
+            {
+                NumOccurrences += FLifeDomainErrorFloodlight::GetActiveError(Index).OccurrenceCount;
+            }
+            TestEqual(TEXT("One error per thread"), FLifeDomainErrorFloodlight::GetNumActiveErrors(), NumThreads);
+            TestEqual(TEXT("Every report applied"), NumOccurrences, NumThreads * NumReports);
+            TestEqual(TEXT("Budget of every report"), FLifeDomainErrorFloodlight::GetCurrentBudget() - BudgetBefore,
+                NumThreads * NumReports * FLifeDomainErrorFloodlight::GetConfig().WarningCost);
+        });
+
+        It("Only turns intercepted log categories into errors", [this]()
+        {
+            AddExpectedError(TEXT("Floodlight filter test"), EAutomationExpectedErrorFlags::Contains, 0);
+
+            const FName Category = LogLifeTestIntercepted.GetCategoryName();
+            FLifeDomainErrorFloodlight::RegisterInterceptCategory(Category);
+            UE_LOG(LogLifeTestIntercepted, Warning, TEXT("Floodlight filter test, intercepted"));
+            UE_LOG(LogLifeTestIntercepted, Log, TEXT("Floodlight filter test, below Warning"));
+            UE_LOG(LogLifeTestIgnored, Warning, TEXT("Floodlight filter test, other category"));
+            FLifeDomainErrorFloodlight::UnregisterInterceptCategory(Category);
+            UE_LOG(LogLifeTestIntercepted, Warning, TEXT("Floodlight filter test, after unregistering"));
+
+            GLog->Flush();
+            FLifeDomainErrorFloodlight::Tick(0.0f);
+
+            if (TestEqual(TEXT("Intercepted errors"), FLifeDomainErrorFloodlight::GetNumActiveErrors(), 1)) {
+                const FLifeDomainError& Error = FLifeDomainErrorFloodlight::GetActiveError(0);
+                TestTrue(TEXT("The intercepted line"), FString(Error.Message).Contains(TEXT("intercepted")));
+                TestEqual(TEXT("Context"), FString(Error.Context), FString::Printf(TEXT("Log Category: %s"), *Category.ToString()));
+            }
+        });
+
+        It("Exports errors that the merge adds up across runs", [this]()
+        {
+            // The command line would override the test's export files
+            FString CommandLineExport;
+            if (FParse::Value(FCommandLine::Get(), TEXT("FloodlightExport="), CommandLineExport)) {
+                AddInfo(TEXT("Skipped, -FloodlightExport is set"));
+                return;
+            }
+            AddExpectedError(TEXT("more new errors this frame"), EAutomationExpectedErrorFlags::Contains, 0);
+
+            const FString Dir = FPaths::AutomationTransientDir() / TEXT("FloodlightExport");
+            IFileManager::Get().DeleteDirectory(*Dir, false, true);
+            const FString Context = TEXT("Ctx");
+            const FString Quoted = TEXT("Said \"hi\" in C:\\Temp\\");
+
+            // First run: the returning error is written once, its later reports as counts
+            const FString FirstRun = Dir / TEXT("Run0.ndjson");
+            ReinitializeFloodlight(1, 64, FirstRun);
+            const int32 Capacity = FLifeDomainErrorFloodlight::GetErrorCapacity();
+            if (!TestTrue(TEXT("The ring holds a few errors"), Capacity >= 3)) {
+                return;
+            }
+            FLifeDomainErrorFloodlight::ReportWarning(TEXT("Error 0"), Context);
+            FLifeDomainErrorFloodlight::ReportWarning(TEXT("Error 0"), Context);
+            for (int32 Index = 1; Index <= Capacity; ++Index)
+            {
+                FLifeDomainErrorFloodlight::ReportWarning(FString::Printf(TEXT("Filler %d"), Index), Context);
+            }
+            TestEqual(TEXT("Error 0 was evicted"), FLifeDomainErrorFloodlight::GetOverflow().NumErrors, 1);
+            FLifeDomainErrorFloodlight::ReportWarning(TEXT("Error 0"), Context);
+            FLifeDomainErrorFloodlight::ReportWarning(Quoted, Context);
+            FLifeDomainErrorFloodlight::ReportWarning(Quoted, Context);
+            const uint64 ReturnedSignature = FLifeDomainErrorFloodlight::GetActiveError(Capacity - 2).Signature;
+            const uint64 QuotedSignature = FLifeDomainErrorFloodlight::GetActiveError(Capacity - 1).Signature;
+            const uint64 FillerSignature = FLifeDomainErrorFloodlight::GetActiveError(0).Signature;
+
+            // Second run, appended as its own file
+            const FString SecondRun = Dir / TEXT("Run1.ndjson");
+            ReinitializeFloodlight(1, 64, SecondRun);
+            FLifeDomainErrorFloodlight::ReportWarning(TEXT("Error 0"), Context);
+            FLifeDomainErrorFloodlight::ReportWarning(Quoted, Context);
+            // Flushes and closes the second file
+            ReinitializeFloodlight(1, 64);
+
+            FLifeMergedErrorSignatures First;
+            FLifeMergedErrorSignatures Second;
+            if (!TestTrue(TEXT("First run parsed"), FLifeDomainErrorExportMerger::ParseFile(FirstRun, First))
+                || !TestTrue(TEXT("Second run parsed"), FLifeDomainErrorExportMerger::ParseFile(SecondRun, Second))) {
+                return;
+            }
+            TestEqual(TEXT("Signatures of the first run"), First.Num(), Capacity + 2);
+            if (const FLifeMergedErrorSignature* Returned = First.Find(ReturnedSignature)) {
+                TestEqual(TEXT("Reports of the returning error in the first run"), Returned->Count, static_cast<int64>(3));
+            }
+            else {
+                AddError(TEXT("The returning error is missing from the first run"));
+            }
+
+            FLifeMergedErrorSignatures Merged;
+            FLifeDomainErrorExportMerger::Merge(Merged, First);
+            FLifeDomainErrorExportMerger::Merge(Merged, Second);
+            TestEqual(TEXT("Merged signatures"), Merged.Num(), Capacity + 2);
+
+            const FLifeMergedErrorSignature* Returned = Merged.Find(ReturnedSignature);
+            const FLifeMergedErrorSignature* QuotedMerged = Merged.Find(QuotedSignature);
+            const FLifeMergedErrorSignature* Filler = Merged.Find(FillerSignature);
+            if (!TestNotNull(TEXT("Returning error merged"), Returned) || !TestNotNull(TEXT("Quoted error merged"), QuotedMerged)
+                || !TestNotNull(TEXT("Filler merged"), Filler)) {
+                return;
+            }
+            TestEqual(TEXT("Reports of the returning error"), Returned->Count, static_cast<int64>(4));
+            TestEqual(TEXT("Files of the returning error"), Returned->NumFiles, 2);
+            TestEqual(TEXT("Reports of the quoted error"), QuotedMerged->Count, static_cast<int64>(3));
+            TestEqual(TEXT("Files of the quoted error"), QuotedMerged->NumFiles, 2);
+            // Still escaped as in the file
+            TestEqual(TEXT("Quoted message"), QuotedMerged->Message, FString(TEXT("Said \\\"hi\\\" in C:\\\\Temp\\\\")));
+            TestEqual(TEXT("Quoted context"), QuotedMerged->Context, Context);
+            TestEqual(TEXT("Reports of a filler"), Filler->Count, static_cast<int64>(1));
+            TestEqual(TEXT("Files of a filler"), Filler->NumFiles, 1);
+        });
+	});
+
+	Describe("Contracts", [this]() {
+        It("Passing checks only test their condition", [this]()
+        {
+            // The counter keeps the conditions from being hoisted out of the loops
+            int32 Next = 0;
+            int32 NumFailed = 0;
+            Report(FLifeBenchmark::Run(TEXT("Contract baseline, bare condition"), 1000, [&]() {
+                if (UNLIKELY(Next++ < 0)) {
+                    ++NumFailed;
+                }
+            }));
+
+            Report(FLifeBenchmark::Run(TEXT("Contract LG_PRECOND"), 1000, [&Next]() {
+                LG_PRECOND(Next++ >= 0);
+            }));
+
+            Report(FLifeBenchmark::Run(TEXT("Contract LG_CONTRACT_CHECK_MSG, FString message"), 1000, [&Next]() {
+                LG_CONTRACT_CHECK_MSG(Next++ >= 0, FString::Printf(TEXT("Next is %d"), Next));
+            }));
+
+            Report(FLifeBenchmark::Run(TEXT("Contract LG_CONTRACT_CHECK_LAZY, Printf message"), 1000, [&Next]() {
+                LG_CONTRACT_CHECK_LAZY(Next++ >= 0, [&Next]() { return FString::Printf(TEXT("Next is %d"), Next); });
+            }));
+
+            FLifeChecklistRegistry::Get().Register<FBenchChecklist>();
+            FName ChecklistName(FBenchChecklist::ChecklistName);
+            LG_RESET_CHECKLIST(ChecklistName);
+            {
+                LG_SCOPED_CHECKLIST_STEP_T(FBenchChecklist, First);
+            }
+            {
+                LG_SCOPED_CHECKLIST_STEP_T(FBenchChecklist, Second);
+            }
+
+            // Building any of the messages would allocate
+            int32 NumAllocations = 0;
+            {
+                FLifeScopedAllocationCounter Counter;
+                for (int32 i = 0; i < 100; ++i)
+                {
+                    LG_CONTRACT_CHECK_MSG(Next++ >= 0, FString::Printf(TEXT("Next is %d"), Next));
+                    LG_CONTRACT_CHECK_LAZY(Next++ >= 0, [&Next]() { return FString::Printf(TEXT("Next is %d"), Next); });
+                    LG_ENSURE_CHECKLIST_DONE(ChecklistName);
+                }
+                NumAllocations = Counter.GetNumAllocations();
+            }
+
+            TestEqual(TEXT("Heap allocations across 300 passing checks with messages"), NumAllocations, 0);
+            TestEqual(TEXT("No baseline check failed"), NumFailed, 0);
+        });
+
+        It("Failing checks report their message", [this]()
+        {
+#if DO_CHECK
+            TArray<FString> Failures;
+            Debug::SetCheckFailureHook([&Failures](const FString& Message) { Failures.Add(Message); });
+
+            const int32 Value = -1;
+            int32 NumFormatted = 0;
+            LG_PRECOND(Value >= 0);
+            LG_CONTRACT_CHECK_LAZY(Value >= 0, [&]() { ++NumFormatted; return FString::Printf(TEXT("Value is %d"), Value); });
+            LG_CHECK_LAZY(Value >= 0, [&]() { ++NumFormatted; return FString::Printf(TEXT("Value is %d"), Value); });
+
+            Debug::SetCheckFailureHook(nullptr);
+
+            if (TestEqual(TEXT("Failed checks"), Failures.Num(), 3)) {
+                TestTrue(TEXT("LG_PRECOND names the contract"), Failures[0].Contains(TEXT("Contract violation (Precondition)")));
+                TestTrue(TEXT("LG_PRECOND names the expression"), Failures[0].Contains(TEXT("[Value >= 0]")));
+                TestTrue(TEXT("LG_CONTRACT_CHECK_LAZY formats its message"), Failures[1].StartsWith(TEXT("Contract violation (Value is -1): [Value >= 0]")));
+                TestEqual(TEXT("LG_CHECK_LAZY passes its message as is"), Failures[2], FString(TEXT("Value is -1")));
+            }
+            TestEqual(TEXT("Messages formatted"), NumFormatted, 2);
+#endif
+        });
+	});
+
+	Describe("Checklists", [this]() {
+        // Step logging would be most of what the checklist benchmarks measure
+        BeforeEach([this]()
+        {
+            IConsoleVariable* VerboseVar = IConsoleManager::Get().FindConsoleVariable(TEXT("Lifeguard.Checklists.Verbose"));
+            if (TestNotNull(TEXT("Lifeguard.Checklists.Verbose exists"), VerboseVar)) {
+                bSavedVerboseChecklists = VerboseVar->GetBool();
+                VerboseVar->Set(false, ECVF_SetByCode);
+            }
+        });
+
+        AfterEach([this]()
+        {
+            if (IConsoleVariable* VerboseVar = IConsoleManager::Get().FindConsoleVariable(TEXT("Lifeguard.Checklists.Verbose"))) {
+                VerboseVar->Set(bSavedVerboseChecklists, ECVF_SetByCode);
+            }
+        });
+
+        It("Scope enter and exit", [this]()
+        {
+            FLifeChecklistRegistry::Get().Register<FBenchChecklist>();
+            FLifeDagChecklistRegistry::Get().Register<FBenchDagChecklist>();
+
+            FName ChecklistName(FBenchChecklist::ChecklistName);
+            FName First(FBenchChecklist::First);
+            FName Second(FBenchChecklist::Second);
+            Report(FLifeBenchmark::Run(TEXT("Checklist FName scope, reset + 2 steps"), 1000, [&]() {
+                LG_RESET_CHECKLIST(ChecklistName);
+                {
+                    LG_SCOPED_CHECKLIST_STEP(ChecklistName, First);
+                }
+                {
+                    LG_SCOPED_CHECKLIST_STEP(ChecklistName, Second);
+                }
+            }));
+
+            Report(FLifeBenchmark::Run(TEXT("Checklist typed scope, reset + 2 steps"), 1000, []() {
+                LG_RESET_CHECKLIST(FBenchChecklist::ChecklistName);
+                {
+                    LG_SCOPED_CHECKLIST_STEP_T(FBenchChecklist, First);
+                }
+                {
+                    LG_SCOPED_CHECKLIST_STEP_T(FBenchChecklist, Second);
+                }
+            }));
+
+            Report(FLifeBenchmark::Run(TEXT("Checklist DAG scope, reset + 3 steps"), 1000, []() {
+                LG_RESET_DAG_CHECKLIST(FBenchDagChecklist);
+                {
+                    LG_SCOPED_DAG_CHECKLIST_STEP(FBenchDagChecklist, Atlas);
+                }
+                {
+                    LG_SCOPED_DAG_CHECKLIST_STEP(FBenchDagChecklist, Domi);
+                }
+                {
+                    LG_SCOPED_DAG_CHECKLIST_STEP(FBenchDagChecklist, Master);
+                }
+            }));
+
+            TestTrue(TEXT("The typed checklist ran to completion"), FLifeChecklistRegistry::Get().IsChecklistDone(ChecklistName));
+            TestTrue(TEXT("The DAG checklist ran to completion"), FLifeDagChecklistRegistry::GetState<FBenchDagChecklist>().IsDone());
+        });
+
+        It("DAG steps complete concurrently on tasks before the step that needs them", [this]()
+        {
+            FLifeDagChecklistRegistry::Get().Register<FBenchDagChecklist>();
+            LG_RESET_DAG_CHECKLIST(FBenchDagChecklist);
+            FLifeDagChecklistState& State = FLifeDagChecklistRegistry::GetState<FBenchDagChecklist>();
+            const int32 AtlasIndex = LifeCheck::FindDagStepIndex<FBenchDagChecklist>(FBenchDagChecklist::Atlas);
+            const int32 DomiIndex = LifeCheck::FindDagStepIndex<FBenchDagChecklist>(FBenchDagChecklist::Domi);
+
+            // Each independent step stays in flight until the other one began too, or a second went by
+            std::atomic<int32> NumBegun{0};
+            std::atomic<bool> bOverlapped{false};
+            const auto WaitForOtherStep = [&NumBegun, &bOverlapped]()
+            {
+                ++NumBegun;
+                const double Deadline = FPlatformTime::Seconds() + 1.0;
+                while (NumBegun.load() < 2 && FPlatformTime::Seconds() < Deadline)
+                {
+                    FPlatformProcess::Yield();
+                }
+                if (NumBegun.load() == 2) {
+                    bOverlapped = true;
+                }
+            };
+
+            UE::Tasks::FTask Atlas = UE::Tasks::Launch(TEXT("LifeTestDagAtlas"), [&WaitForOtherStep]()
+            {
+                LG_SCOPED_DAG_CHECKLIST_STEP(FBenchDagChecklist, Atlas);
+                WaitForOtherStep();
+            });
+            UE::Tasks::FTask Domi = UE::Tasks::Launch(TEXT("LifeTestDagDomi"), [&WaitForOtherStep]()
+            {
+                LG_SCOPED_DAG_CHECKLIST_STEP(FBenchDagChecklist, Domi);
+                WaitForOtherStep();
+            });
+
+            bool bMasterSawBoth = false;
+            UE::Tasks::FTask Master = UE::Tasks::Launch(TEXT("LifeTestDagMaster"), [&State, &bMasterSawBoth, AtlasIndex, DomiIndex]()
+            {
+                LG_SCOPED_DAG_CHECKLIST_STEP(FBenchDagChecklist, Master);
+                bMasterSawBoth = State.IsStepDone(AtlasIndex) && State.IsStepDone(DomiIndex);
+            }, UE::Tasks::Prerequisites(Atlas, Domi));
+            Master.Wait();
+
+            TestTrue(TEXT("The independent steps were in flight together"), bOverlapped.load());
+            TestTrue(TEXT("The final step saw both prerequisites done"), bMasterSawBoth);
+            TestTrue(TEXT("The DAG checklist ran to completion"), State.IsDone());
+        });
+
+        It("DAG checklists name the missing steps", [this]()
+        {
+            FLifeDagChecklistRegistry::Get().Register<FBenchDagChecklist>();
+            LG_RESET_DAG_CHECKLIST(FBenchDagChecklist);
+            FLifeDagChecklistState& State = FLifeDagChecklistRegistry::GetState<FBenchDagChecklist>();
+            const int32 MasterIndex = LifeCheck::FindDagStepIndex<FBenchDagChecklist>(FBenchDagChecklist::Master);
+
+            // What BeginStep names when it refuses to begin the step
+            const auto DescribeMissingPrerequisites = [&State, MasterIndex]()
+            {
+                return State.DescribeSteps(State.PrerequisiteMasks[MasterIndex] & ~State.DoneMask.load());
+            };
+            TestEqual(TEXT("Missing prerequisites, nothing done"), DescribeMissingPrerequisites(), FString(TEXT("atlas, domi")));
+            {
+                LG_SCOPED_DAG_CHECKLIST_STEP(FBenchDagChecklist, Atlas);
+            }
+            TestEqual(TEXT("Missing prerequisites, atlas done"), DescribeMissingPrerequisites(), FString(TEXT("domi")));
+
+#if DO_CHECK
+            TArray<FString> Failures;
+            Debug::SetCheckFailureHook([&Failures](const FString& Message) { Failures.Add(Message); });
+            LG_ENSURE_DAG_CHECKLIST_DONE(FBenchDagChecklist);
+            Debug::SetCheckFailureHook(nullptr);
+
+            if (TestEqual(TEXT("Failed checks"), Failures.Num(), 1)) {
+                TestTrue(TEXT("LG_ENSURE_DAG_CHECKLIST_DONE names the missing steps"),
+                    Failures[0].Contains(TEXT("Checklist 'LifeguardBenchmarkDag' not done (missing: domi, master)")));
+            }
+#endif
+
+            LG_RESET_DAG_CHECKLIST(FBenchDagChecklist);
+        });
+	});
+}
@@ -1,11 +1,116 @@
 ﻿#include "LifeContracts.h"
+#include "LifeInvariantDeferred.h"
+#include "LifeInvariantFingerprint.h"
+#include "LifeInvariantPlan.h"
+#include "LifeInvariantSampling.h"
+#include "LifeInvariantTable.h"
+#include "LifeStructInvariants.h"
+#include "Helpers/Life_Helper_AllocationCounter.h"
+#include "Helpers/Life_Helper_BenchmarkObjects.h"
 #include "Helpers/Life_Helper_InvariantMetrics.h"
+#include "Algo/AllOf.h"
 
 BEGIN_DEFINE_SPEC(FLife_Test_Perf_Dbc_Spec, "SkyLifeguard.Perf.Contracts", EAutomationTestFlags::EditorContext | EAutomationTestFlags::ProductFilter)
 
+	/** Times 10000 LG_CLASS_INVARIANTS calls on Obj and reports them as "Invariant Check Performance (Label)". */
+	void AddInvariantCheckTiming(const UObject* Obj, const TCHAR* Label)
+	{
+		const int32 Iterations = 10000;
+		const double StartTime = FPlatformTime::Seconds();
+		for (int32 i = 0; i < Iterations; ++i)
+		{
+			LG_CLASS_INVARIANTS(Obj);
+		}
+		const double TotalTime = FPlatformTime::Seconds() - StartTime;
+
+		AddInfo(FString::Printf(TEXT("Invariant Check Performance (%s): Total: %f s, Avg: %f s per call (%d iterations)"),
+			Label, TotalTime, TotalTime / Iterations, Iterations));
+	}
+
+#if WITH_METADATA
+	/** Writes the invariant table of the loaded classes to the transient dir and loads it instead of the plugin's. */
+	bool LoadFreshInvariantTable()
+	{
+		const FString Path = FPaths::AutomationTransientDir() / TEXT("Lifeguard/InvariantTable.bin");
+		if (!TestNotEqual(TEXT("Table written"), Debug::FLifeInvariantTable::Write(Path), static_cast<int32>(INDEX_NONE))) {
+			return false;
+		}
+		Debug::FLifeInvariantTable::Initialize(Path);
+		Debug::FLifeInvariantPlanCache::Invalidate();
+		return TestTrue(TEXT("Table loaded"), Debug::FLifeInvariantTable::IsLoaded());
+	}
+#endif
+
 END_DEFINE_SPEC(FLife_Test_Perf_Dbc_Spec)
 
 
+namespace
+{
+	/** Sets a bool console variable until the end of the scope. Does nothing if the variable doesn't exist. */
+	struct FLifeTestScopedBoolCVar
+	{
+		FLifeTestScopedBoolCVar(const TCHAR* Name, bool bValue)
+			: Variable(IConsoleManager::Get().FindConsoleVariable(Name))
+		{
+			if (Variable) {
+				bPrevious = Variable->GetBool();
+				Variable->Set(bValue, ECVF_SetByCode);
+			}
+		}
+
+		~FLifeTestScopedBoolCVar()
+		{
+			if (Variable) {
+				Variable->Set(bPrevious, ECVF_SetByCode);
+			}
+		}
+
+		IConsoleVariable* Variable = nullptr;
+		bool bPrevious = false;
+	};
+
+	/** Creates a rooted perf object whose invariants all hold. */
+	ULifeTestInvariantPerfObj* MakeValidPerfObj()
+	{
+		ULifeTestInvariantPerfObj* Obj = NewObject<ULifeTestInvariantPerfObj>();
+		Obj->AddToRoot(); // Prevent GC
+
+		// Initialize pointers to avoid invariant failure
+		Obj->Ptr00 = Obj; Obj->Ptr01 = Obj; Obj->Ptr02 = Obj; Obj->Ptr03 = Obj; Obj->Ptr04 = Obj;
+		Obj->Ptr05 = Obj; Obj->Ptr06 = Obj; Obj->Ptr07 = Obj; Obj->Ptr08 = Obj; Obj->Ptr09 = Obj;
+		Obj->Ptr10 = Obj; Obj->Ptr11 = Obj; Obj->Ptr12 = Obj; Obj->Ptr13 = Obj; Obj->Ptr14 = Obj;
+		Obj->Ptr15 = Obj; Obj->Ptr16 = Obj; Obj->Ptr17 = Obj; Obj->Ptr18 = Obj; Obj->Ptr19 = Obj;
+		Obj->Ptr20 = Obj; Obj->Ptr21 = Obj; Obj->Ptr22 = Obj; Obj->Ptr23 = Obj; Obj->Ptr24 = Obj;
+		return Obj;
+	}
+
+	/** A fragment-like plain struct, one member per numeric rule plus a custom check. */
+	struct FLifeTestStructFragment
+	{
+		int32 Health = 100;
+		float Armor = 0.0f;
+		int32 OwnerId = 0;
+		float Speed = 1.0f;
+		float Drag = -1.0f;
+		bool bAlive = true;
+
+		constexpr bool IsArmorCapped() const { return Armor <= Health; }
+
+		static constexpr auto Invariants = LifeInv::Make(
+			LG_INV_MEMBER(FLifeTestStructFragment, Health), LifeInv::Range<0, 100>{},
+			LG_INV_MEMBER(FLifeTestStructFragment, Armor), LifeInv::Gte0{},
+			&FLifeTestStructFragment::OwnerId, LifeInv::ID{},
+			&FLifeTestStructFragment::Speed, LifeInv::Gt0{},
+			&FLifeTestStructFragment::Drag, LifeInv::Lt0{},
+			&FLifeTestStructFragment::bAlive, LifeInv::True{},
+			LifeInv::Function<&FLifeTestStructFragment::IsArmorCapped>{});
+	};
+
+	// Default values are checked at compile time
+	static_assert(LifeInv::Test(FLifeTestStructFragment{}, FLifeTestStructFragment::Invariants));
+	static_assert(!LifeInv::Test(FLifeTestStructFragment{ .Health = 101 }, FLifeTestStructFragment::Invariants));
+}
+
 void FLife_Test_Perf_Dbc_Spec::Define()
 {
 	// Setup and teardown to ensure objects aren't GC'd during tests
@@ -47,5 +152,657 @@ void FLife_Test_Perf_Dbc_Spec::Define()
         	
             Obj->RemoveFromRoot();
         });
+
+        It("Performance of 75 properties (scalar path)", [this]()
+        {
+            ULifeTestInvariantPerfObj* Obj = MakeValidPerfObj();
+
+            // Same object with the vector batches turned off, so both numbers can be compared side by side
+            const FLifeTestScopedBoolCVar Simd(TEXT("Lifeguard.Invariants.Simd"), false);
+            if (TestNotNull(TEXT("Lifeguard.Invariants.Simd exists"), Simd.Variable)) {
+                AddInvariantCheckTiming(Obj, TEXT("scalar"));
+            }
+
+            Obj->RemoveFromRoot();
+        });
+
+        It("Vector batches catch every failing lane", [this]()
+        {
+#if DO_CHECK
+            ULifeTestInvariantPerfObj* Obj = MakeValidPerfObj();
+
+            const FLifeTestScopedBoolCVar Simd(TEXT("Lifeguard.Invariants.Simd"), true);
+            if (!TestNotNull(TEXT("Lifeguard.Invariants.Simd exists"), Simd.Variable)) {
+                Obj->RemoveFromRoot();
+                return;
+            }
+
+            // The 50 Gte0 integers make one batch, padded to 52 lanes by repeating Int49
+            const Debug::FLifeInvariantPlan& Plan = Debug::FLifeInvariantPlanCache::GetPlan(Obj->GetClass());
+            const Debug::FLifeInvariantBatch* Batch = Plan.Batches.FindByPredicate([](const Debug::FLifeInvariantBatch& Candidate) {
+                return Candidate.Kind == Debug::ELifeInvariantKind::Int32 && Candidate.Op == Debug::ELifeInvariantOp::Gte0;
+            });
+            if (TestNotNull(TEXT("The Gte0 integers are batched"), Batch)) {
+                TestEqual(TEXT("Batched entries"), Batch->EntryIndices.Num(), 50);
+                TestEqual(TEXT("Padded lanes"), Batch->Offsets.Num(), 52);
+            }
+
+            TArray<FString> Failures;
+            Debug::SetCheckFailureHook([&Failures](const FString& Message) { Failures.Add(Message); });
+            const auto CheckFailingLane = [this, Obj, &Failures](int32& Value, const TCHAR* PropertyName)
+            {
+                Failures.Reset();
+                Value = -1;
+                LG_CLASS_INVARIANTS(Obj);
+                Value = 1;
+                if (TestEqual(FString::Printf(TEXT("Failures with %s < 0"), PropertyName), Failures.Num(), 1)) {
+                    TestTrue(FString::Printf(TEXT("The failure names %s"), PropertyName), Failures[0].Contains(FString::Printf(TEXT("::%s"), PropertyName)));
+                }
+            };
+            CheckFailingLane(Obj->Int00, TEXT("Int00"));
+            CheckFailingLane(Obj->Int21, TEXT("Int21"));
+            CheckFailingLane(Obj->Int48, TEXT("Int48"));
+            // Also sits in the two padding lanes of the last vector
+            CheckFailingLane(Obj->Int49, TEXT("Int49"));
+            Debug::SetCheckFailureHook(nullptr);
+
+            Obj->RemoveFromRoot();
+#endif
+        });
+
+        It("Performance of 75 properties (strict MemSafe)", [this]()
+        {
+            ULifeTestInvariantPerfObj* Obj = MakeValidPerfObj();
+
+            const FLifeTestScopedBoolCVar Strict(TEXT("Lifeguard.Invariants.StrictMemSafe"), true);
+            if (TestNotNull(TEXT("Lifeguard.Invariants.StrictMemSafe exists"), Strict.Variable)) {
+                AddInvariantCheckTiming(Obj, TEXT("strict MemSafe"));
+            }
+
+            Obj->RemoveFromRoot();
+        });
+
+        It("Strict MemSafe fails on a pointer to a garbage object", [this]()
+        {
+#if DO_CHECK
+            ULifeTestInvariantPerfObj* Obj = MakeValidPerfObj();
+            // Marked for collection but not purged yet, so it's still allocated
+            UObject* Garbage = NewObject<ULifeTestInvariantPerfObj>();
+            Garbage->MarkAsGarbage();
+            Obj->Ptr07 = Garbage;
+
+            TArray<FString> Failures;
+            Debug::SetCheckFailureHook([&Failures](const FString& Message) { Failures.Add(Message); });
+            LG_CLASS_INVARIANTS(Obj);
+            const int32 NumDefaultFailures = Failures.Num();
+            {
+                const FLifeTestScopedBoolCVar Strict(TEXT("Lifeguard.Invariants.StrictMemSafe"), true);
+                TestNotNull(TEXT("Lifeguard.Invariants.StrictMemSafe exists"), Strict.Variable);
+                LG_CLASS_INVARIANTS(Obj);
+            }
+            Debug::SetCheckFailureHook(nullptr);
+
+            TestEqual(TEXT("Failures in default mode"), NumDefaultFailures, 0);
+            if (TestEqual(TEXT("Failures in strict mode"), Failures.Num(), 1)) {
+                TestTrue(TEXT("The failure names Ptr07"), Failures[0].Contains(TEXT("::Ptr07")));
+            }
+
+            Obj->RemoveFromRoot();
+#endif
+        });
+
+        It("Performance of 75 properties (per-class stats)", [this]()
+        {
+            ULifeTestInvariantPerfObj* Obj = MakeValidPerfObj();
+
+            const FLifeTestScopedBoolCVar PerClass(TEXT("Lifeguard.Stats.PerClass"), true);
+            if (TestNotNull(TEXT("Lifeguard.Stats.PerClass exists"), PerClass.Variable)) {
+                const Debug::FLifeInvariantPlan& Plan = Debug::FLifeInvariantPlanCache::GetPlan(Obj->GetClass());
+                TestFalse(TEXT("The plan has a per-class trace name"), Plan.TraceName.IsEmpty());
+
+                AddInvariantCheckTiming(Obj, TEXT("per-class stats"));
+            }
+
+            Obj->RemoveFromRoot();
+        });
+
+        It("Performance of deferring 1000 checks", [this]()
+        {
+            TArray<ULifeTestInvariantPerfObj*> Objects;
+            for (int32 i = 0; i < 1000; ++i)
+            {
+                Objects.Add(MakeValidPerfObj());
+            }
+
+            // Objects queued by earlier tests or frames would count towards the numbers below
+            Debug::FLifeDeferredInvariants::Flush();
+
+            double StartTime = FPlatformTime::Seconds();
+            for (ULifeTestInvariantPerfObj* Obj : Objects)
+            {
+                LG_CLASS_INVARIANTS_DEFERRED(Obj);
+            }
+            const double EnqueueTime = FPlatformTime::Seconds() - StartTime;
+            TestEqual(TEXT("Every check is queued"), Debug::FLifeDeferredInvariants::GetNumPending(), 1000);
+
+            // A zero budget still moves the queue by one
+            TestEqual(TEXT("A drain with no budget checks one object"), Debug::FLifeDeferredInvariants::Drain(0.0), 1);
+
+            StartTime = FPlatformTime::Seconds();
+            Debug::FLifeDeferredInvariants::Flush();
+            const double FlushTime = FPlatformTime::Seconds() - StartTime;
+            TestEqual(TEXT("Flush empties the queue"), Debug::FLifeDeferredInvariants::GetNumPending(), 0);
+
+            AddInfo(FString::Printf(TEXT("Deferred Invariant Performance: Enqueue: %f s, Flush: %f s (%d objects)"),
+                EnqueueTime, FlushTime, Objects.Num()));
+
+            for (ULifeTestInvariantPerfObj* Obj : Objects)
+            {
+                Obj->RemoveFromRoot();
+            }
+        });
+
+        It("Performance of a batch of 1000 objects", [this]()
+        {
+            TArray<ULifeTestInvariantPerfObj*> Objects;
+            for (int32 i = 0; i < 1000; ++i)
+            {
+                Objects.Add(MakeValidPerfObj());
+            }
+
+            const int32 Iterations = 100;
+
+            double StartTime = FPlatformTime::Seconds();
+            for (int32 i = 0; i < Iterations; ++i)
+            {
+                for (ULifeTestInvariantPerfObj* Obj : Objects)
+                {
+                    LG_CLASS_INVARIANTS(Obj);
+                }
+            }
+            const double OneByOneTime = FPlatformTime::Seconds() - StartTime;
+
+            StartTime = FPlatformTime::Seconds();
+            for (int32 i = 0; i < Iterations; ++i)
+            {
+                LG_CLASS_INVARIANTS_BATCH(Objects);
+            }
+            const double BatchTime = FPlatformTime::Seconds() - StartTime;
+
+            const auto Info = FString::Printf(TEXT("Invariant Check Performance (%d objects): One by one: %f s, Batch: %f s per sweep (%d iterations)"),
+                Objects.Num(), OneByOneTime / Iterations, BatchTime / Iterations, Iterations);
+
+            AddInfo(Info);
+
+            for (ULifeTestInvariantPerfObj* Obj : Objects)
+            {
+                Obj->RemoveFromRoot();
+            }
+        });
+
+        It("Performance of custom invariant functions (ProcessEvent vs native)", [this]()
+        {
+            ULifeTestInvariantReflectedFuncObj* Reflected = NewObject<ULifeTestInvariantReflectedFuncObj>();
+            ULifeTestInvariantNativeFuncObj* Native = NewObject<ULifeTestInvariantNativeFuncObj>();
+            Reflected->AddToRoot();
+            Native->AddToRoot();
+
+            const int32 Iterations = 10000;
+
+            double StartTime = FPlatformTime::Seconds();
+            for (int32 i = 0; i < Iterations; ++i)
+            {
+                LG_CLASS_INVARIANTS(Reflected);
+            }
+            const double ReflectedTime = FPlatformTime::Seconds() - StartTime;
+
+            StartTime = FPlatformTime::Seconds();
+            for (int32 i = 0; i < Iterations; ++i)
+            {
+                LG_CLASS_INVARIANTS(Native);
+            }
+            const double NativeTime = FPlatformTime::Seconds() - StartTime;
+
+            const auto Info = FString::Printf(TEXT("Custom Invariant Performance: ProcessEvent: %f s, Native: %f s per call (%d iterations)"),
+                ReflectedTime / Iterations, NativeTime / Iterations, Iterations);
+
+            AddInfo(Info);
+
+            Reflected->RemoveFromRoot();
+            Native->RemoveFromRoot();
+        });
+
+        It("Performance of element-wise container invariants", [this]()
+        {
+            ULifeTestInvariantArrayObj* Obj = NewObject<ULifeTestInvariantArrayObj>();
+            Obj->AddToRoot();
+
+            const int32 NumElements = 10000;
+            for (int32 i = 0; i < NumElements; ++i)
+            {
+                Obj->Weights.Add(static_cast<float>(i) / NumElements);
+                Obj->Counts.Add(i);
+                Obj->Scales.Add(1.0 + i);
+            }
+            for (int32 i = 0; i < 100; ++i)
+            {
+                Obj->Ids.Add(i);
+                Obj->Probabilities.Add(FName(TEXT("Outcome"), i), 0.01f);
+            }
+
+            const int32 Iterations = 1000;
+            const double StartTime = FPlatformTime::Seconds();
+            for (int32 i = 0; i < Iterations; ++i)
+            {
+                LG_CLASS_INVARIANTS(Obj);
+            }
+            const double TotalTime = FPlatformTime::Seconds() - StartTime;
+
+            AddInfo(FString::Printf(TEXT("Container Invariant Performance (3 x %d array elements, 2 x 100 set/map elements): Avg: %f s per call (%d iterations)"),
+                NumElements, TotalTime / Iterations, Iterations));
+
+            Obj->RemoveFromRoot();
+        });
+
+        It("Names the failing element of a container", [this]()
+        {
+#if DO_CHECK
+            ULifeTestInvariantArrayObj* Obj = NewObject<ULifeTestInvariantArrayObj>();
+            Obj->AddToRoot();
+            Obj->Weights = { 0.25f, 0.5f, 1.5f };
+            Obj->Counts = { 1, 2 };
+            Obj->Scales = { 1.0 };
+            Obj->Ids = { 1, INDEX_NONE };
+            Obj->Probabilities = { { FName(TEXT("Fire")), 0.5f }, { FName(TEXT("Ice")), -0.5f } };
+
+            TArray<FString> Failures;
+            Debug::SetCheckFailureHook([&Failures](const FString& Message) { Failures.Add(Message); });
+            LG_CLASS_INVARIANTS(Obj);
+            Debug::SetCheckFailureHook(nullptr);
+
+            const auto HasFailure = [&Failures](const TCHAR* Text) {
+                return Failures.ContainsByPredicate([Text](const FString& Failure) { return Failure.Contains(Text); });
+            };
+            TestEqual(TEXT("Failures"), Failures.Num(), 3);
+            TestTrue(TEXT("TArray element named"), HasFailure(TEXT("LifeTestInvariantArrayObj::Weights, [2] = 1.5")));
+            TestTrue(TEXT("TSet element named"), HasFailure(TEXT("LifeTestInvariantArrayObj::Ids, element -1")));
+            TestTrue(TEXT("TMap value named by its key"), HasFailure(TEXT("LifeTestInvariantArrayObj::Probabilities, [Ice] = -0.5")));
+
+            Obj->RemoveFromRoot();
+#endif
+        });
+
+        It("Performance of 1000 objects sharing a Contract* sub-object", [this]()
+        {
+            ULifeTestInvariantPerfObj* Shared = MakeValidPerfObj();
+            TArray<ULifeTestInvariantContractObj*> Objects;
+            for (int32 i = 0; i < 1000; ++i)
+            {
+                ULifeTestInvariantContractObj* Obj = NewObject<ULifeTestInvariantContractObj>();
+                Obj->AddToRoot();
+                Obj->Shared = Shared;
+                Objects.Add(Obj);
+            }
+
+            const int32 Iterations = 100;
+
+            // One by one, the shared object is checked once per parent. In a batch, once per sweep.
+            double StartTime = FPlatformTime::Seconds();
+            for (int32 i = 0; i < Iterations; ++i)
+            {
+                for (ULifeTestInvariantContractObj* Obj : Objects)
+                {
+                    LG_CLASS_INVARIANTS(Obj);
+                }
+            }
+            const double OneByOneTime = FPlatformTime::Seconds() - StartTime;
+
+            StartTime = FPlatformTime::Seconds();
+            for (int32 i = 0; i < Iterations; ++i)
+            {
+                LG_CLASS_INVARIANTS_BATCH(Objects);
+            }
+            const double BatchTime = FPlatformTime::Seconds() - StartTime;
+
+            AddInfo(FString::Printf(TEXT("Contract* Performance (%d parents, 1 shared child): One by one: %f s, Batch: %f s per sweep (%d iterations)"),
+                Objects.Num(), OneByOneTime / Iterations, BatchTime / Iterations, Iterations));
+
+            for (ULifeTestInvariantContractObj* Obj : Objects)
+            {
+                Obj->RemoveFromRoot();
+            }
+            Shared->RemoveFromRoot();
+        });
+
+        It("Checks a shared Contract* sub-object once per batch", [this]()
+        {
+#if DO_CHECK
+            ULifeTestInvariantPerfObj* Shared = MakeValidPerfObj();
+            Shared->Int07 = -1;
+            TArray<ULifeTestInvariantContractObj*> Objects;
+            for (int32 i = 0; i < 3; ++i)
+            {
+                ULifeTestInvariantContractObj* Obj = NewObject<ULifeTestInvariantContractObj>();
+                Obj->AddToRoot();
+                Obj->Shared = Shared;
+                Objects.Add(Obj);
+            }
+
+            TArray<FString> Failures;
+            Debug::SetCheckFailureHook([&Failures](const FString& Message) { Failures.Add(Message); });
+            LG_CLASS_INVARIANTS_BATCH(Objects);
+            const int32 NumBatchFailures = Failures.Num();
+            for (ULifeTestInvariantContractObj* Obj : Objects)
+            {
+                LG_CLASS_INVARIANTS(Obj);
+            }
+            Debug::SetCheckFailureHook(nullptr);
+
+            TestEqual(TEXT("Failures in one batch"), NumBatchFailures, 1);
+            TestEqual(TEXT("Failures one by one"), Failures.Num() - NumBatchFailures, Objects.Num());
+            TestTrue(TEXT("The failure names the shared object's property"), !Failures.IsEmpty() && Failures[0].Contains(TEXT("LifeTestInvariantPerfObj::Int07")));
+
+            for (ULifeTestInvariantContractObj* Obj : Objects)
+            {
+                Obj->RemoveFromRoot();
+            }
+            Shared->RemoveFromRoot();
+#endif
+        });
+
+        It("Reports a Contract* cycle with its path", [this]()
+        {
+#if DO_CHECK
+            ULifeTestBenchContractNodeObj* First = NewObject<ULifeTestBenchContractNodeObj>();
+            ULifeTestBenchContractNodeObj* Second = NewObject<ULifeTestBenchContractNodeObj>();
+            First->AddToRoot();
+            Second->AddToRoot();
+            First->Next = Second;
+            Second->Next = First;
+
+            TArray<FString> Failures;
+            Debug::SetCheckFailureHook([&Failures](const FString& Message) { Failures.Add(Message); });
+            LG_CLASS_INVARIANTS(First);
+            Debug::SetCheckFailureHook(nullptr);
+
+            const FString Path = FString::Printf(TEXT("%s.Next -> %s.Next -> %s"), *First->GetName(), *Second->GetName(), *First->GetName());
+            if (TestEqual(TEXT("Failures"), Failures.Num(), 1)) {
+                TestTrue(TEXT("Reported as a cycle"), Failures[0].StartsWith(TEXT("Invariant=Contract* cycle:")));
+                TestTrue(TEXT("The message has the full path"), Failures[0].Contains(Path));
+            }
+
+            // Both ends of the loop in the same batch
+            TArray<ULifeTestBenchContractNodeObj*> Objects = { First, Second };
+            Failures.Reset();
+            Debug::SetCheckFailureHook([&Failures](const FString& Message) { Failures.Add(Message); });
+            LG_CLASS_INVARIANTS_BATCH(Objects);
+            Debug::SetCheckFailureHook(nullptr);
+
+            if (TestEqual(TEXT("Batch failures"), Failures.Num(), 1)) {
+                TestTrue(TEXT("Batch reported as a cycle"), Failures[0].StartsWith(TEXT("Invariant=Contract* cycle:")));
+                TestTrue(TEXT("The batch message has the full path"), Failures[0].Contains(Path));
+            }
+
+            First->RemoveFromRoot();
+            Second->RemoveFromRoot();
+#endif
+        });
+
+        It("Samples one check in four at Rate 0.25", [this]()
+        {
+            ULifeTestInvariantPerfObj* Obj = MakeValidPerfObj();
+
+            IConsoleManager& Console = IConsoleManager::Get();
+            IConsoleVariable* SamplingVar = Console.FindConsoleVariable(TEXT("Lifeguard.Invariants.Sampling"));
+            IConsoleVariable* RateVar = Console.FindConsoleVariable(TEXT("Lifeguard.Invariants.Sampling.Rate"));
+            IConsoleVariable* BudgetVar = Console.FindConsoleVariable(TEXT("Lifeguard.Invariants.Sampling.BudgetMs"));
+            if (!TestNotNull(TEXT("Sampling CVars exist"), SamplingVar) || !RateVar || !BudgetVar) {
+                Obj->RemoveFromRoot();
+                return;
+            }
+            const bool bPreviousSampling = SamplingVar->GetBool();
+            const float PreviousRate = RateVar->GetFloat();
+            const float PreviousBudget = BudgetVar->GetFloat();
+            SamplingVar->Set(true, ECVF_SetByCode);
+            RateVar->Set(0.25f, ECVF_SetByCode);
+            BudgetVar->Set(0.0f, ECVF_SetByCode);
+
+            // All calls happen in the same frame, so exactly every 4th call position is admitted
+            const Debug::FLifeInvariantSamplingStats Before = Debug::FLifeInvariantSampler::GetClassStats(Obj->GetClass());
+            for (int32 i = 0; i < 100; ++i)
+            {
+                LG_CLASS_INVARIANTS(Obj);
+            }
+            const Debug::FLifeInvariantSamplingStats After = Debug::FLifeInvariantSampler::GetClassStats(Obj->GetClass());
+
+            SamplingVar->Set(bPreviousSampling, ECVF_SetByCode);
+            RateVar->Set(PreviousRate, ECVF_SetByCode);
+            BudgetVar->Set(PreviousBudget, ECVF_SetByCode);
+
+            TestEqual(TEXT("Executed checks"), After.NumExecuted - Before.NumExecuted, uint64(25));
+            TestEqual(TEXT("Skipped checks"), After.NumSkipped - Before.NumSkipped, uint64(75));
+
+            Obj->RemoveFromRoot();
+        });
+
+        It("Makes progress with a budget smaller than one check", [this]()
+        {
+            // A class budget of a couple of cycles, and checks recorded as far more expensive than that
+            const UClass* Class = ULifeTestInvariantArrayObj::StaticClass();
+            const float BudgetMs = static_cast<float>(FPlatformTime::GetSecondsPerCycle64() * 1000.0 * 2.0);
+            Debug::FLifeInvariantSampler::SetClassSampling(Class, 1.0f, BudgetMs);
+
+            // 4 calls per frame: the first call at the resume position runs, the others don't fit
+            TArray<int32> AdmittedCalls;
+            int32 NumAdmitted = 0;
+            for (int32 FrameIndex = 0; FrameIndex < 5; ++FrameIndex)
+            {
+                ++GFrameCounter;
+                for (int32 CallIndex = 0; CallIndex < 4; ++CallIndex)
+                {
+                    if (Debug::FLifeInvariantSamplingState* State = Debug::FLifeInvariantSampler::Admit(Class)) {
+                        Debug::FLifeInvariantSampler::Record(*State, 1000, 1);
+                        AdmittedCalls.Add(CallIndex);
+                        ++NumAdmitted;
+                    }
+                }
+            }
+
+            Debug::FLifeInvariantSampler::SetClassSampling(Class, -1.0f, -1.0f);
+
+            TestEqual(TEXT("One check per frame"), NumAdmitted, 5);
+            TestEqual(TEXT("Round-robin positions"), AdmittedCalls, TArray<int32>({ 0, 1, 2, 3, 0 }));
+        });
+
+        It("Skips unchanged objects in incremental mode", [this]()
+        {
+            ULifeTestInvariantPerfObj* Obj = MakeValidPerfObj();
+
+            IConsoleVariable* IncrementalVar = IConsoleManager::Get().FindConsoleVariable(TEXT("Lifeguard.Invariants.Incremental"));
+            if (!TestNotNull(TEXT("Lifeguard.Invariants.Incremental exists"), IncrementalVar)) {
+                Obj->RemoveFromRoot();
+                return;
+            }
+            const bool bPreviousIncremental = IncrementalVar->GetBool();
+            IncrementalVar->Set(true, ECVF_SetByCode);
+
+            const Debug::FLifeInvariantFingerprintStats Start = Debug::FLifeInvariantFingerprints::GetStats();
+            LG_CLASS_INVARIANTS(Obj); // First sight: full check
+            LG_CLASS_INVARIANTS(Obj); // Unchanged
+            Obj->Int07 = 5;
+            LG_CLASS_INVARIANTS(Obj); // Changed: full check
+            LG_CLASS_INVARIANTS(Obj); // Unchanged again
+            const Debug::FLifeInvariantFingerprintStats End = Debug::FLifeInvariantFingerprints::GetStats();
+
+            const int32 Iterations = 10000;
+            const double StartTime = FPlatformTime::Seconds();
+            for (int32 i = 0; i < Iterations; ++i)
+            {
+                LG_CLASS_INVARIANTS(Obj);
+            }
+            const double TotalTime = FPlatformTime::Seconds() - StartTime;
+
+            IncrementalVar->Set(bPreviousIncremental, ECVF_SetByCode);
+
+            TestEqual(TEXT("Full checks"), End.NumChanged - Start.NumChanged, uint64(2));
+            TestEqual(TEXT("Skipped checks"), End.NumUnchanged - Start.NumUnchanged, uint64(2));
+
+            AddInfo(FString::Printf(TEXT("Invariant Check Performance (incremental, unchanged): Avg: %f s per call (%d iterations)"), TotalTime / Iterations, Iterations));
+
+            Obj->RemoveFromRoot();
+        });
+
+        It("Checks 75 properties without allocating", [this]()
+        {
+            ULifeTestInvariantPerfObj* Obj = MakeValidPerfObj();
+
+            // The first check builds and caches the class plan, which is allowed to allocate
+            LG_CLASS_INVARIANTS(Obj);
+
+            int32 NumAllocations = 0;
+            {
+                FLifeScopedAllocationCounter Counter;
+                for (int32 i = 0; i < 100; ++i)
+                {
+                    LG_CLASS_INVARIANTS(Obj);
+                }
+                NumAllocations = Counter.GetNumAllocations();
+            }
+
+            TestEqual(TEXT("Heap allocations across 100 invariant checks"), NumAllocations, 0);
+
+            Obj->RemoveFromRoot();
+        });
+	});
+
+#if WITH_METADATA
+	Describe("Invariant Table", [this]() {
+        AfterEach([this]()
+        {
+            // Back to the plugin's table, if it has one
+            Debug::FLifeInvariantTable::Initialize();
+            Debug::FLifeInvariantPlanCache::Invalidate();
+        });
+
+        It("Builds the same plan from the table as from metadata", [this]()
+        {
+            const UClass* Class = ULifeTestBenchRangeObj::StaticClass();
+            Debug::FLifeInvariantTable::Shutdown();
+            Debug::FLifeInvariantPlanCache::Invalidate();
+            const TArray<Debug::FLifeInvariantEntry> MetadataEntries = Debug::FLifeInvariantPlanCache::GetPlan(Class).Entries;
+            TestFalse(TEXT("Built from metadata without a table"), Debug::FLifeInvariantPlanCache::GetPlan(Class).bFromTable);
+
+            if (!LoadFreshInvariantTable()) {
+                return;
+            }
+            const Debug::FLifeInvariantPlan& Plan = Debug::FLifeInvariantPlanCache::GetPlan(Class);
+            TestTrue(TEXT("Built from the table"), Plan.bFromTable);
+            if (TestEqual(TEXT("Entries"), Plan.Entries.Num(), MetadataEntries.Num())) {
+                for (int32 Index = 0; Index < Plan.Entries.Num(); ++Index) {
+                    const Debug::FLifeInvariantEntry& Entry = Plan.Entries[Index];
+                    const Debug::FLifeInvariantEntry& Expected = MetadataEntries[Index];
+                    const FString Name = Entry.Property->GetName();
+                    TestTrue(Name + TEXT(" property"), Entry.Property == Expected.Property);
+                    TestEqual(Name + TEXT(" rule"), Entry.Rule, Expected.Rule);
+                    TestTrue(Name + TEXT(" op"), Entry.Op == Expected.Op);
+                    TestTrue(Name + TEXT(" kind"), Entry.Kind == Expected.Kind);
+                    TestEqual(Name + TEXT(" lower bound"), Entry.Range.Floating.Lower, Expected.Range.Floating.Lower);
+                    TestEqual(Name + TEXT(" upper bound"), Entry.Range.Floating.Upper, Expected.Range.Floating.Upper);
+                    TestTrue(Name + TEXT(" has a kernel"), Entry.Kernel != nullptr);
+                }
+            }
+        });
+
+        It("Falls back to metadata when the annotations changed since the table was written", [this]()
+        {
+            const UClass* Class = ULifeTestBenchRangeObj::StaticClass();
+            FProperty* ChangedRule = FindFProperty<FProperty>(Class, TEXT("Value3"));
+            FProperty* Removed = FindFProperty<FProperty>(Class, TEXT("Value5"));
+            const FProperty* Kept = FindFProperty<FProperty>(Class, TEXT("Value7"));
+            if (!TestNotNull(TEXT("Test properties exist"), ChangedRule) || !Removed || !Kept) {
+                return;
+            }
+            const FString Rule = ChangedRule->GetMetaData(TEXT("Invariant"));
+            AddExpectedError(TEXT("Invariant table record of LifeTestBenchRangeObj is stale"), EAutomationExpectedErrorFlags::Contains, 3);
+            const auto FindEntry = [](const Debug::FLifeInvariantPlan& Plan, const FProperty* Property) {
+                return Plan.Entries.FindByPredicate([Property](const Debug::FLifeInvariantEntry& Entry) { return Entry.Property == Property; });
+            };
+
+            // Edited rule: the new bounds are used, not the stored ones
+            if (LoadFreshInvariantTable()) {
+                ChangedRule->SetMetaData(TEXT("Invariant"), TEXT("Range[0,2]"));
+                Debug::FLifeInvariantPlanCache::Invalidate();
+                const Debug::FLifeInvariantPlan& Plan = Debug::FLifeInvariantPlanCache::GetPlan(Class);
+                TestFalse(TEXT("Edited rule: built from metadata"), Plan.bFromTable);
+                const Debug::FLifeInvariantEntry* Entry = FindEntry(Plan, ChangedRule);
+                if (TestNotNull(TEXT("Edited rule: entry"), Entry)) {
+                    TestEqual(TEXT("Edited rule: upper bound"), Entry->Range.Floating.Upper, 2.0);
+                }
+                ChangedRule->SetMetaData(TEXT("Invariant"), *Rule);
+                Debug::FLifeInvariantPlanCache::Invalidate();
+                TestTrue(TEXT("Restored rule: built from the table"), Debug::FLifeInvariantPlanCache::GetPlan(Class).bFromTable);
+            }
+
+            // Removed annotation
+            Removed->RemoveMetaData(TEXT("Invariant"));
+            Debug::FLifeInvariantPlanCache::Invalidate();
+            {
+                const Debug::FLifeInvariantPlan& Plan = Debug::FLifeInvariantPlanCache::GetPlan(Class);
+                TestFalse(TEXT("Removed annotation: built from metadata"), Plan.bFromTable);
+                TestNull(TEXT("Removed annotation: no entry"), FindEntry(Plan, Removed));
+            }
+
+            // Added annotation: the table is written without it, then it's put back
+            if (LoadFreshInvariantTable()) {
+                Removed->SetMetaData(TEXT("Invariant"), *Rule);
+                Debug::FLifeInvariantPlanCache::Invalidate();
+                const Debug::FLifeInvariantPlan& Plan = Debug::FLifeInvariantPlanCache::GetPlan(Class);
+                TestFalse(TEXT("Added annotation: built from metadata"), Plan.bFromTable);
+                TestNotNull(TEXT("Added annotation: entry"), FindEntry(Plan, Removed));
+                TestNotNull(TEXT("Other entries are kept"), FindEntry(Plan, Kept));
+            }
+            Removed->SetMetaData(TEXT("Invariant"), *Rule);
+        });
+	});
+#endif
+
+	Describe("Struct Invariants", [this]() {
+        It("Performance of 10000 plain structs (one by one vs bulk)", [this]()
+        {
+            TArray<FLifeTestStructFragment> Fragments;
+            Fragments.SetNum(10000);
+            for (int32 i = 0; i < Fragments.Num(); ++i)
+            {
+                Fragments[i].Health = i % 101;
+                Fragments[i].Armor = static_cast<float>(i % 50);
+                Fragments[i].OwnerId = i;
+            }
+
+            TestTrue(TEXT("Every fragment passes"), Algo::AllOf(Fragments, [](const FLifeTestStructFragment& Fragment) {
+                return LifeInv::Test(Fragment, FLifeTestStructFragment::Invariants);
+            }));
+
+            const int32 Iterations = 100;
+
+            double StartTime = FPlatformTime::Seconds();
+            for (int32 i = 0; i < Iterations; ++i)
+            {
+                for (const FLifeTestStructFragment& Fragment : Fragments)
+                {
+                    LG_STRUCT_INVARIANTS(Fragment);
+                }
+            }
+            const double OneByOneTime = FPlatformTime::Seconds() - StartTime;
+
+            StartTime = FPlatformTime::Seconds();
+            for (int32 i = 0; i < Iterations; ++i)
+            {
+                LG_STRUCT_INVARIANTS_BULK(Fragments);
+            }
+            const double BulkTime = FPlatformTime::Seconds() - StartTime;
+
+            AddInfo(FString::Printf(TEXT("Struct Invariant Performance (%d fragments, 7 invariants): One by one: %f s, Bulk: %f s per sweep (%d iterations)"),
+                Fragments.Num(), OneByOneTime / Iterations, BulkTime / Iterations, Iterations));
+        });
 	});
 }
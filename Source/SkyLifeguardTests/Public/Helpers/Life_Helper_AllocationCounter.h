@@ -0,0 +1,44 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/MemoryBase.h"
+
+/**
+ * Counts the heap allocations made by the calling thread while in scope. GMalloc is swapped for a forwarding proxy on
+ * construction and restored on destruction, so everything allocated through FMemory is seen. Allocations from other
+ * threads are forwarded but not counted.
+ *
+ * Usage:
+ *	{
+ *		FLifeScopedAllocationCounter Counter;
+ *		DoWork();
+ *		TestEqual(TEXT("Allocations"), Counter.GetNumAllocations(), 0);
+ *	}
+ */
+class FLifeScopedAllocationCounter : public FMalloc
+{
+public:
+	FLifeScopedAllocationCounter();
+	virtual ~FLifeScopedAllocationCounter() override;
+
+	int32 GetNumAllocations() const { return NumAllocations; }
+
+	// FMalloc interface
+	virtual void* Malloc(SIZE_T Count, uint32 Alignment = DEFAULT_ALIGNMENT) override;
+	virtual void* TryMalloc(SIZE_T Count, uint32 Alignment = DEFAULT_ALIGNMENT) override;
+	virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment = DEFAULT_ALIGNMENT) override;
+	virtual void* TryRealloc(void* Original, SIZE_T Count, uint32 Alignment = DEFAULT_ALIGNMENT) override;
+	virtual void Free(void* Original) override;
+	virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override;
+	virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override;
+	virtual void Trim(bool bTrimThreadCaches) override;
+	virtual bool IsInternallyThreadSafe() const override;
+	virtual const TCHAR* GetDescriptiveName() override { return TEXT("LifeScopedAllocationCounter"); }
+
+private:
+	void CountAllocation();
+
+	FMalloc* Inner = nullptr;
+	uint32 OwnerThreadId = 0;
+	int32 NumAllocations = 0;
+};
@@ -0,0 +1,77 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+
+/** Per-operation timings of one benchmark, in nanoseconds. */
+struct FLifeBenchmarkResult
+{
+	FString Name;
+	int32 NumSamples = 0;
+	int32 OpsPerSample = 0;
+	double MinNs = 0.0;
+	double MedianNs = 0.0;
+	double P99Ns = 0.0;
+	double MeanNs = 0.0;
+
+	/** One line for the automation log. */
+	FString ToString() const;
+	/** One NDJSON line, see FLifeBenchmark::Record. */
+	FString ToJson() const;
+};
+
+/**
+ * Runs the perf benchmarks. A benchmark is a body timed in samples: after some untimed warmup samples, every sample
+ * runs the body OpsPerSample times and yields the time per operation. Results are the min, median and p99 over the
+ * samples, so one preempted sample doesn't move them.
+ *
+ * Results are appended to Saved/Lifeguard/Benchmarks.ndjson (-LifeguardBenchmarks=<file> overrides), one JSON object
+ * per line with the plugin and engine versions and the build configuration, so runs of different plugin versions can
+ * be compared:
+ *
+ *   {"t":"bench","run":"2024.01.31-12.00.00","name":"Rule Gte0","plugin":"1.0","engine":"5.4.0-...","config":"Development",
+ *    "samples":101,"ops":1000,"min_ns":12.1,"median_ns":12.6,"p99_ns":19.0,"mean_ns":12.9}
+ *
+ * Usage:
+ *	const FLifeBenchmarkResult Result = FLifeBenchmark::Run(TEXT("Rule Gte0"), 1000, [Obj]() { LG_CLASS_INVARIANTS(Obj); });
+ *	FLifeBenchmark::Record(Result);
+ */
+class FLifeBenchmark
+{
+public:
+	static constexpr int32 DefaultSamples = 101;
+	static constexpr int32 DefaultWarmupSamples = 10;
+
+	template<typename TBody>
+	static FLifeBenchmarkResult Run(const FString& Name, int32 OpsPerSample, TBody&& Body,
+		int32 NumSamples = DefaultSamples, int32 NumWarmupSamples = DefaultWarmupSamples)
+	{
+		check(OpsPerSample > 0 && NumSamples > 0);
+
+		for (int32 Sample = 0; Sample < NumWarmupSamples; ++Sample) {
+			for (int32 Op = 0; Op < OpsPerSample; ++Op) {
+				Body();
+			}
+		}
+
+		TArray<double> SampleNs;
+		SampleNs.SetNumUninitialized(NumSamples);
+		const double NsPerCycle = FPlatformTime::GetSecondsPerCycle64() * 1e9;
+		for (int32 Sample = 0; Sample < NumSamples; ++Sample) {
+			const uint64 StartCycles = FPlatformTime::Cycles64();
+			for (int32 Op = 0; Op < OpsPerSample; ++Op) {
+				Body();
+			}
+			SampleNs[Sample] = static_cast<double>(FPlatformTime::Cycles64() - StartCycles) * NsPerCycle / OpsPerSample;
+		}
+
+		return Summarize(Name, OpsPerSample, SampleNs);
+	}
+
+	/** Sorts the samples and fills in the statistics. */
+	static FLifeBenchmarkResult Summarize(const FString& Name, int32 OpsPerSample, TArray<double>& SampleNs);
+
+	/** Appends the result to the results file. */
+	static void Record(const FLifeBenchmarkResult& Result);
+
+	static FString GetResultsPath();
+};
@@ -0,0 +1,214 @@
+﻿#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/Object.h"
+#include "Life_Helper_BenchmarkObjects.generated.h"
+
+/*
+ * Objects for the benchmark suite (Life_Test_Perf_Benchmarks.spec.cpp). Each rule class has 8 properties under one
+ * rule and nothing else, so its benchmark times that rule in isolation. Default values pass, pointers are set by the
+ * benchmarks.
+ */
+
+/** Hard object pointers. */
+UCLASS()
+class ULifeTestBenchMemSafeObj : public UObject
+{
+	GENERATED_BODY()
+
+public:
+    UPROPERTY(meta = (Invariant = "MemSafe")) UObject* Value0 = nullptr;
+    UPROPERTY(meta = (Invariant = "MemSafe")) UObject* Value1 = nullptr;
+    UPROPERTY(meta = (Invariant = "MemSafe")) UObject* Value2 = nullptr;
+    UPROPERTY(meta = (Invariant = "MemSafe")) UObject* Value3 = nullptr;
+    UPROPERTY(meta = (Invariant = "MemSafe")) UObject* Value4 = nullptr;
+    UPROPERTY(meta = (Invariant = "MemSafe")) UObject* Value5 = nullptr;
+    UPROPERTY(meta = (Invariant = "MemSafe")) UObject* Value6 = nullptr;
+    UPROPERTY(meta = (Invariant = "MemSafe")) UObject* Value7 = nullptr;
+};
+
+UCLASS()
+class ULifeTestBenchIDObj : public UObject
+{
+	GENERATED_BODY()
+
+public:
+    UPROPERTY(meta = (Invariant = "ID")) int32 Value0 = 1;
+    UPROPERTY(meta = (Invariant = "ID")) int32 Value1 = 1;
+    UPROPERTY(meta = (Invariant = "ID")) int32 Value2 = 1;
+    UPROPERTY(meta = (Invariant = "ID")) int32 Value3 = 1;
+    UPROPERTY(meta = (Invariant = "ID")) int32 Value4 = 1;
+    UPROPERTY(meta = (Invariant = "ID")) int32 Value5 = 1;
+    UPROPERTY(meta = (Invariant = "ID")) int32 Value6 = 1;
+    UPROPERTY(meta = (Invariant = "ID")) int32 Value7 = 1;
+};
+
+UCLASS()
+class ULifeTestBenchGte0Obj : public UObject
+{
+	GENERATED_BODY()
+
+public:
+    UPROPERTY(meta = (Invariant = "Gte0")) int32 Value0 = 1;
+    UPROPERTY(meta = (Invariant = "Gte0")) int32 Value1 = 1;
+    UPROPERTY(meta = (Invariant = "Gte0")) int32 Value2 = 1;
+    UPROPERTY(meta = (Invariant = "Gte0")) int32 Value3 = 1;
+    UPROPERTY(meta = (Invariant = "Gte0")) int32 Value4 = 1;
+    UPROPERTY(meta = (Invariant = "Gte0")) int32 Value5 = 1;
+    UPROPERTY(meta = (Invariant = "Gte0")) int32 Value6 = 1;
+    UPROPERTY(meta = (Invariant = "Gte0")) int32 Value7 = 1;
+};
+
+UCLASS()
+class ULifeTestBenchGt0Obj : public UObject
+{
+	GENERATED_BODY()
+
+public:
+    UPROPERTY(meta = (Invariant = "Gt0")) int32 Value0 = 1;
+    UPROPERTY(meta = (Invariant = "Gt0")) int32 Value1 = 1;
+    UPROPERTY(meta = (Invariant = "Gt0")) int32 Value2 = 1;
+    UPROPERTY(meta = (Invariant = "Gt0")) int32 Value3 = 1;
+    UPROPERTY(meta = (Invariant = "Gt0")) int32 Value4 = 1;
+    UPROPERTY(meta = (Invariant = "Gt0")) int32 Value5 = 1;
+    UPROPERTY(meta = (Invariant = "Gt0")) int32 Value6 = 1;
+    UPROPERTY(meta = (Invariant = "Gt0")) int32 Value7 = 1;
+};
+
+UCLASS()
+class ULifeTestBenchLte0Obj : public UObject
+{
+	GENERATED_BODY()
+
+public:
+    UPROPERTY(meta = (Invariant = "Lte0")) int32 Value0 = -1;
+    UPROPERTY(meta = (Invariant = "Lte0")) int32 Value1 = -1;
+    UPROPERTY(meta = (Invariant = "Lte0")) int32 Value2 = -1;
+    UPROPERTY(meta = (Invariant = "Lte0")) int32 Value3 = -1;
+    UPROPERTY(meta = (Invariant = "Lte0")) int32 Value4 = -1;
+    UPROPERTY(meta = (Invariant = "Lte0")) int32 Value5 = -1;
+    UPROPERTY(meta = (Invariant = "Lte0")) int32 Value6 = -1;
+    UPROPERTY(meta = (Invariant = "Lte0")) int32 Value7 = -1;
+};
+
+UCLASS()
+class ULifeTestBenchLt0Obj : public UObject
+{
+	GENERATED_BODY()
+
+public:
+    UPROPERTY(meta = (Invariant = "Lt0")) int32 Value0 = -1;
+    UPROPERTY(meta = (Invariant = "Lt0")) int32 Value1 = -1;
+    UPROPERTY(meta = (Invariant = "Lt0")) int32 Value2 = -1;
+    UPROPERTY(meta = (Invariant = "Lt0")) int32 Value3 = -1;
+    UPROPERTY(meta = (Invariant = "Lt0")) int32 Value4 = -1;
+    UPROPERTY(meta = (Invariant = "Lt0")) int32 Value5 = -1;
+    UPROPERTY(meta = (Invariant = "Lt0")) int32 Value6 = -1;
+    UPROPERTY(meta = (Invariant = "Lt0")) int32 Value7 = -1;
+};
+
+UCLASS()
+class ULifeTestBenchRangeObj : public UObject
+{
+	GENERATED_BODY()
+
+public:
+    UPROPERTY(meta = (Invariant = "Range[0,1]")) float Value0 = 0.5f;
+    UPROPERTY(meta = (Invariant = "Range[0,1]")) float Value1 = 0.5f;
+    UPROPERTY(meta = (Invariant = "Range[0,1]")) float Value2 = 0.5f;
+    UPROPERTY(meta = (Invariant = "Range[0,1]")) float Value3 = 0.5f;
+    UPROPERTY(meta = (Invariant = "Range[0,1]")) float Value4 = 0.5f;
+    UPROPERTY(meta = (Invariant = "Range[0,1]")) float Value5 = 0.5f;
+    UPROPERTY(meta = (Invariant = "Range[0,1]")) float Value6 = 0.5f;
+    UPROPERTY(meta = (Invariant = "Range[0,1]")) float Value7 = 0.5f;
+};
+
+UCLASS()
+class ULifeTestBenchNameObj : public UObject
+{
+	GENERATED_BODY()
+
+public:
+    UPROPERTY(meta = (Invariant = "Name")) FName Value0 = TEXT("Bench");
+    UPROPERTY(meta = (Invariant = "Name")) FName Value1 = TEXT("Bench");
+    UPROPERTY(meta = (Invariant = "Name")) FName Value2 = TEXT("Bench");
+    UPROPERTY(meta = (Invariant = "Name")) FName Value3 = TEXT("Bench");
+    UPROPERTY(meta = (Invariant = "Name")) FName Value4 = TEXT("Bench");
+    UPROPERTY(meta = (Invariant = "Name")) FName Value5 = TEXT("Bench");
+    UPROPERTY(meta = (Invariant = "Name")) FName Value6 = TEXT("Bench");
+    UPROPERTY(meta = (Invariant = "Name")) FName Value7 = TEXT("Bench");
+};
+
+UCLASS()
+class ULifeTestBenchTrueObj : public UObject
+{
+	GENERATED_BODY()
+
+public:
+    UPROPERTY(meta = (Invariant = "True")) bool Value0 = true;
+    UPROPERTY(meta = (Invariant = "True")) bool Value1 = true;
+    UPROPERTY(meta = (Invariant = "True")) bool Value2 = true;
+    UPROPERTY(meta = (Invariant = "True")) bool Value3 = true;
+    UPROPERTY(meta = (Invariant = "True")) bool Value4 = true;
+    UPROPERTY(meta = (Invariant = "True")) bool Value5 = true;
+    UPROPERTY(meta = (Invariant = "True")) bool Value6 = true;
+    UPROPERTY(meta = (Invariant = "True")) bool Value7 = true;
+};
+
+UCLASS()
+class ULifeTestBenchFalseObj : public UObject
+{
+	GENERATED_BODY()
+
+public:
+    UPROPERTY(meta = (Invariant = "False")) bool Value0 = false;
+    UPROPERTY(meta = (Invariant = "False")) bool Value1 = false;
+    UPROPERTY(meta = (Invariant = "False")) bool Value2 = false;
+    UPROPERTY(meta = (Invariant = "False")) bool Value3 = false;
+    UPROPERTY(meta = (Invariant = "False")) bool Value4 = false;
+    UPROPERTY(meta = (Invariant = "False")) bool Value5 = false;
+    UPROPERTY(meta = (Invariant = "False")) bool Value6 = false;
+    UPROPERTY(meta = (Invariant = "False")) bool Value7 = false;
+};
+
+/** Hard object pointer arrays, filled by the benchmark. */
+UCLASS()
+class ULifeTestBenchMemSafeContainerObj : public UObject
+{
+	GENERATED_BODY()
+
+public:
+    UPROPERTY(meta = (Invariant = "MemSafeContainer")) TArray<UObject*> Value0;
+    UPROPERTY(meta = (Invariant = "MemSafeContainer")) TArray<UObject*> Value1;
+    UPROPERTY(meta = (Invariant = "MemSafeContainer")) TArray<UObject*> Value2;
+    UPROPERTY(meta = (Invariant = "MemSafeContainer")) TArray<UObject*> Value3;
+    UPROPERTY(meta = (Invariant = "MemSafeContainer")) TArray<UObject*> Value4;
+    UPROPERTY(meta = (Invariant = "MemSafeContainer")) TArray<UObject*> Value5;
+    UPROPERTY(meta = (Invariant = "MemSafeContainer")) TArray<UObject*> Value6;
+    UPROPERTY(meta = (Invariant = "MemSafeContainer")) TArray<UObject*> Value7;
+};
+
+/** One container per shape. Benchmarks fill one of them and leave the others empty. */
+UCLASS()
+class ULifeTestBenchContainerObj : public UObject
+{
+	GENERATED_BODY()
+
+public:
+    UPROPERTY(meta = (Invariant = "Range[0,1]")) TArray<float> Floats;
+    UPROPERTY(meta = (Invariant = "Gte0")) TArray<int32> Ints;
+    UPROPERTY(meta = (Invariant = "ID")) TSet<int32> Ids;
+    UPROPERTY(meta = (Invariant = "Range[0,1]")) TMap<int32, float> Weights;
+    UPROPERTY(meta = (Invariant = "MemSafeContainer")) TArray<UObject*> Objects;
+};
+
+/** A link of a Contract* chain. The last link points at a ULifeTestBenchGte0Obj. */
+UCLASS()
+class ULifeTestBenchContractNodeObj : public UObject
+{
+	GENERATED_BODY()
+
+public:
+    UPROPERTY(meta = (Invariant = "Contract*")) UObject* Next = nullptr;
+    UPROPERTY(meta = (Invariant = "Gte0")) int32 Depth = 0;
+};
@@ -89,3 +89,56 @@ public:
     UPROPERTY(meta = (Invariant = "MemSafe")) UObject* Ptr23 = nullptr;
     UPROPERTY(meta = (Invariant = "MemSafe")) UObject* Ptr24 = nullptr;
 };
+
+/** Custom invariants resolved through reflection, called with ProcessEvent. */
+UCLASS()
+class ULifeTestInvariantReflectedFuncObj : public UObject
+{
+	GENERATED_BODY()
+
+public:
+    UPROPERTY(meta = (Invariant = "IsHealthValid")) int32 Health = 50;
+    UPROPERTY() int32 MaxHealth = 100;
+
+    UFUNCTION() bool IsHealthValid() const { return Health > 0; }
+    UFUNCTION(meta = (Invariant)) bool IsHealthInBounds() const { return Health <= MaxHealth; }
+};
+
+/** Same invariants as ULifeTestInvariantReflectedFuncObj, bound with LG_REGISTER_NATIVE_INVARIANT. */
+UCLASS()
+class ULifeTestInvariantNativeFuncObj : public UObject
+{
+	GENERATED_BODY()
+
+public:
+    UPROPERTY(meta = (Invariant = "IsHealthValid")) int32 Health = 50;
+    UPROPERTY() int32 MaxHealth = 100;
+
+    bool IsHealthValid() const { return Health > 0; }
+    bool IsHealthInBounds() const { return Health <= MaxHealth; }
+};
+
+/** Element-wise numeric invariants on containers. */
+UCLASS()
+class ULifeTestInvariantArrayObj : public UObject
+{
+	GENERATED_BODY()
+
+public:
+    UPROPERTY(meta = (Invariant = "Range[0,1]")) TArray<float> Weights;
+    UPROPERTY(meta = (Invariant = "Gte0")) TArray<int32> Counts;
+    UPROPERTY(meta = (Invariant = "Gt0")) TArray<double> Scales;
+    UPROPERTY(meta = (Invariant = "ID")) TSet<int32> Ids;
+    UPROPERTY(meta = (Invariant = "Range[0,1]")) TMap<FName, float> Probabilities;
+};
+
+/** References a (usually shared) perf object through Invariant=Contract*. */
+UCLASS()
+class ULifeTestInvariantContractObj : public UObject
+{
+	GENERATED_BODY()
+
+public:
+    UPROPERTY(meta = (Invariant = "Contract*")) ULifeTestInvariantPerfObj* Shared = nullptr;
+    UPROPERTY(meta = (Invariant = "Gte0")) int32 Count = 1;
+};
@@ -19,6 +19,7 @@ public class SkyLifeguardTests : ModuleRules
             {
                 "CoreUObject",
                 "Engine",
+                "Projects",
                 "Slate",
                 "SlateCore"
             }